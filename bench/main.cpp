@@ -0,0 +1,963 @@
+/**
+ * @file main.cpp
+ * @brief easytty_bench - micro benchmarks for rule loading, lookups and detection
+ *
+ * Every benchmark runs on generated data in a scratch directory, so the
+ * numbers do not depend on the rules or adapters of the machine (except
+ * "scanDevices", which measures the live udev database; "scanDevicesSysfs"
+ * and "scanDevicesFixture" scan generated device sources, and the
+ * "coldStart" benchmarks run the built executables on one). The
+ * "publish...WithReader" benchmarks time rule and device updates while
+ * another thread keeps reading getSnapshot(), and abort if it ever sees
+ * an inconsistent snapshot; "batchRejected" times a --batch that must be
+ * rejected at one line and aborts if anything was written; the
+ * "compileFilterNested" benchmarks abort unless nesting past
+ * Filter::MAX_DEPTH is rejected (rather than overflowing the stack), and
+ * "writeDevicesTsv" unless even zero records get a header row. Results are
+ * written as records through RecordWriter (JSON by default) so runs of
+ * different releases can be diffed.
+ *
+ * With --generate-rules it instead writes a rule directory in one of the
+ * layouts compared by udev-rule-cost.sh, which measures the cost udevd
+ * pays per event. With --generate-storm it writes a hub power-cycle event
+ * trace for `easyTTY --replay`.
+ */
+
+#include "cli/Commands.hpp"
+#include "cli/RecordWriter.hpp"
+#include "common/Filter.hpp"
+#include "common/Utils.hpp"
+#include "device/DeviceDetector.hpp"
+#include "device/FixtureDeviceSource.hpp"
+#include "device/KernelEventSource.hpp"
+#include "device/SysfsDeviceSource.hpp"
+#include "udev/UdevManager.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include <spawn.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char** environ;
+
+namespace fs = std::filesystem;
+using easytty::DeviceInfo;
+using easytty::UdevManager;
+using easytty::cli::OutputFormat;
+using easytty::cli::RecordWriter;
+
+namespace {
+
+struct Options {
+    double minTime = 0.2;       // Seconds of samples per benchmark
+    std::string filter;         // Only run benchmarks whose name contains this
+    OutputFormat format = OutputFormat::Json;
+    std::string generateDir;    // --generate-rules: write rules here and exit
+    long long ruleCount = 100;
+    std::string layout = "per-file";
+    std::string stormPath;      // --generate-storm: write a replay trace here and exit
+    long long ports = 48;
+    long long cycles = 10;
+};
+
+struct Param {
+    const char* name;
+    long long value;
+};
+
+class Bench {
+public:
+    Bench(const Options& options, RecordWriter& writer) : options_(options), writer_(writer) {}
+
+    bool wants(const char* name) const {
+        return options_.filter.empty() || std::strstr(name, options_.filter.c_str());
+    }
+
+    /**
+     * @brief Time fn repeatedly and emit one record
+     * @param ops Operations performed by one call of fn
+     */
+    void run(const char* name, const std::vector<Param>& params, long long ops,
+             const std::function<void()>& fn) {
+        runSamples(name, params, ops, [&fn]() {
+            auto start = std::chrono::steady_clock::now();
+            fn();
+            return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        });
+    }
+
+    /**
+     * @brief Like run(), with sample measuring itself and returning nanoseconds
+     * @return Median nanoseconds per operation, 0 if skipped
+     */
+    double runSamples(const char* name, const std::vector<Param>& params, long long ops,
+                      const std::function<double()>& sample) {
+        if (!wants(name)) return 0;
+
+        using clock = std::chrono::steady_clock;
+        sample();   // Warm up caches and lazily built state
+
+        std::vector<double> samples;
+        auto deadline = clock::now() + std::chrono::duration<double>(options_.minTime);
+        while (samples.size() < 5 || (clock::now() < deadline && samples.size() < 100000)) {
+            samples.push_back(sample() / static_cast<double>(ops));
+        }
+
+        std::sort(samples.begin(), samples.end());
+        double sum = 0;
+        for (double s : samples) sum += s;
+
+        writer_.beginRecord();
+        writer_.field("name", name);
+        // One string keeps TSV columns aligned across benchmarks
+        std::string paramText;
+        for (const auto& param : params) {
+            if (!paramText.empty()) paramText += ' ';
+            paramText += std::string(param.name) + "=" + std::to_string(param.value);
+        }
+        writer_.field("params", paramText);
+        writer_.field("samples", static_cast<unsigned long long>(samples.size()));
+        writer_.field("opsPerSample", ops);
+        writer_.field("nsPerOpMin", static_cast<long long>(samples.front()));
+        writer_.field("nsPerOpMedian", static_cast<long long>(samples[samples.size() / 2]));
+        writer_.field("nsPerOpMean", static_cast<long long>(sum / samples.size()));
+        writer_.endRecord();
+        writer_.flush();
+        return samples[samples.size() / 2];
+    }
+
+private:
+    const Options& options_;
+    RecordWriter& writer_;
+};
+
+/**
+ * @brief Synthetic adapters: most with a serial, every fourth port-only
+ */
+std::vector<DeviceInfo> makeDevices(size_t count) {
+    std::vector<DeviceInfo> devices;
+    devices.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        DeviceInfo dev;
+        dev.devNode = "ttyUSB" + std::to_string(i);
+        dev.devPath = "/dev/" + dev.devNode;
+        dev.sysPath = "/sys/devices/pci0000:00/0000:00:14.0/usb1/1-" + std::to_string(i % 12 + 1) +
+                      "/tty/" + dev.devNode;
+        dev.subsystem = "tty";
+        dev.vendorId = i % 3 == 0 ? "067b" : "0403";
+        dev.productId = i % 3 == 0 ? "2303" : "6001";
+        dev.manufacturer = "FTDI";
+        dev.product = "FT232R USB UART";
+        dev.driver = "ftdi_sio";
+        dev.kernelPath = "1-" + std::to_string(i / 16 + 1) + "." + std::to_string(i % 16 + 1);
+        if (i % 4 != 3) {
+            char serial[24];
+            std::snprintf(serial, sizeof(serial), "A%07zu", i);
+            dev.serial = serial;
+        }
+        devices.push_back(dev);
+    }
+    return devices;
+}
+
+std::string makeScratchDir() {
+    char templ[] = "/tmp/easytty-bench-XXXXXX";
+    if (!mkdtemp(templ)) {
+        throw std::runtime_error(std::string("mkdtemp failed: ") + std::strerror(errno));
+    }
+    return templ;
+}
+
+/**
+ * @brief Rule directory holding one generated rule per device
+ */
+std::string makeRuleDir(const std::vector<DeviceInfo>& devices) {
+    std::string dir = makeScratchDir();
+    UdevManager manager(dir);
+    for (size_t i = 0; i < devices.size(); i++) {
+        auto result = manager.createRule(devices[i], "bench_" + std::to_string(i));
+        if (!result.success) {
+            throw std::runtime_error("cannot generate rules in " + dir + ": " + result.message);
+        }
+    }
+    return dir;
+}
+
+void benchRules(Bench& bench) {
+    if (!bench.wants("loadExistingRules") && !bench.wants("parseRuleFile") &&
+        !bench.wants("createRuleDuplicate") && !bench.wants("getRuleMatchType")) {
+        return;
+    }
+
+    for (long long count : {10LL, 100LL, 1000LL, 10000LL}) {
+        auto devices = makeDevices(static_cast<size_t>(count));
+        std::string dir = makeRuleDir(devices);
+        UdevManager manager(dir);
+
+        // Full directory scan + parse of every rule file
+        bench.run("loadExistingRules", {{"rules", count}}, 1, [&]() { manager.refresh(); });
+        bench.run("parseRuleFile", {{"rules", count}}, count, [&]() { manager.refresh(); });
+
+        // Rejected creates: existing device under a new name, new device under an existing name
+        auto fresh = makeDevices(static_cast<size_t>(count) * 2);
+        size_t next = 0;
+        bench.run("createRuleDuplicate", {{"rules", count}}, 2, [&]() {
+            size_t n = next++ % devices.size();
+            manager.createRule(devices[n], "fresh_name");
+            manager.createRule(fresh[devices.size() + n], "bench_" + std::to_string(n));
+        });
+
+        // Every device against every rule: one indexed lookup per device
+        for (long long deviceCount : {10LL, 200LL}) {
+            auto probe = makeDevices(static_cast<size_t>(deviceCount));
+            bench.run("getRuleMatchType", {{"rules", count}, {"devices", deviceCount}}, deviceCount, [&]() {
+                int matches = 0;
+                for (const auto& dev : probe) {
+                    matches += manager.getRuleMatchType(dev);
+                }
+                if (matches < 0) std::abort();
+            });
+        }
+
+        fs::remove_all(dir);
+    }
+}
+
+void benchUtils(Bench& bench) {
+    const std::vector<std::string> names = {
+        "RS485_1", "plc-main-controller", "1invalid", "bad name", "a", "gps",
+        "ttyUSB_very_long_name_for_a_device_in_rack_7_slot_12_port_4", "x/y", "", "Modbus_RTU_03",
+    };
+
+    bench.run("isValidSymlinkName", {{"names", static_cast<long long>(names.size())}},
+              static_cast<long long>(names.size()), [&]() {
+        int valid = 0;
+        for (const auto& name : names) {
+            valid += easytty::utils::isValidSymlinkName(name);
+        }
+        if (valid < 0) std::abort();
+    });
+
+    bench.run("sanitizeForUdev", {{"names", static_cast<long long>(names.size())}},
+              static_cast<long long>(names.size()), [&]() {
+        size_t length = 0;
+        for (const auto& name : names) {
+            length += easytty::utils::sanitizeForUdev(name).size();
+        }
+        if (length == static_cast<size_t>(-1)) std::abort();
+    });
+}
+
+/**
+ * @brief Compile "!!...!vid==0403" and "((...(vid==0403)...))" at several depths
+ *
+ * Up to Filter::MAX_DEPTH they must compile; deeper ones must be
+ * rejected as nested too deeply.
+ */
+void benchFilter(Bench& bench) {
+    if (!bench.wants("compileFilterNested")) {
+        return;
+    }
+
+    for (long long depth : {1LL, static_cast<long long>(easytty::Filter::MAX_DEPTH), 100000LL}) {
+        size_t n = static_cast<size_t>(depth);
+        const std::vector<std::string> expressions = {
+            std::string(n, '!') + "vid==0403",
+            std::string(n, '(') + "vid==0403" + std::string(n, ')'),
+        };
+        bool accepted = n <= easytty::Filter::MAX_DEPTH;
+        bench.run("compileFilterNested", {{"depth", depth}}, static_cast<long long>(expressions.size()), [&]() {
+            for (const auto& expression : expressions) {
+                std::string error;
+                auto filter = easytty::Filter::compile(expression, error);
+                if (filter.has_value() != accepted ||
+                    (!accepted && error.find("nested too deeply") == std::string::npos)) {
+                    std::cerr << "compileFilterNested: depth " << depth << ": "
+                              << (filter ? "accepted" : error) << "\n";
+                    std::abort();
+                }
+            }
+        });
+    }
+}
+
+/**
+ * @brief Device records as TSV, the way --list writes them
+ *
+ * The header is declared up front, so the output must be one header
+ * row plus one row per record, zero records included.
+ */
+void benchRecords(Bench& bench) {
+    if (!bench.wants("writeDevicesTsv")) {
+        return;
+    }
+
+    for (long long count : {0LL, 1000LL}) {
+        auto devices = makeDevices(static_cast<size_t>(count));
+        char* text = nullptr;
+        size_t size = 0;
+        std::FILE* out = open_memstream(&text, &size);
+        if (!out) {
+            throw std::runtime_error(std::string("open_memstream failed: ") + std::strerror(errno));
+        }
+        bench.run("writeDevicesTsv", {{"records", count}}, std::max(count, 1LL), [&]() {
+            std::rewind(out);
+            {
+                RecordWriter writer(OutputFormat::Tsv, out);
+                writer.beginHeader();
+                easytty::cli::writeDeviceFields(writer, DeviceInfo());
+                writer.endHeader();
+                for (const auto& dev : devices) {
+                    writer.beginRecord();
+                    easytty::cli::writeDeviceFields(writer, dev);
+                    writer.endRecord();
+                }
+                writer.finish();
+            }
+            std::string output(text, std::ftell(out));
+            if (output.compare(0, 8, "devPath\t") != 0 ||
+                std::count(output.begin(), output.end(), '\n') != count + 1) {
+                std::cerr << "writeDevicesTsv: " << count << " records gave:\n" << output;
+                std::abort();
+            }
+        });
+        std::fclose(out);
+        std::free(text);
+    }
+}
+
+void benchUevents(Bench& bench) {
+    auto uevent = [](const std::string& action, const std::string& devPath,
+                     const std::vector<std::string>& entries) {
+        std::string message = action + "@" + devPath;
+        message += '\0';
+        for (const auto& entry : entries) {
+            message += entry;
+            message += '\0';
+        }
+        return message;
+    };
+
+    // A hub power cycle: interface binds interleaved with the tty adds
+    std::vector<std::string> messages;
+    for (int i = 0; i < 8; i++) {
+        std::string port = "1-6." + std::to_string(i + 1);
+        std::string iface = "/devices/pci0000:00/0000:00:14.0/usb1/1-6/" + port + "/" + port + ":1.0";
+        std::string node = "ttyUSB" + std::to_string(i);
+        std::string tty = iface + "/" + node + "/tty/" + node;
+        messages.push_back(uevent("bind", iface, {"ACTION=bind", "DEVPATH=" + iface, "SUBSYSTEM=usb",
+                                                  "DEVTYPE=usb_interface", "DRIVER=ftdi_sio",
+                                                  "SEQNUM=" + std::to_string(5000 + 2 * i)}));
+        messages.push_back(uevent("add", tty, {"ACTION=add", "DEVPATH=" + tty, "SUBSYSTEM=tty", "MAJOR=188",
+                                               "MINOR=" + std::to_string(i), "DEVNAME=" + node,
+                                               "SEQNUM=" + std::to_string(5001 + 2 * i)}));
+    }
+
+    bench.run("parseUevent", {{"messages", static_cast<long long>(messages.size())}},
+              static_cast<long long>(messages.size()), [&]() {
+        size_t serial = 0;
+        for (const auto& message : messages) {
+            auto uevent = easytty::KernelEventSource::parse(message);
+            serial += uevent && uevent->subsystem == "tty";
+        }
+        if (serial != messages.size() / 2) std::abort();
+    });
+}
+
+void benchDetector(Bench& bench) {
+    easytty::DeviceDetector detector;
+    long long devices = static_cast<long long>(detector.scanDevices().size());
+    bench.run("scanDevices", {{"devices", devices}}, 1, [&]() { detector.scanDevices(); });
+}
+
+void writeFile(const fs::path& path, const std::string& content) {
+    std::ofstream file(path);
+    file << content << "\n";
+}
+
+/**
+ * @brief sysfs tree with the layout of usb-serial adapters
+ *
+ * sys/class/tty/<node> links into sys/devices/.../<usb>/<usb>:1.0/<node>/tty/<node>
+ * with the attributes SysfsDeviceSource reads, plus a few virtual
+ * consoles it has to skip.
+ */
+std::string makeSysfsTree(const std::vector<DeviceInfo>& devices) {
+    std::string root = makeScratchDir();
+    fs::path classDir = fs::path(root) / "sys/class/tty";
+    fs::path hub = fs::path(root) / "sys/devices/pci0000:00/0000:00:14.0/usb1";
+    fs::create_directories(classDir);
+    fs::create_directories(fs::path(root) / "sys/bus/usb/drivers/ftdi_sio");
+
+    for (const auto& dev : devices) {
+        fs::path usb = hub / dev.kernelPath;
+        fs::path intf = usb / (dev.kernelPath + ":1.0");
+        fs::path tty = intf / dev.devNode / "tty" / dev.devNode;
+        fs::create_directories(tty);
+        writeFile(usb / "idVendor", dev.vendorId);
+        writeFile(usb / "idProduct", dev.productId);
+        writeFile(usb / "manufacturer", dev.manufacturer);
+        writeFile(usb / "product", dev.product);
+        if (!dev.serial.empty()) {
+            writeFile(usb / "serial", dev.serial);
+        }
+        writeFile(intf / "bInterfaceNumber", "00");
+        writeFile(tty / "dev", "188:0");
+        fs::create_symlink("../../../../../../bus/usb/drivers/ftdi_sio", intf / "driver");
+        fs::create_symlink(fs::relative(tty, classDir), classDir / dev.devNode);
+    }
+    for (int i = 0; i < 8; i++) {
+        std::string name = "tty" + std::to_string(i);
+        fs::create_directories(fs::path(root) / "sys/devices/virtual/tty" / name);
+        fs::create_symlink("../../devices/virtual/tty/" + name, classDir / name);
+    }
+    return root;
+}
+
+/**
+ * @brief Fixture file in the format of `easyTTY --list --format json`
+ */
+std::string makeFixture(const std::vector<DeviceInfo>& devices) {
+    std::string dir = makeScratchDir();
+    std::string path = dir + "/devices.json";
+    std::FILE* out = std::fopen(path.c_str(), "w");
+    if (!out) {
+        throw std::runtime_error("cannot write " + path);
+    }
+    {
+        RecordWriter writer(OutputFormat::Json, out);
+        for (const auto& dev : devices) {
+            writer.beginRecord();
+            easytty::cli::writeDeviceFields(writer, dev);
+            writer.endRecord();
+        }
+        writer.finish();
+    }
+    std::fclose(out);
+    return dir;
+}
+
+void benchSources(Bench& bench) {
+    if (!bench.wants("scanDevicesSysfs") && !bench.wants("scanDevicesFixture")) {
+        return;
+    }
+
+    for (long long count : {10LL, 200LL}) {
+        auto devices = makeDevices(static_cast<size_t>(count));
+
+        if (bench.wants("scanDevicesSysfs")) {
+            std::string root = makeSysfsTree(devices);
+            easytty::DeviceDetector detector(std::make_unique<easytty::SysfsDeviceSource>(root));
+            bench.run("scanDevicesSysfs", {{"devices", count}}, 1, [&]() { detector.scanDevices(); });
+            fs::remove_all(root);
+        }
+
+        if (bench.wants("scanDevicesFixture")) {
+            std::string dir = makeFixture(devices);
+            bench.run("scanDevicesFixture", {{"devices", count}}, 1, [&]() {
+                easytty::DeviceDetector detector(easytty::FixtureDeviceSource::load(dir + "/devices.json"));
+                detector.scanDevices();
+            });
+            fs::remove_all(dir);
+        }
+    }
+}
+
+/**
+ * @brief Run check on another thread until stopped, then make sure it ran
+ *
+ * Starts a thread calling check in a loop while body runs on this one,
+ * and waits for at least one call to finish before stopping it, so the
+ * snapshot reads are exercised even with --min-time 0.
+ */
+void withReader(const std::function<void()>& check, const std::function<void()>& body) {
+    std::atomic<bool> stop(false);
+    std::atomic<unsigned long long> reads(0);
+    std::thread reader([&]() {
+        while (!stop.load(std::memory_order_relaxed)) {
+            check();
+            reads.fetch_add(1, std::memory_order_relaxed);
+        }
+    });
+    body();
+    while (reads.load(std::memory_order_relaxed) == 0) {
+        std::this_thread::yield();
+    }
+    stop = true;
+    reader.join();
+}
+
+void benchSnapshots(Bench& bench) {
+    if (!bench.wants("publishRulesWithReader") && !bench.wants("publishDevicesWithReader")) {
+        return;
+    }
+
+    for (long long count : {10LL, 200LL}) {
+        auto devices = makeDevices(static_cast<size_t>(count));
+
+        if (bench.wants("publishRulesWithReader")) {
+            std::string dir = makeRuleDir(devices);
+            UdevManager manager(dir);
+            // Every rule of a snapshot must be in that snapshot's index
+            withReader([&]() {
+                UdevManager::RuleSnapshot snapshot = manager.getSnapshot();
+                if (snapshot->rules.size() != static_cast<size_t>(count)) std::abort();
+                for (const auto& rule : snapshot->rules) {
+                    if (snapshot->index.findBySymlink(rule.symlink) == nullptr) std::abort();
+                }
+            }, [&]() {
+                bench.run("publishRulesWithReader", {{"rules", count}}, 1, [&]() { manager.refresh(); });
+            });
+            fs::remove_all(dir);
+        }
+
+        if (bench.wants("publishDevicesWithReader")) {
+            std::string root = makeSysfsTree(devices);
+            easytty::DeviceDetector detector(std::make_unique<easytty::SysfsDeviceSource>(root));
+            detector.scanDevices();
+            withReader([&]() {
+                easytty::DeviceDetector::DeviceList snapshot = detector.getSnapshot();
+                if (snapshot->size() != static_cast<size_t>(count)) std::abort();
+                for (const auto& dev : *snapshot) {
+                    if (dev.devPath.empty()) std::abort();
+                }
+            }, [&]() {
+                bench.run("publishDevicesWithReader", {{"devices", count}}, 1, [&]() { detector.scanDevices(); });
+            });
+            fs::remove_all(root);
+        }
+    }
+}
+
+/**
+ * @brief File names and contents of a directory, to tell whether it changed
+ */
+std::string directoryContents(const std::string& dir) {
+    std::vector<std::string> files;
+    for (const auto& entry : fs::directory_iterator(dir)) {
+        files.push_back(entry.path().string());
+    }
+    std::sort(files.begin(), files.end());
+    std::string contents;
+    for (const auto& file : files) {
+        std::ifstream in(file);
+        contents += file + "\n" + std::string(std::istreambuf_iterator<char>(in), {}) + "\n";
+    }
+    return contents;
+}
+
+/**
+ * @brief A --batch of creates rejected at its middle line
+ *
+ * The middle line names a rule file that still holds another interface's
+ * rule, which only createRule()'s own checks catch. The first line
+ * deletes a rule by its rule name rather than its symlink, as
+ * deleteRule() allows. The batch must fail at the middle line alone and
+ * leave the rules directory as it was.
+ */
+void benchBatch(Bench& bench) {
+    if (!bench.wants("batchRejected")) {
+        return;
+    }
+
+    for (long long count : {10LL, 200LL}) {
+        auto devices = makeDevices(static_cast<size_t>(count));
+        std::string fixtureDir = makeFixture(devices);
+        easytty::DeviceDetector detector(easytty::FixtureDeviceSource::load(fixtureDir + "/devices.json"));
+        std::string dir = makeScratchDir();
+        UdevManager manager(dir);
+
+        // held_A is deleted, its file stays behind with held_B in it
+        DeviceInfo held;
+        held.devNode = "ttyUSB900";
+        held.devPath = "/dev/ttyUSB900";
+        held.vendorId = "1a86";
+        held.productId = "7523";
+        held.serial = "HELD";
+        held.interfaceNum = "00";
+        DeviceInfo heldB = held;
+        heldB.devNode = "ttyUSB901";
+        heldB.devPath = "/dev/ttyUSB901";
+        heldB.interfaceNum = "01";
+        // Without a product, the rule name is the device node
+        DeviceInfo named = held;
+        named.devNode = "ttyACM900";
+        named.devPath = "/dev/ttyACM900";
+        named.productId = "7524";
+        named.interfaceNum.clear();
+        for (const auto& result : {manager.createInterfaceRules({held, heldB}, {"held_A", "held_B"}),
+                                   manager.deleteRule("held_A"), manager.createRule(named, "named")}) {
+            if (!result.success) {
+                throw std::runtime_error("cannot set up rules in " + dir + ": " + result.message);
+            }
+        }
+
+        std::string batch = "delete ttyACM900\n";
+        long long conflict = count / 2;
+        for (long long i = 0; i < count; i++) {
+            batch += "create ttyUSB" + std::to_string(i) + " " +
+                     (i == conflict ? std::string("held_A") : "bench_" + std::to_string(i)) + "\n";
+        }
+        std::string expected = "Error: line " + std::to_string(conflict + 2) + ": ";
+
+        std::string before = directoryContents(dir);
+        std::ostringstream captured;
+        bench.run("batchRejected", {{"entries", count + 1}}, count + 1, [&]() {
+            std::istringstream in(batch);
+            captured.str("");
+            std::streambuf* out = std::cout.rdbuf(captured.rdbuf());
+            std::streambuf* err = std::cerr.rdbuf(captured.rdbuf());
+            int rc = easytty::cli::batchCommand(in, manager, detector);
+            std::cout.rdbuf(out);
+            std::cerr.rdbuf(err);
+
+            std::string output = captured.str();
+            size_t first = output.find("Error: line ");
+            if (rc != 1 || first == std::string::npos || output.compare(first, expected.size(), expected) != 0 ||
+                output.find("Error: line ", first + 1) != std::string::npos) {
+                std::cerr << output;
+                std::abort();
+            }
+        });
+        if (directoryContents(dir) != before) {
+            std::cerr << "batchRejected: a rejected batch changed " << dir << "\n";
+            std::abort();
+        }
+
+        fs::remove_all(dir);
+        fs::remove_all(fixtureDir);
+    }
+}
+
+void replaceAll(std::string& text, const std::string& from, const std::string& to) {
+    for (size_t pos = text.find(from); pos != std::string::npos; pos = text.find(from, pos + to.size())) {
+        text.replace(pos, from.size(), to);
+    }
+}
+
+/**
+ * @brief Write count generated rules into dir in one of three layouts
+ *
+ *   per-file      what easyTTY writes: one 99-easytty-<name>.rules per device
+ *   consolidated  the same rules concatenated into a single file
+ *   property      one file matching the ENV{ID_*} properties set by the
+ *                 usb_id builtin instead of walking parents with ATTRS{},
+ *                 behind a guard that skips non-USB tty events
+ *
+ * All layouts start from UdevManager's generator, so they follow it.
+ */
+void generateRules(const std::string& dir, long long count, const std::string& layout) {
+    if (layout != "per-file" && layout != "consolidated" && layout != "property") {
+        throw std::runtime_error("unknown layout '" + layout + "' (expected per-file, consolidated or property)");
+    }
+    fs::create_directories(dir);
+    auto devices = makeDevices(static_cast<size_t>(count));
+    UdevManager manager(dir);
+    for (size_t i = 0; i < devices.size(); i++) {
+        auto result = manager.createRule(devices[i], "bench_" + std::to_string(i));
+        if (!result.success) {
+            throw std::runtime_error("cannot generate rules in " + dir + ": " + result.message);
+        }
+    }
+    if (layout == "per-file") {
+        return;
+    }
+
+    std::string combined;
+    if (layout == "property") {
+        combined += "SUBSYSTEM!=\"tty\", GOTO=\"easytty_end\"\n";
+        combined += "ENV{ID_BUS}!=\"usb\", GOTO=\"easytty_end\"\n";
+    }
+    for (const auto& rule : manager.getRules()) {
+        std::ifstream in(rule.filePath);
+        std::string line;
+        while (std::getline(in, line)) {
+            if (line.empty() || line[0] == '#') continue;
+            if (layout == "property") {
+                replaceAll(line, "SUBSYSTEM==\"tty\", ", "");
+                replaceAll(line, "ATTRS{idVendor}", "ENV{ID_VENDOR_ID}");
+                replaceAll(line, "ATTRS{idProduct}", "ENV{ID_MODEL_ID}");
+                replaceAll(line, "ATTRS{serial}", "ENV{ID_SERIAL_SHORT}");
+            }
+            combined += line + "\n";
+        }
+        fs::remove(rule.filePath);
+    }
+    if (layout == "property") {
+        combined += "LABEL=\"easytty_end\"\n";
+    }
+
+    std::ofstream out(fs::path(dir) / "99-easytty.rules");
+    out << combined;
+    if (!out) {
+        throw std::runtime_error("cannot write " + dir + "/99-easytty.rules");
+    }
+}
+
+/**
+ * @brief Write a --watch trace of a hub bank being power-cycled
+ *
+ * Every cycle detaches all ports within ~50 ms, then reattaches them
+ * over ~2 s as the hubs re-enumerate, five seconds apart. The result
+ * replays with `easyTTY --replay <file> --speed 1|10|max`.
+ */
+void generateStorm(const std::string& path, long long ports, long long cycles) {
+    std::FILE* out = std::fopen(path.c_str(), "w");
+    if (!out) {
+        throw std::runtime_error("cannot write " + path + ": " + std::strerror(errno));
+    }
+
+    auto devices = makeDevices(static_cast<size_t>(ports));
+    uint64_t timestamp = 1700000000ULL * 1000000;
+    uint64_t seqnum = 10000;
+    {
+        RecordWriter writer(OutputFormat::Ndjson, out);
+        auto writeEvent = [&](const char* action, const DeviceInfo& device) {
+            writer.beginRecord();
+            writer.field("action", action);
+            writer.field("seqnum", static_cast<unsigned long long>(seqnum++));
+            writer.field("timestamp", static_cast<unsigned long long>(timestamp));
+            writer.beginObject("device");
+            easytty::cli::writeDeviceFields(writer, device);
+            writer.endObject();
+            writer.endRecord();
+        };
+
+        // Deterministic jitter so every generated trace is identical
+        uint32_t state = 12345;
+        auto jitter = [&state](uint64_t maxUsec) {
+            state = state * 1103515245u + 12345u;
+            return (state >> 8) % (maxUsec + 1);
+        };
+
+        for (long long cycle = 0; cycle < cycles; cycle++) {
+            for (const auto& device : devices) {
+                timestamp += jitter(50000 / devices.size());
+                writeEvent("remove", device);
+            }
+            timestamp += 500000;
+            for (const auto& device : devices) {
+                timestamp += jitter(4000000 / devices.size());
+                writeEvent("add", device);
+            }
+            timestamp += 5000000;
+        }
+        writer.finish();
+    }
+    if (std::fclose(out) != 0) {
+        throw std::runtime_error("cannot write " + path);
+    }
+}
+
+// Cold-start budget for `easytty-cli --list` on 20 devices
+constexpr double COLD_START_BUDGET_NS = 3e6;
+
+/**
+ * @brief Run a binary and return nanoseconds until its first byte of output
+ *
+ * The process is then drained and reaped, so nothing is left behind.
+ */
+double timeToFirstOutput(const std::string& binary, const std::vector<std::string>& args,
+                         const std::string& deviceSource) {
+    int fds[2];
+    if (pipe(fds) != 0) {
+        throw std::runtime_error(std::string("pipe failed: ") + std::strerror(errno));
+    }
+
+    std::vector<std::string> env = {std::string(easytty::DeviceSource::ENV_VAR) + "=" + deviceSource};
+    for (char** e = environ; *e; e++) {
+        if (std::strncmp(*e, "EASYTTY_", 8) != 0) env.push_back(*e);
+    }
+    std::vector<char*> envp;
+    for (auto& entry : env) envp.push_back(&entry[0]);
+    envp.push_back(nullptr);
+
+    std::vector<std::string> argStrings = {binary};
+    argStrings.insert(argStrings.end(), args.begin(), args.end());
+    std::vector<char*> argv;
+    for (auto& arg : argStrings) argv.push_back(&arg[0]);
+    argv.push_back(nullptr);
+
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_adddup2(&actions, fds[1], STDOUT_FILENO);
+    posix_spawn_file_actions_addclose(&actions, fds[0]);
+    posix_spawn_file_actions_addclose(&actions, fds[1]);
+
+    auto start = std::chrono::steady_clock::now();
+    pid_t pid;
+    int rc = posix_spawn(&pid, binary.c_str(), &actions, nullptr, argv.data(), envp.data());
+    posix_spawn_file_actions_destroy(&actions);
+    close(fds[1]);
+    if (rc != 0) {
+        close(fds[0]);
+        throw std::runtime_error("cannot run " + binary + ": " + std::strerror(rc));
+    }
+
+    char buffer[4096];
+    ssize_t n = read(fds[0], buffer, sizeof(buffer));
+    auto firstOutput = std::chrono::steady_clock::now();
+    while (n > 0) {
+        n = read(fds[0], buffer, sizeof(buffer));
+    }
+    close(fds[0]);
+    int status = 0;
+    waitpid(pid, &status, 0);
+
+    return std::chrono::duration<double, std::nano>(firstOutput - start).count();
+}
+
+long long fileSize(const std::string& path) {
+    struct stat st;
+    return stat(path.c_str(), &st) == 0 ? static_cast<long long>(st.st_size) : -1;
+}
+
+/**
+ * @brief Cold start to first output of `--list` in the headless and TUI builds
+ *
+ * Each sample is a fresh process scanning a generated 20-device sysfs
+ * tree; the binary size is recorded with it so both can be tracked.
+ */
+void benchStartup(Bench& bench) {
+    if (!bench.wants("coldStartCli") && !bench.wants("coldStartTui")) {
+        return;
+    }
+
+    const long long count = 20;
+    std::string root = makeSysfsTree(makeDevices(static_cast<size_t>(count)));
+    std::string source = "sysfs:" + root;
+
+    double cliNs = bench.runSamples("coldStartCli",
+                                    {{"devices", count}, {"binaryBytes", fileSize(EASYTTY_CLI_BINARY)}}, 1,
+                                    [&]() { return timeToFirstOutput(EASYTTY_CLI_BINARY, {"--list"}, source); });
+    if (cliNs > COLD_START_BUDGET_NS) {
+        std::fprintf(stderr, "Warning: coldStartCli median %.2f ms exceeds the %.0f ms budget\n",
+                     cliNs / 1e6, COLD_START_BUDGET_NS / 1e6);
+    }
+#ifdef EASYTTY_TUI_BINARY
+    bench.runSamples("coldStartTui",
+                     {{"devices", count}, {"binaryBytes", fileSize(EASYTTY_TUI_BINARY)}}, 1,
+                     [&]() { return timeToFirstOutput(EASYTTY_TUI_BINARY, {"--list"}, source); });
+#endif
+
+    fs::remove_all(root);
+}
+
+void printUsage(const char* programName) {
+    std::cout << "Usage: " << programName << " [options]\n\n";
+    std::cout << "  --filter <text>      Only run benchmarks whose name contains <text>\n";
+    std::cout << "  --min-time <sec>     Sampling time per benchmark (default 0.2)\n";
+    std::cout << "  -f, --format <json|ndjson|tsv>\n";
+    std::cout << "                       Output format (default json)\n";
+    std::cout << "  --generate-rules <dir>\n";
+    std::cout << "                       Write generated rules to <dir> and exit\n";
+    std::cout << "  --rules <n>          Number of rules to generate (default 100)\n";
+    std::cout << "  --layout <per-file|consolidated|property>\n";
+    std::cout << "                       Rule layout to generate (default per-file)\n";
+    std::cout << "  --generate-storm <file>\n";
+    std::cout << "                       Write a hub power-cycle trace for easyTTY --replay\n";
+    std::cout << "  --ports <n>          Ports in the storm (default 48)\n";
+    std::cout << "  --cycles <n>         Power cycles in the storm (default 10)\n";
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Options options;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if ((arg == "--filter" || arg == "--min-time" || arg == "-f" || arg == "--format" ||
+             arg == "--generate-rules" || arg == "--rules" || arg == "--layout" ||
+             arg == "--generate-storm" || arg == "--ports" || arg == "--cycles") && i + 1 >= argc) {
+            std::cerr << "Error: " << arg << " requires an argument\n";
+            return 1;
+        }
+        if (arg == "--filter") {
+            options.filter = argv[++i];
+        } else if (arg == "--min-time") {
+            options.minTime = std::atof(argv[++i]);
+        } else if (arg == "-f" || arg == "--format") {
+            auto format = easytty::cli::parseOutputFormat(argv[++i]);
+            if (!format || *format == OutputFormat::Text) {
+                std::cerr << "Error: Unknown format '" << argv[i] << "'\n";
+                return 1;
+            }
+            options.format = *format;
+        } else if (arg == "--generate-rules") {
+            options.generateDir = argv[++i];
+        } else if (arg == "--rules") {
+            options.ruleCount = std::atoll(argv[++i]);
+        } else if (arg == "--layout") {
+            options.layout = argv[++i];
+        } else if (arg == "--generate-storm") {
+            options.stormPath = argv[++i];
+        } else if (arg == "--ports") {
+            options.ports = std::atoll(argv[++i]);
+        } else if (arg == "--cycles") {
+            options.cycles = std::atoll(argv[++i]);
+        } else if (arg == "-h" || arg == "--help") {
+            printUsage(argv[0]);
+            return 0;
+        } else {
+            std::cerr << "Error: Unknown option " << arg << "\n";
+            return 1;
+        }
+    }
+
+    if (!options.generateDir.empty()) {
+        try {
+            generateRules(options.generateDir, options.ruleCount, options.layout);
+        } catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << "\n";
+            return 1;
+        }
+        return 0;
+    }
+    if (!options.stormPath.empty()) {
+        try {
+            generateStorm(options.stormPath, options.ports, options.cycles);
+        } catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << "\n";
+            return 1;
+        }
+        return 0;
+    }
+
+    try {
+        RecordWriter writer(options.format);
+        Bench bench(options, writer);
+        benchRules(bench);
+        benchUtils(bench);
+        benchFilter(bench);
+        benchRecords(bench);
+        benchUevents(bench);
+        benchSources(bench);
+        benchSnapshots(bench);
+        benchBatch(bench);
+        benchStartup(bench);
+        if (bench.wants("scanDevices")) {
+            benchDetector(bench);
+        }
+        writer.finish();
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
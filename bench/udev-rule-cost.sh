@@ -0,0 +1,115 @@
+#!/bin/bash
+# EasyTTY udevd rule-cost benchmark
+# Times `udevadm test` on a tty device with 0..10000 generated rules in each
+# rule layout, to show what easyTTY's rules add to every udev event.
+#
+# Usage: sudo udev-rule-cost.sh [-s <syspath>] [-r <runs>] [-n "<counts>"]
+#                               [-l "<layouts>"] [-b <easytty_bench>]
+#
+# Rules are generated by easytty_bench --generate-rules into a scratch
+# directory that is bind-mounted over /etc/udev/rules.d in a private mount
+# namespace, so the system's rules directory is never touched. The
+# generated rules match synthetic serials only and never name a real device.
+#
+# Output is TSV: the median wall time of one `udevadm test` run, and the
+# difference to the run without easyTTY rules. That difference covers
+# parsing the rules (which udevd does once per reload) plus evaluating them
+# (which udevd does for every event); the `verify_ms` column, when udevadm
+# supports `verify`, is the parse cost alone.
+
+set -e
+
+BENCH="$(dirname "$0")/easytty_bench"
+SYSPATH=""
+RUNS=7
+COUNTS="0 10 100 1000 10000"
+LAYOUTS="per-file consolidated property"
+
+while getopts "s:r:n:l:b:h" opt; do
+    case "$opt" in
+        s) SYSPATH="$OPTARG" ;;
+        r) RUNS="$OPTARG" ;;
+        n) COUNTS="$OPTARG" ;;
+        l) LAYOUTS="$OPTARG" ;;
+        b) BENCH="$OPTARG" ;;
+        *) sed -n '2,18p' "$0" | sed 's/^# \{0,1\}//'; exit 1 ;;
+    esac
+done
+
+if [ "$(id -u)" -ne 0 ]; then
+    echo "Error: needs root for the private mount namespace" >&2
+    exit 1
+fi
+if ! command -v udevadm >/dev/null; then
+    echo "Error: udevadm not found" >&2
+    exit 1
+fi
+if [ ! -x "$BENCH" ]; then
+    echo "Error: $BENCH not found (build easytty_bench or pass -b)" >&2
+    exit 1
+fi
+
+# Prefer a real USB serial adapter; every tty event runs the rules either way
+if [ -z "$SYSPATH" ]; then
+    for dev in /sys/class/tty/ttyUSB* /sys/class/tty/ttyACM* /sys/class/tty/ttyS0 /sys/class/tty/tty1; do
+        if [ -e "$dev" ]; then
+            SYSPATH="$(readlink -f "$dev")"
+            break
+        fi
+    done
+fi
+if [ ! -e "$SYSPATH" ]; then
+    echo "Error: no tty device to test against (pass -s <syspath>)" >&2
+    exit 1
+fi
+
+SCRATCH="$(mktemp -d /tmp/easytty-udev-bench-XXXXXX)"
+trap 'rm -rf "$SCRATCH"' EXIT
+
+# Median wall time in milliseconds of RUNS executions of "$@", run with
+# the current rules directory mounted over /etc/udev/rules.d
+median_ms() {
+    local rules="$1"
+    shift
+    for _ in $(seq "$RUNS"); do
+        unshare --mount --propagation private sh -c '
+            mount --bind "$1" /etc/udev/rules.d || exit 1
+            shift
+            start=$(date +%s%N)
+            "$@" >/dev/null 2>&1
+            end=$(date +%s%N)
+            echo $(( (end - start) / 1000 ))
+        ' sh "$rules" "$@"
+    done | sort -n | awk '{ v[NR] = $1 } END { printf "%.3f", v[int((NR + 1) / 2)] / 1000 }'
+}
+
+HAVE_VERIFY=0
+if udevadm verify --help >/dev/null 2>&1; then
+    HAVE_VERIFY=1
+fi
+
+echo "# udevadm $(udevadm --version), syspath $SYSPATH, $RUNS runs"
+printf "layout\trules\tfiles\ttest_ms\tdelta_ms\tus_per_rule\tverify_ms\n"
+
+mkdir -p "$SCRATCH/empty"
+BASELINE=$(median_ms "$SCRATCH/empty" udevadm test --action=add "$SYSPATH")
+
+for layout in $LAYOUTS; do
+    for count in $COUNTS; do
+        dir="$SCRATCH/$layout-$count"
+        "$BENCH" --generate-rules "$dir" --rules "$count" --layout "$layout"
+        files=$(find "$dir" -name '*.rules' | wc -l)
+
+        test_ms=$(median_ms "$dir" udevadm test --action=add "$SYSPATH")
+        verify_ms="-"
+        if [ "$HAVE_VERIFY" -eq 1 ] && [ "$files" -gt 0 ]; then
+            verify_ms=$(median_ms "$dir" sh -c 'udevadm verify --no-style "$0"/*.rules' "$dir")
+        fi
+
+        awk -v l="$layout" -v n="$count" -v f="$files" -v t="$test_ms" -v b="$BASELINE" -v v="$verify_ms" 'BEGIN {
+            d = t - b
+            printf "%s\t%d\t%d\t%.3f\t%.3f\t%s\t%s\n", l, n, f, t, d, (n > 0 ? sprintf("%.2f", d * 1000 / n) : "-"), v
+        }'
+        rm -rf "$dir"
+    done
+done
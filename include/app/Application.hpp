@@ -4,6 +4,7 @@
 #include "udev/UdevManager.hpp"
 #include "tui/Screen.hpp"
 #include "tui/Menu.hpp"
+#include "common/Filter.hpp"
 #include <memory>
 
 namespace easytty {
@@ -28,6 +29,8 @@ private:
     std::unique_ptr<DeviceDetector> deviceDetector_;
     std::unique_ptr<UdevManager> udevManager_;
     bool running_;
+    Filter deviceFilter_;
+    Filter ruleFilter_;
     
     // Menu handlers
     void showMainMenu();
@@ -35,14 +38,23 @@ private:
     void showExistingRules();
     void showDeviceDetails(const DeviceInfo& device);
     void createRuleForDevice(const DeviceInfo& device);
+    void createInterfaceRules(const std::vector<DeviceInfo>& interfaces);
     void deleteRuleMenu(const UdevRule& rule);
     void showHelp();
     void showAbout();
+    void showLatency();
+    void showStaleRules();
     
     // Utility
     void refreshAll();
+    bool editFilter(Filter& filter, const std::string& title);
     std::string formatDeviceForList(const DeviceInfo& device) const;
     std::string formatRuleForList(const UdevRule& rule) const;
+    
+    /**
+     * @brief The ttys of the USB device a tty belongs to, by interface number
+     */
+    std::vector<DeviceInfo> interfacesOf(const DeviceInfo& device) const;
 };
 
 } // namespace easytty
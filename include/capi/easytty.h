@@ -0,0 +1,159 @@
+/**
+ * @file easytty.h
+ * @brief C API of libeasytty
+ *
+ * Device detection, rule listing, name resolution and hotplug
+ * notification for programs that would otherwise run `easyTTY --list`
+ * and parse its output. All objects are opaque and owned by the
+ * context; strings are never NULL (empty when a field is unknown).
+ *
+ * The ABI is stable within a major EASYTTY_ABI_VERSION (the shared
+ * library's SONAME). Enumerators are only ever appended.
+ *
+ * A context is not thread safe: use one per thread, or lock around it.
+ */
+#ifndef EASYTTY_H
+#define EASYTTY_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define EASYTTY_ABI_VERSION 1
+
+#if defined(__GNUC__)
+#define EASYTTY_API __attribute__((visibility("default")))
+#else
+#define EASYTTY_API
+#endif
+
+typedef struct easytty_context easytty_context;
+typedef struct easytty_device easytty_device;
+typedef struct easytty_rule easytty_rule;
+
+typedef enum {
+    EASYTTY_DEVICE_PATH,            /* /dev/ttyUSB0 */
+    EASYTTY_DEVICE_NODE,            /* ttyUSB0 */
+    EASYTTY_DEVICE_SYS_PATH,
+    EASYTTY_DEVICE_VENDOR_ID,
+    EASYTTY_DEVICE_PRODUCT_ID,
+    EASYTTY_DEVICE_SERIAL,
+    EASYTTY_DEVICE_MANUFACTURER,
+    EASYTTY_DEVICE_PRODUCT,
+    EASYTTY_DEVICE_DRIVER,
+    EASYTTY_DEVICE_BUS_NUM,
+    EASYTTY_DEVICE_DEV_NUM,
+    EASYTTY_DEVICE_INTERFACE_NUM,
+    EASYTTY_DEVICE_KERNEL_PATH      /* USB port path, e.g. 1-6.3 */
+} easytty_device_field;
+
+typedef enum {
+    EASYTTY_RULE_SYMLINK,           /* name without /dev/ */
+    EASYTTY_RULE_VENDOR_ID,
+    EASYTTY_RULE_PRODUCT_ID,
+    EASYTTY_RULE_SERIAL,
+    EASYTTY_RULE_KERNEL_PATH,       /* set for port-based rules */
+    EASYTTY_RULE_FILE_PATH
+} easytty_rule_field;
+
+typedef enum {
+    EASYTTY_LINK_UNMANAGED,         /* device has no easyTTY rule */
+    EASYTTY_LINK_MISSING,           /* rule exists, /dev/<symlink> does not */
+    EASYTTY_LINK_ACTIVE,            /* /dev/<symlink> resolves to the device */
+    EASYTTY_LINK_WRONG_DEVICE       /* /dev/<symlink> resolves to another node */
+} easytty_link_status;
+
+typedef enum {
+    EASYTTY_EVENT_ADD,
+    EASYTTY_EVENT_REMOVE,
+    EASYTTY_EVENT_CHANGE
+} easytty_event_action;
+
+/**
+ * @brief Hotplug callback; device is only valid during the call
+ */
+typedef void (*easytty_event_callback)(easytty_event_action action, const easytty_device* device,
+                                       void* user_data);
+
+/** @brief ABI version the library was built with */
+EASYTTY_API int easytty_abi_version(void);
+
+/**
+ * @brief Create a context on the default rules directory and device source
+ * @return NULL if libudev cannot be initialized
+ */
+EASYTTY_API easytty_context* easytty_new(void);
+
+/**
+ * @brief Create a context reading rules from another directory
+ */
+EASYTTY_API easytty_context* easytty_new_with_rules_dir(const char* rules_dir);
+
+EASYTTY_API void easytty_free(easytty_context* ctx);
+
+/** @brief Message of the last failed call on ctx, "" if none */
+EASYTTY_API const char* easytty_last_error(const easytty_context* ctx);
+
+/**
+ * @brief Scan for serial devices
+ *
+ * Devices returned by easytty_device_at() stay valid until the next scan.
+ *
+ * @param count Receives the number of devices (may be NULL)
+ * @return 0 on success, -1 on error
+ */
+EASYTTY_API int easytty_scan_devices(easytty_context* ctx, size_t* count);
+
+/** @brief Device of the last scan, sorted by path; NULL if out of range */
+EASYTTY_API const easytty_device* easytty_device_at(const easytty_context* ctx, size_t index);
+
+EASYTTY_API const char* easytty_device_get(const easytty_device* device, easytty_device_field field);
+
+/**
+ * @brief Load the easyTTY rules
+ *
+ * Rules returned by easytty_rule_at() stay valid until the next load.
+ *
+ * @return 0 on success, -1 on error
+ */
+EASYTTY_API int easytty_load_rules(easytty_context* ctx, size_t* count);
+
+EASYTTY_API const easytty_rule* easytty_rule_at(const easytty_context* ctx, size_t index);
+
+EASYTTY_API const char* easytty_rule_get(const easytty_rule* rule, easytty_rule_field field);
+
+/**
+ * @brief Resolve a symlink, device node, serial, vid:pid:serial or USB port
+ *
+ * Uses the last scan and rule load, doing either first if it has not
+ * happened yet. The first match is returned; device or rule is NULL
+ * when that side does not exist (e.g. a rule whose device is absent).
+ * Both stay valid until the next resolve.
+ *
+ * @param device, rule, status Outputs, each may be NULL
+ * @return Number of matches (0 if none), -1 on error
+ */
+EASYTTY_API int easytty_resolve(easytty_context* ctx, const char* query, const easytty_device** device,
+                                const easytty_rule** rule, easytty_link_status* status);
+
+/**
+ * @brief Start listening for hotplug events
+ * @return File descriptor to poll for readability, -1 on error
+ */
+EASYTTY_API int easytty_monitor_start(easytty_context* ctx, easytty_event_callback callback, void* user_data);
+
+/**
+ * @brief Invoke the callback for every pending event, without blocking
+ * @return Number of events delivered, -1 on error
+ */
+EASYTTY_API int easytty_monitor_dispatch(easytty_context* ctx);
+
+EASYTTY_API void easytty_monitor_stop(easytty_context* ctx);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* EASYTTY_H */
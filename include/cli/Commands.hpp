@@ -0,0 +1,293 @@
+#pragma once
+
+#include "common/Types.hpp"
+#include "cli/RecordWriter.hpp"
+#include "common/Filter.hpp"
+#include <istream>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace easytty {
+
+class DeviceDetector;
+class NamingPolicy;
+class RuleIndex;
+class UdevManager;
+
+namespace cli {
+
+/**
+ * @brief Find the connected device described by a command line spec
+ *
+ * Accepted forms: device node (/dev/ttyUSB0 or ttyUSB0),
+ * vid:pid:serial (0403:6001:A50285BI) or USB port path (1-6.3).
+ * Interfaces of the same physical device are not considered ambiguous.
+ *
+ * @param devices Scanned devices
+ * @param spec Device spec
+ * @param error Set to a description when no single device matches
+ */
+std::optional<DeviceInfo> resolveDeviceSpec(const std::vector<DeviceInfo>& devices,
+                                            const std::string& spec,
+                                            std::string& error);
+
+/**
+ * @brief Create a rule for one device and apply it
+ *
+ * A tty of a multi-port adapter gets a rule for its USB interface, so it
+ * must be given by device node.
+ *
+ * @return Process exit code
+ */
+int createCommand(const std::string& spec, const std::string& symlinkName);
+
+/**
+ * @brief Name every interface of a multi-port adapter in one rule file
+ * @param spec Any tty of the device, or its vid:pid:serial or USB port
+ * @param names Base name (plc gives plc_A, plc_B, ...) or a comma
+ *              separated name per interface, in interface order
+ * @return Process exit code
+ */
+int createInterfacesCommand(const std::string& spec, const std::string& names);
+
+/**
+ * @brief Delete a rule by symlink name and apply the change
+ * @return Process exit code
+ */
+int deleteCommand(const std::string& symlinkName);
+
+/**
+ * @brief Run create/delete commands read from a stream
+ *
+ * One command per line: "create <spec> <name>" or "delete <name>".
+ * Blank lines and lines starting with '#' are ignored. Every command is
+ * validated before anything is written, with the checks createRule()
+ * and deleteRule() make, against the rules as the earlier lines leave
+ * them; udev is reloaded and triggered once at the end.
+ *
+ * @return Process exit code
+ */
+int batchCommand(std::istream& in);
+
+/**
+ * @brief batchCommand() on a given rule manager and device detector
+ *
+ * The detector is scanned on the first create.
+ */
+int batchCommand(std::istream& in, UdevManager& manager, DeviceDetector& detector);
+
+/**
+ * @brief A rule a naming policy asks for
+ */
+struct NameAssignment {
+    DeviceInfo device;
+    std::string symlinkName;
+    bool matchInterface = false;    // Rule matches the USB interface too
+    int policyLine = 0;             // Policy entry that gave the name
+};
+
+/**
+ * @brief Names for the candidates that have no rule yet
+ *
+ * Candidates are taken in USB port and interface order, and every name
+ * is added to pending before the next one is chosen, so within one plan
+ * colliding names get the same _2, _3 suffixes whatever order the
+ * devices attached in. Across plans (per-event --watch) the suffixes
+ * follow the order of the plans. Each assignment passes the same
+ * checks as createRule() against pending, so applyNames() only fails
+ * on write errors. Policy rules always match the USB interface: the
+ * ports of a multi-port adapter attach one event at a time, so a device
+ * cannot be known to be the only port when it is named.
+ *
+ * @param pending Rules so far (a copy of the manager's index); assignments are added
+ * @param errors Devices the policy named but no rule can be made for
+ */
+std::vector<NameAssignment> planNames(const NamingPolicy& policy, const std::vector<DeviceInfo>& candidates,
+                                      const UdevManager& manager, RuleIndex& pending,
+                                      std::vector<std::string>& errors);
+
+/**
+ * @brief Write planned rules, then reload udev and trigger just those devices
+ *
+ * The batch path: one reload and one trigger however many rules.
+ *
+ * @return Rules written; stops at the first failure, described in error
+ */
+size_t applyNames(UdevManager& manager, const std::vector<NameAssignment>& assignments, std::string& error);
+
+/**
+ * @brief Name every connected device without a rule by a naming policy
+ * @param dryRun Only print the names the policy would give
+ * @return Process exit code
+ */
+int autoNameCommand(const std::string& policyPath, bool dryRun, OutputFormat format);
+
+/**
+ * @brief Optional extras of --watch
+ */
+struct WatchOptions {
+    std::string metricsPath;    // Rewrite this metrics file after every event
+    bool portCounters = false;  // Include TIOCGICOUNT counters in the metrics
+    bool latency = false;       // Measure attach latency into the state file
+    bool history = true;        // Append events to the EventLog ring
+    unsigned coalesceMs = 0;    // Report bursts as one diff after this quiet time, 0 per event
+    std::string policyPath;     // Name new devices by this NamingPolicy file
+    std::string hooksPath;      // Run the hooks in this HookDispatcher file
+};
+
+/**
+ * @brief Stream hotplug events until interrupted
+ *
+ * With a policyPath, attached devices without a rule are named by the
+ * policy as they arrive (a whole burst at once with coalesceMs).
+ * With a hooksPath, events (or a burst's net changes) are handed to a
+ * HookDispatcher once naming is done; results are logged to stderr.
+ *
+ * Prints one line (text) or one record (ndjson/tsv; json is streamed as
+ * ndjson) per attach, detach or change of a serial device, with the
+ * matching easyTTY rule resolved from the in-memory rule index. With
+ * coalesceMs, a burst is reported as its net change once it is over.
+ *
+ * Devices that keep attaching and detaching are reported as flapping
+ * (see FlapDetector); in text output their events are left out until
+ * they are stable again.
+ *
+ * @param filter Only report devices matching this filter
+ * @return Process exit code
+ */
+int watchCommand(OutputFormat format, const Filter& filter, const WatchOptions& options = {});
+
+/**
+ * @brief Write node_exporter textfile metrics once
+ * @param path Metrics file, replaced atomically
+ * @param portCounters Include TIOCGICOUNT port counters
+ * @return Process exit code
+ */
+int metricsCommand(const std::string& path, bool portCounters);
+
+/**
+ * @brief Print the attach latency histograms recorded by --watch --latency
+ * @return Process exit code
+ */
+int latencyCommand(OutputFormat format);
+
+/**
+ * @brief Print the hotplug history recorded by --watch
+ *
+ * @param since Only events at or after this time: a duration back from
+ *              now (90s, 30m, 12h, 7d) or a local date/time
+ *              (2026-10-01, 2026-10-01T08:00); empty for all
+ * @param name Only events of the device named /dev/<name>
+ * @param filter Only events whose device matches this filter
+ * @return Process exit code
+ */
+int historyCommand(OutputFormat format, const Filter& filter, const std::string& since, const std::string& name);
+
+/**
+ * @brief Replay a recorded --watch trace through the monitor path
+ *
+ * Feeds the trace through a ReplayEventSource into a DeviceDetector
+ * with an empty device table, doing the same per-event work as --watch,
+ * and reports per-event latency (queued to handled), dropped events and
+ * the deepest the queue got.
+ *
+ * @param speed Speed factor, ReplayEventSource::MAX_SPEED for no delays
+ * @return 0, 2 if events were dropped, 1 on error
+ */
+int replayCommand(const std::string& path, double speed, OutputFormat format);
+
+/**
+ * @brief Heap allocations per scan and rule load, cold and warm
+ *
+ * Runs one refresh (device scan + rule load) on a cold process, then a
+ * few more, and reports allocations and bytes of the first and the last
+ * one per phase. Needs a build with -DEASYTTY_ALLOC_STATS=ON.
+ *
+ * @return Process exit code
+ */
+int statsCommand(OutputFormat format);
+
+/**
+ * @brief Archive the sysfs entries of all serial devices as a tar file
+ *
+ * The archive can be extracted anywhere and scanned with
+ * --device-source sysfs:<dir> to reproduce this machine's topology.
+ *
+ * @param path Output file, "-" for stdout
+ * @return Process exit code
+ */
+int snapshotCommand(const std::string& path);
+
+/**
+ * @brief Exit codes of --wait
+ */
+constexpr int WAIT_READY = 0;
+constexpr int WAIT_ERROR = 1;
+constexpr int WAIT_TIMEOUT = 2;
+constexpr int WAIT_WRONG_DEVICE = 3;
+
+// Longest --timeout accepted; "inf" means no timeout
+constexpr double WAIT_MAX_SECONDS = 30 * 86400;
+
+/**
+ * @brief Block until every named symlink points at a device matching its rule
+ *
+ * Event driven: inotify on /dev wakes on symlink creation and the udev
+ * monitor keeps the device table current, so there is no polling delay.
+ *
+ * @param names Symlink names (without /dev/)
+ * @param timeoutSeconds Give up after this long; negative, NaN or above
+ *                       WAIT_MAX_SECONDS waits forever
+ * @return WAIT_READY, WAIT_TIMEOUT, WAIT_WRONG_DEVICE (a name still
+ *         resolved to a non-matching device at the deadline) or WAIT_ERROR
+ */
+int waitCommand(const std::vector<std::string>& names, double timeoutSeconds);
+
+/**
+ * @brief Look up symlinks, device nodes, serials or port paths
+ *
+ * Devices and rules are loaded once into a DeviceIndex; every query is
+ * then a hash lookup. A query of "-" reads one query per line from
+ * stdin, so scripts can keep a single process open.
+ *
+ * @return 0 if every query matched, 1 otherwise
+ */
+int resolveCommand(const std::vector<std::string>& queries, OutputFormat format);
+
+/**
+ * @brief Remove rules whose devices have not been seen for a while
+ *
+ * Scans first so connected devices count as seen, then looks every
+ * rule up in the DeviceInventory. Rules missing for longer than the
+ * window are deleted (or moved to UdevManager::ARCHIVE_DIR) and udev is
+ * reloaded once for all of them.
+ *
+ * @param olderThan Window as a duration (90d, 12w)
+ * @param archive Move the rule files to the archive instead of deleting them
+ * @param dryRun Only list what would be removed
+ * @return Process exit code
+ */
+int gcCommand(const std::string& olderThan, bool archive, bool dryRun, OutputFormat format);
+
+/**
+ * @brief Nagios plugin exit codes of --check
+ */
+constexpr int CHECK_OK = 0;
+constexpr int CHECK_WARNING = 1;
+constexpr int CHECK_CRITICAL = 2;
+constexpr int CHECK_UNKNOWN = 3;
+
+/**
+ * @brief One-pass health check of all easyTTY rules
+ *
+ * CRITICAL: unparsable rule files, duplicate names, symlinks pointing at
+ * the wrong device, or a connected device without its symlink.
+ * WARNING: a rule whose device is not connected.
+ *
+ * @return Nagios-style exit code
+ */
+int checkCommand(OutputFormat format);
+
+} // namespace cli
+} // namespace easytty
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "common/Types.hpp"
+#include <cstdint>
+#include <string>
+
+namespace easytty {
+
+class DeviceDetector;
+class UdevManager;
+class LatencyTracker;
+
+namespace cli {
+
+/**
+ * @brief Writes node_exporter textfile collector metrics
+ *
+ * Metrics are rendered from the detector's and rule manager's in-memory
+ * tables into a reused buffer and published with a write to
+ * "<path>.tmp" followed by rename(), so the collector never reads a
+ * partial file and nothing is rescanned.
+ *
+ * Exported series:
+ *   easytty_devices{vendor_id,product_id}       connected devices
+ *   easytty_rules{state="active"|"inactive"}    rules by symlink state
+ *   easytty_rule_files_invalid                  unparsable rule files
+ *   easytty_name_device_present{name}           1 if a rule's device is connected
+ *   easytty_names_missing_device                rules without their device
+ *   easytty_hotplug_events_total{action}        (watch mode only)
+ *   easytty_scan_duration_seconds               last device scan
+ *   easytty_rule_load_duration_seconds          last rule load
+ *   easytty_port_*_total{port,name}             TIOCGICOUNT counters (opt-in)
+ *   easytty_attach_latency_seconds{stage,name}  attach latency summary per rule
+ *   easytty_attach_latency_by_driver_seconds{stage,driver}
+ *   easytty_metrics_timestamp_seconds           time of this write
+ */
+class MetricsExporter {
+public:
+    /**
+     * @param path Output file, normally in the collector's directory
+     *             and ending in .prom
+     * @param portCounters Read TIOCGICOUNT error counters from each port.
+     *             Opening a port may toggle DTR/RTS on some adapters,
+     *             so this is off unless asked for.
+     * @param eventCounters Export hotplug event counters (long-running
+     *             watch mode; meaningless for a one-shot write)
+     */
+    MetricsExporter(const std::string& path, bool portCounters, bool eventCounters);
+
+    /**
+     * @brief Count one hotplug event
+     */
+    void countEvent(DeviceAction action);
+
+    /**
+     * @brief Export latency summaries from this tracker (nullptr to stop)
+     */
+    void setLatencyTracker(const LatencyTracker* tracker) { latency_ = tracker; }
+
+    /**
+     * @brief Render and atomically replace the metrics file
+     */
+    OperationResult write(const DeviceDetector& detector, const UdevManager& manager);
+
+    const std::string& getPath() const { return path_; }
+
+private:
+    std::string path_;
+    std::string tmpPath_;
+    bool portCounters_;
+    bool eventCounters_;
+    uint64_t events_[3];     // Indexed by DeviceAction
+    const LatencyTracker* latency_;
+    std::string buffer_;     // Reused between writes
+
+    void header(const char* name, const char* type, const char* help);
+    void sample(const char* name, const std::string& labels, unsigned long long value);
+    void sample(const char* name, const std::string& labels, double value);
+    void appendPortCounters(const DeviceDetector& detector, const UdevManager& manager);
+    void appendLatency();
+};
+
+} // namespace cli
+} // namespace easytty
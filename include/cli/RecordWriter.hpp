@@ -0,0 +1,135 @@
+#pragma once
+
+#include "common/Types.hpp"
+#include <cstdio>
+#include <string>
+#include <optional>
+
+namespace easytty {
+namespace cli {
+
+/**
+ * @brief Output formats supported by the non-interactive commands
+ */
+enum class OutputFormat {
+    Text,       // Human readable (default)
+    Json,       // Single JSON array of records
+    Ndjson,     // One JSON object per line
+    Tsv         // Tab separated values with a header row
+};
+
+/**
+ * @brief Parse a --format argument (text, json, ndjson, tsv)
+ */
+std::optional<OutputFormat> parseOutputFormat(const std::string& name);
+
+/**
+ * @brief Buffered streaming writer for machine-readable records
+ *
+ * Records are serialized straight into an internal buffer which is
+ * written out in large chunks, so listing thousands of entries is a
+ * single pass without per-line flushes. Field names of the first record
+ * define the TSV header, unless beginHeader() declared them up front.
+ */
+class RecordWriter {
+public:
+    explicit RecordWriter(OutputFormat format, std::FILE* out = stdout, size_t bufferSize = 64 * 1024);
+    ~RecordWriter();
+
+    // Prevent copying
+    RecordWriter(const RecordWriter&) = delete;
+    RecordWriter& operator=(const RecordWriter&) = delete;
+
+    /**
+     * @brief Start declaring the fields of the records to come
+     *
+     * Fields written up to endHeader() are not output. In TSV their names
+     * become the header row, so the header is there even when no record
+     * follows. Write them as for a record of an empty item, before the
+     * first record.
+     */
+    void beginHeader();
+
+    /**
+     * @brief Finish the field declaration started by beginHeader()
+     */
+    void endHeader();
+
+    /**
+     * @brief Start a new record
+     */
+    void beginRecord();
+
+    /**
+     * @brief Add a field to the current record
+     */
+    void field(const char* name, const std::string& value);
+    void field(const char* name, const char* value);
+    void field(const char* name, int value) { field(name, static_cast<long long>(value)); }
+    void field(const char* name, long long value);
+    void field(const char* name, unsigned long long value);
+    void field(const char* name, bool value);
+
+    /**
+     * @brief Open a nested object field (flattened to "name.field" in TSV)
+     */
+    void beginObject(const char* name);
+
+    /**
+     * @brief Close the innermost nested object
+     */
+    void endObject();
+
+    /**
+     * @brief Finish the current record
+     */
+    void endRecord();
+
+    /**
+     * @brief Write buffered data to the output stream
+     */
+    void flush();
+
+    /**
+     * @brief Close the document (JSON array) and flush
+     */
+    void finish();
+
+    OutputFormat getFormat() const { return format_; }
+    size_t getRecordCount() const { return recordCount_; }
+
+private:
+    OutputFormat format_;
+    std::FILE* out_;
+    size_t bufferSize_;
+    std::string buffer_;
+    std::string tsvHeader_;
+    std::string tsvPrefix_;
+    size_t recordCount_;
+    bool firstField_;
+    size_t recordStart_;
+    bool tsvHeaderWritten_;
+    bool finished_;
+
+    /**
+     * @brief Emit separator and field name for the next field
+     */
+    void beginField(const char* name);
+
+    void appendJsonString(const char* data, size_t len);
+    void appendTsvValue(const char* data, size_t len);
+};
+
+/**
+ * @brief Write the fields of a device (names mirror DeviceInfo)
+ */
+void writeDeviceFields(RecordWriter& writer, const DeviceInfo& device);
+
+/**
+ * @brief Write the fields of a rule (names mirror UdevRule)
+ * @param isActive Result of UdevManager::verifySymlink for this rule
+ */
+void writeRuleFields(RecordWriter& writer, const UdevRule& rule, bool isActive);
+
+} // namespace cli
+} // namespace easytty
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstdint>
+
+namespace easytty {
+namespace alloc {
+
+/**
+ * @brief Code paths heap allocations are attributed to
+ *
+ * Allocations count towards the innermost active phase, so a rule load
+ * triggered by a menu rebuild is not counted twice.
+ */
+enum class Phase {
+    Other,
+    ScanDevices,
+    LoadRules,
+    MenuRebuild,
+    Render,
+    Count
+};
+
+struct PhaseStats {
+    uint64_t calls = 0;             // Times the phase was entered
+    uint64_t allocations = 0;       // Over all calls
+    uint64_t bytes = 0;
+    uint64_t lastAllocations = 0;   // During the most recent call
+    uint64_t lastBytes = 0;
+};
+
+/**
+ * @brief Whether this build counts allocations (-DEASYTTY_ALLOC_STATS=ON)
+ *
+ * The counting global operator new is only compiled in with the option;
+ * otherwise phase scopes are empty and all stats stay zero.
+ */
+#ifdef EASYTTY_ALLOC_STATS
+constexpr bool ENABLED = true;
+#else
+constexpr bool ENABLED = false;
+#endif
+
+const char* phaseName(Phase phase);
+
+PhaseStats getStats(Phase phase);
+
+/**
+ * @brief Attribute allocations to a phase until destruction or end()
+ */
+class PhaseScope {
+public:
+#ifdef EASYTTY_ALLOC_STATS
+    explicit PhaseScope(Phase phase);
+    ~PhaseScope() { end(); }
+
+    /**
+     * @brief Close the phase early (e.g. before handing over to a menu loop)
+     */
+    void end();
+#else
+    explicit PhaseScope(Phase) {}
+    void end() {}
+#endif
+
+    PhaseScope(const PhaseScope&) = delete;
+    PhaseScope& operator=(const PhaseScope&) = delete;
+
+#ifdef EASYTTY_ALLOC_STATS
+private:
+    Phase phase_;
+    Phase previous_;
+    uint64_t startAllocations_;
+    uint64_t startBytes_;
+    bool active_;
+#endif
+};
+
+} // namespace alloc
+} // namespace easytty
+
+#define EASYTTY_ALLOC_CONCAT_(a, b) a##b
+#define EASYTTY_ALLOC_CONCAT(a, b) EASYTTY_ALLOC_CONCAT_(a, b)
+
+/**
+ * @brief Count allocations of the rest of the enclosing scope: EASYTTY_ALLOC_PHASE(ScanDevices)
+ */
+#define EASYTTY_ALLOC_PHASE(phase) \
+    ::easytty::alloc::PhaseScope EASYTTY_ALLOC_CONCAT(easyttyAllocPhase_, __LINE__)(::easytty::alloc::Phase::phase)
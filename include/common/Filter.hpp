@@ -0,0 +1,110 @@
+#pragma once
+
+#include "common/Types.hpp"
+#include <string>
+#include <vector>
+#include <optional>
+
+namespace easytty {
+
+/**
+ * @brief Compiled filter expression over DeviceInfo / UdevRule fields
+ *
+ * Grammar:
+ *   expr    := or
+ *   or      := and ( "||" and )*
+ *   and     := unary ( "&&" unary )*
+ *   unary   := "!" unary | "(" expr ")" | compare
+ *   compare := field op value
+ *   op      := "==" | "!=" | "^=" (prefix) | "~" (glob) | "!~"
+ *   value   := bare word or "quoted string"
+ *
+ * Globs support '*' and '?'. Field names are the DeviceInfo / UdevRule
+ * member names plus the short aliases vid, pid, port, dev, node, iface,
+ * file and name. Fields a record does not have compare as empty.
+ *
+ * The expression is compiled once into a postfix program; matching
+ * walks the program with a fixed-size stack and never allocates.
+ *
+ * Example: vid==0403 && serial~"A5*" && port^="1-6."
+ */
+class Filter {
+public:
+    Filter() = default;
+
+    /**
+     * @brief Compile an expression
+     * @param expr Expression text
+     * @param error Set to a description on failure
+     * @return Compiled filter, or nullopt on a syntax error
+     */
+    static std::optional<Filter> compile(const std::string& expr, std::string& error);
+
+    /**
+     * @brief True if the filter has no expression (matches everything)
+     */
+    bool empty() const { return program_.empty(); }
+
+    /**
+     * @brief Source text of the expression
+     */
+    const std::string& getExpression() const { return expression_; }
+
+    bool matches(const DeviceInfo& device) const;
+    bool matches(const UdevRule& rule) const;
+
+    /**
+     * @brief Match a device together with the rule naming it (may be null)
+     *
+     * Device fields come from the device; symlink, name and file come
+     * from the rule.
+     */
+    bool matches(const DeviceInfo& device, const UdevRule* rule) const;
+
+    /**
+     * @brief Match a glob pattern ('*' and '?') against a string
+     */
+    static bool globMatch(const char* pattern, size_t patternLen, const char* str, size_t strLen);
+
+    // Maximum evaluator stack depth, and maximum nesting of '!' and '('
+    static constexpr size_t MAX_DEPTH = 32;
+
+    enum class Field {
+        DevPath, SysPath, Subsystem, Vendor, VendorId, ProductId, Serial,
+        Manufacturer, Product, Driver, DevNode, BusNum, DevNum, InterfaceNum,
+        KernelPath, Name, Symlink, FilePath
+    };
+
+    /**
+     * @brief Field by name or alias (case-insensitive)
+     */
+    static std::optional<Field> findField(const std::string& name);
+
+    /**
+     * @brief Value of a field in a device record, empty for rule-only fields
+     */
+    static const std::string& fieldValue(const DeviceInfo& device, Field field);
+
+    enum class OpCode {
+        Equal, NotEqual, Prefix, Glob, NotGlob,     // Comparisons push a result
+        And, Or, Not                                // Combinators pop operands
+    };
+
+    struct Instruction {
+        OpCode op;
+        Field field;
+        size_t value;       // Index into values_ for comparisons
+    };
+
+private:
+    std::string expression_;
+    std::vector<Instruction> program_;
+    std::vector<std::string> values_;
+
+    template <typename Record>
+    bool evaluate(const Record& record) const;
+
+    friend class FilterParser;
+};
+
+} // namespace easytty
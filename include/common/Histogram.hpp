@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace easytty {
+
+/**
+ * @brief Log-linear (HDR-style) histogram of non-negative integer values
+ *
+ * Values below 2^SUB_BITS get a bucket each; above that every power of
+ * two is split into 2^SUB_BITS linear sub-buckets, so any recorded value
+ * is reported within ~3% regardless of magnitude. Recording is an index
+ * computation and an increment; memory is fixed at construction.
+ *
+ * Used for microsecond latencies: the range covers up to ~38 hours,
+ * larger values are clamped into the last bucket.
+ */
+class Histogram {
+public:
+    static constexpr int SUB_BITS = 5;
+    static constexpr uint64_t SUB_COUNT = 1u << SUB_BITS;
+    static constexpr int MAX_SHIFT = 32;
+    static constexpr size_t BUCKET_COUNT = SUB_COUNT * (MAX_SHIFT + 2);
+
+    Histogram();
+
+    void record(uint64_t value);
+
+    /**
+     * @brief Add all samples of another histogram
+     */
+    void merge(const Histogram& other);
+
+    uint64_t count() const { return count_; }
+    uint64_t sum() const { return sum_; }
+    uint64_t min() const { return count_ ? min_ : 0; }
+    uint64_t max() const { return max_; }
+    double mean() const { return count_ ? static_cast<double>(sum_) / count_ : 0.0; }
+
+    /**
+     * @brief Value at or below which the given fraction of samples fall
+     * @param quantile 0.0 - 1.0
+     * @return Upper bound of the bucket holding that sample (clamped to max)
+     */
+    uint64_t percentile(double quantile) const;
+
+    /**
+     * @brief Compact text form: "count sum min max idx:n idx:n ..."
+     */
+    std::string serialize() const;
+
+    /**
+     * @brief Restore from serialize() output
+     * @return false if the text is malformed (histogram left empty)
+     */
+    bool deserialize(const std::string& text);
+
+    static size_t bucketIndex(uint64_t value);
+    static uint64_t bucketUpperBound(size_t index);
+
+private:
+    std::vector<uint64_t> buckets_;
+    uint64_t count_;
+    uint64_t sum_;
+    uint64_t min_;
+    uint64_t max_;
+};
+
+} // namespace easytty
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace easytty {
+
+/**
+ * @brief Minimal JSON document model for reading fixtures and state files
+ *
+ * Objects keep their members in file order; lookups are linear, which is
+ * fine for the small records easyTTY reads.
+ */
+class JsonValue {
+public:
+    enum class Type { Null, Bool, Number, String, Array, Object };
+
+    Type type = Type::Null;
+    bool boolean = false;
+    double number = 0;
+    std::string string;
+    std::vector<JsonValue> array;
+    std::vector<std::pair<std::string, JsonValue>> object;
+
+    /**
+     * @brief Parse a complete JSON text
+     * @param error Set to a description with the byte offset on failure
+     */
+    static std::optional<JsonValue> parse(const std::string& text, std::string& error);
+
+    bool isObject() const { return type == Type::Object; }
+    bool isArray() const { return type == Type::Array; }
+
+    /**
+     * @brief Member of an object, nullptr if absent or not an object
+     */
+    const JsonValue* find(const std::string& key) const;
+
+    /**
+     * @brief Scalar as text: strings as-is, numbers without a trailing
+     *        ".0", booleans as true/false, anything else empty
+     */
+    std::string asString() const;
+
+    // Nesting limit of the parser
+    static constexpr size_t MAX_DEPTH = 64;
+};
+
+} // namespace easytty
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "common/Types.hpp"
+#include <cstdio>
+#include <string>
+
+namespace easytty {
+
+/**
+ * @brief Streaming writer for POSIX ustar archives
+ *
+ * Supports directories, regular files and symlinks, which is all a
+ * sysfs snapshot needs. Paths may be up to 255 bytes (split into the
+ * ustar prefix and name fields).
+ */
+class TarWriter {
+public:
+    explicit TarWriter(std::FILE* out);
+
+    OperationResult addDirectory(const std::string& path);
+    OperationResult addFile(const std::string& path, const std::string& content);
+    OperationResult addSymlink(const std::string& path, const std::string& target);
+
+    /**
+     * @brief Write the end-of-archive marker
+     */
+    OperationResult finish();
+
+private:
+    std::FILE* out_;
+
+    OperationResult writeHeader(const std::string& path, char type, size_t size,
+                                unsigned mode, const std::string& linkTarget);
+};
+
+} // namespace easytty
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace easytty {
+namespace trace {
+
+namespace detail {
+// Set once at startup, before any other thread exists
+inline bool gEnabled = false;
+
+uint64_t nowMicros();
+void record(const char* name, const std::string& detail, uint64_t startUs, uint64_t endUs);
+} // namespace detail
+
+/**
+ * @brief Enable tracing if EASYTTY_TRACE names an output file
+ *
+ * Spans are then collected in per-thread buffers and written as
+ * Chrome trace-event JSON (chrome://tracing, ui.perfetto.dev) when the
+ * process exits. Call from main() before starting any threads.
+ */
+void initFromEnvironment();
+
+/**
+ * @brief Write collected spans to the trace file now
+ *
+ * Called automatically at exit; safe to call more than once.
+ */
+void flush();
+
+inline bool enabled() { return detail::gEnabled; }
+
+/**
+ * @brief Scoped span recorded from construction to destruction
+ *
+ * When tracing is disabled the constructor is a single branch and the
+ * destructor a test of the zero start time.
+ */
+class Span {
+public:
+    explicit Span(const char* name)
+        : name_(name), start_(detail::gEnabled ? detail::nowMicros() : 0) {}
+
+    /**
+     * @param detail Extra text shown in the span's args (file, command)
+     */
+    Span(const char* name, const std::string& detail)
+        : name_(name), start_(0) {
+        if (detail::gEnabled) {
+            detail_ = detail;
+            start_ = detail::nowMicros();
+        }
+    }
+
+    /**
+     * @param prefix Text put before detail, joined only when tracing is on
+     *               (so callers never build a string for a disabled trace)
+     */
+    Span(const char* name, const char* prefix, const std::string& detail)
+        : name_(name), start_(0) {
+        if (detail::gEnabled) {
+            detail_ = std::string(prefix) + " " + detail;
+            start_ = detail::nowMicros();
+        }
+    }
+
+    ~Span() {
+        if (start_ != 0) {
+            detail::record(name_, detail_, start_, detail::nowMicros());
+        }
+    }
+
+    Span(const Span&) = delete;
+    Span& operator=(const Span&) = delete;
+
+private:
+    const char* name_;
+    uint64_t start_;
+    std::string detail_;
+};
+
+} // namespace trace
+} // namespace easytty
+
+#define EASYTTY_TRACE_CONCAT_(a, b) a##b
+#define EASYTTY_TRACE_CONCAT(a, b) EASYTTY_TRACE_CONCAT_(a, b)
+
+/**
+ * @brief Trace the rest of the enclosing scope: EASYTTY_TRACE_SPAN("name"[, [prefix,] detail])
+ */
+#define EASYTTY_TRACE_SPAN(...) \
+    ::easytty::trace::Span EASYTTY_TRACE_CONCAT(easyttyTraceSpan_, __LINE__)(__VA_ARGS__)
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <string>
+#include <cstdint>
 #include <vector>
 #include <optional>
 #include <memory>
@@ -49,6 +50,49 @@ struct DeviceInfo {
     }
 };
 
+/**
+ * @brief Hotplug action reported by the device monitor
+ */
+enum class DeviceAction {
+    Add,
+    Remove,
+    Change
+};
+
+inline const char* toString(DeviceAction action) {
+    switch (action) {
+        case DeviceAction::Add:    return "add";
+        case DeviceAction::Remove: return "remove";
+        case DeviceAction::Change: return "change";
+    }
+    return "unknown";
+}
+
+/**
+ * @brief Hotplug event for a serial device
+ */
+struct DeviceEvent {
+    DeviceAction action;
+    DeviceInfo device;
+    uint64_t seqnum;            // Kernel uevent sequence number
+    uint64_t timestampUsec;     // Wall clock (CLOCK_REALTIME) when the event was received
+    uint64_t initializedUsec;   // udev USEC_INITIALIZED (CLOCK_MONOTONIC), 0 if unknown
+};
+
+/**
+ * @brief Net effect of a burst of hotplug events on the device table
+ */
+struct DeviceDiff {
+    std::vector<DeviceInfo> added;
+    std::vector<DeviceInfo> removed;
+    std::vector<DeviceInfo> changed;    // Attributes changed, or detached and reattached
+    size_t events = 0;                  // Raw events folded into this diff
+    
+    bool empty() const {
+        return added.empty() && removed.empty() && changed.empty();
+    }
+};
+
 /**
  * @brief udev rule structure
  */
@@ -72,6 +116,10 @@ struct UdevRule {
         if (vendorId != device.vendorId || productId != device.productId) {
             return false;
         }
+        // An interface rule names one port of a multi-port adapter
+        if (!interfaceNum.empty() && interfaceNum != device.interfaceNum) {
+            return false;
+        }
         // If rule has serial, device must match it
         if (!serial.empty()) {
             return serial == device.serial;
@@ -6,6 +6,8 @@
 #include <algorithm>
 #include <cctype>
 #include <regex>
+#include <ctime>
+#include <cstdint>
 
 namespace easytty {
 namespace utils {
@@ -109,11 +111,45 @@ inline std::string formatHexId(const std::string& id) {
     return toLower(result);
 }
 
+/**
+ * @brief Format a time in local time, like date(1) does
+ */
+std::string formatLocalTime(std::time_t time);
+
+/**
+ * @brief Format a time as a local date (YYYY-MM-DD)
+ */
+std::string formatLocalDate(std::time_t time);
+
+/**
+ * @brief Format microseconds since the epoch as local ISO 8601 with microseconds
+ */
+std::string formatTimestampUsec(uint64_t usec);
+
+/**
+ * @brief Parse a duration such as 90s, 30m, 12h, 7d or 2w
+ * @return False if the text is not a number followed by one of s/m/h/d/w
+ */
+bool parseDuration(const std::string& text, uint64_t& seconds);
+
 /**
  * @brief Execute shell command and return output
  */
 std::string executeCommand(const std::string& cmd);
 
+/**
+ * @brief Install SIGINT/SIGTERM handlers that set a stop flag
+ * 
+ * Handlers are installed without SA_RESTART so blocking calls such as
+ * poll() return EINTR and long-running loops can exit cleanly.
+ */
+void installStopHandler();
+
+/**
+ * @brief Check if SIGINT/SIGTERM was received
+ */
+bool stopRequested();
+
 /**
  * @brief Check if running as root
  */
@@ -1,9 +1,13 @@
 #pragma once
 
 #include "common/Types.hpp"
+#include "device/DeviceSource.hpp"
+#include "device/EventSource.hpp"
 #include <vector>
+#include <atomic>
 #include <memory>
-#include <libudev.h>
+#include <chrono>
+#include <map>
 
 namespace easytty {
 
@@ -12,10 +16,34 @@ namespace easytty {
  * 
  * Scans the system for serial devices (ttyUSB, ttyACM, etc.)
  * and retrieves their USB attributes for udev rule generation.
+ * Scans go through a DeviceSource, so fixtures and sysfs snapshots
+ * can stand in for the live system; hotplug monitoring is always live,
+ * through udevd or straight from the kernel (see EventSource).
+ * 
+ * Scans and events come from one thread. The device list is never
+ * changed in place: each change publishes a new immutable list, so
+ * other threads can read getSnapshot() without locking and never see
+ * a half-built list.
  */
 class DeviceDetector {
 public:
+    /**
+     * @brief Immutable device list, shared by everyone still reading it
+     */
+    using DeviceList = std::shared_ptr<const std::vector<DeviceInfo>>;
+    
+    /**
+     * @brief Detector on the source selected by EASYTTY_DEVICE_SOURCE
+     */
     DeviceDetector();
+    
+    /**
+     * @brief Detector on an explicit source
+     * @param events Hotplug events for startMonitor(); null selects the
+     *               one EASYTTY_EVENT_SOURCE names
+     */
+    explicit DeviceDetector(std::unique_ptr<DeviceSource> source,
+                            std::unique_ptr<EventSource> events = nullptr);
     ~DeviceDetector();
     
     // Prevent copying
@@ -49,32 +77,140 @@ public:
     
     /**
      * @brief Get all currently detected devices
+     * 
+     * For the thread that scans and receives events. The reference dies
+     * at the next scan or event: code that may rescan while it holds the
+     * list, and other threads, keep getSnapshot() instead.
+     */
+    const std::vector<DeviceInfo>& getDevices() const { return *devices_; }
+    
+    /**
+     * @brief Current device list, safe to keep and read from any thread
      */
-    const std::vector<DeviceInfo>& getDevices() const { return devices_; }
+    DeviceList getSnapshot() const { return std::atomic_load(&devices_); }
+    
+    /**
+     * @brief Identity of the physical USB device a tty belongs to
+     * 
+     * Multi-port adapters (FT4232H, CP2108, ...) show up as one tty per
+     * USB interface. Their interfaces share the USB port, so the key is
+     * vid:pid@port, or vid:pid plus bus/device number without a port.
+     */
+    static std::string physicalDeviceKey(const DeviceInfo& device);
+    
+    /**
+     * @brief Group ttys by physical device
+     * @return Groups in order of their first tty, each ordered by
+     *         interface number; single-interface devices form groups of one
+     */
+    static std::vector<std::vector<DeviceInfo>> groupInterfaces(const std::vector<DeviceInfo>& devices);
+    
+    /**
+     * @brief Wall time spent in the last full scan
+     */
+    std::chrono::microseconds getLastScanDuration() const { return lastScanDuration_; }
+    
+    /**
+     * @brief Start listening for hotplug events
+     * 
+     * Uses the EventSource selected by EASYTTY_EVENT_SOURCE.
+     * 
+     * @return True if the monitor is running
+     */
+    bool startMonitor();
+    
+    /**
+     * @brief Stop the hotplug monitor
+     */
+    void stopMonitor();
+    
+    /**
+     * @brief File descriptor to poll for hotplug events, -1 if not monitoring
+     */
+    int getMonitorFd() const;
+    
+    /**
+     * @brief Receive one pending hotplug event
+     * 
+     * Publishes the updated device list, so getDevices() stays current
+     * without rescanning. Events for non-serial tty devices are consumed
+     * and skipped.
+     * 
+     * @return Event if a serial device changed
+     */
+    std::optional<DeviceEvent> receiveEvent();
+    
+    /**
+     * @brief Coalesce hotplug bursts into one DeviceDiff
+     * 
+     * With a non-zero window, receiveEvent() also collects what each event
+     * changed until the events pause for the window (or keep coming for
+     * four windows), and takeBurst() then returns the net change. A hub
+     * power cycle becomes one diff instead of dozens of events.
+     * 
+     * @param window Quiet time that ends a burst, zero to disable
+     */
+    void setCoalesceWindow(std::chrono::milliseconds window);
+    
+    /**
+     * @brief Take the burst collected so far once it has ended
+     * @return Net change of the burst; nothing while it is still going on,
+     *         or if no event arrived
+     */
+    std::optional<DeviceDiff> takeBurst();
+    
+    /**
+     * @brief poll() timeout until the current burst ends, -1 if none
+     */
+    int burstTimeoutMs() const;
+    
+    /**
+     * @brief The source scans read from
+     */
+    const DeviceSource& getSource() const { return *source_; }
+    
+    /**
+     * @brief The source hotplug events come from, null if none was chosen yet
+     */
+    const EventSource* getEventSource() const { return events_.get(); }
 
 private:
-    struct udev* udev_;
-    std::vector<DeviceInfo> devices_;
+    std::unique_ptr<DeviceSource> source_;
+    std::unique_ptr<EventSource> events_;
+    bool monitoring_;
+    DeviceList devices_;
+    std::chrono::microseconds lastScanDuration_;
+    
+    // Devices a burst touched, with their state before it
+    struct BurstEntry {
+        std::optional<DeviceInfo> before;
+        bool detached = false;
+    };
+    std::chrono::milliseconds coalesceWindow_;
+    std::map<std::string, BurstEntry> burst_;
+    size_t burstEvents_;
+    std::chrono::steady_clock::time_point burstStart_;
+    std::chrono::steady_clock::time_point burstLast_;
     
     /**
-     * @brief Extract device information from udev device
+     * @brief Remember what an event is about to change in the current burst
      */
-    DeviceInfo extractDeviceInfo(struct udev_device* dev);
+    void noteBurst(const DeviceEvent& event);
     
     /**
-     * @brief Find parent USB device
+     * @brief Time the current burst ends
      */
-    struct udev_device* findUsbParent(struct udev_device* dev);
+    std::chrono::steady_clock::time_point burstDeadline() const;
     
     /**
-     * @brief Get udev attribute safely
+     * @brief Apply an event to the device list
      */
-    std::string getAttr(struct udev_device* dev, const char* attr);
+    void applyEvent(DeviceEvent& event);
     
     /**
-     * @brief Get sysattr safely
+     * @brief Make a new device list the current one
      */
-    std::string getSysAttr(struct udev_device* dev, const char* attr);
+    void publish(std::vector<DeviceInfo> devices);
 };
 
 } // namespace easytty
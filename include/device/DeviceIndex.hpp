@@ -0,0 +1,104 @@
+#pragma once
+
+#include "common/Types.hpp"
+#include "udev/RuleIndex.hpp"
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+namespace easytty {
+
+/**
+ * @brief State of a rule's symlink relative to its device
+ */
+enum class LinkStatus {
+    Unmanaged,      // Device has no easyTTY rule
+    Missing,        // Rule exists but /dev/<symlink> does not
+    Active,         // /dev/<symlink> resolves to the matching device
+    WrongDevice     // /dev/<symlink> resolves to some other node
+};
+
+inline const char* toString(LinkStatus status) {
+    switch (status) {
+        case LinkStatus::Unmanaged:   return "unmanaged";
+        case LinkStatus::Missing:     return "missing";
+        case LinkStatus::Active:      return "active";
+        case LinkStatus::WrongDevice: return "wrong-device";
+    }
+    return "unknown";
+}
+
+/**
+ * @brief A device joined with the rule that names it
+ *
+ * Either side may be null: a connected device without a rule, or a
+ * rule whose device is not connected.
+ */
+struct DeviceRecord {
+    const DeviceInfo* device;
+    const UdevRule* rule;
+};
+
+/**
+ * @brief Joined index over detected devices and easyTTY rules
+ *
+ * Resolves a symlink, device node, serial number, vid:pid:serial or USB
+ * port path to device/rule records with hash lookups. The index keeps
+ * its own copies, so it stays valid while the detector and rule
+ * manager rescan.
+ */
+class DeviceIndex {
+public:
+    DeviceIndex() = default;
+
+    // Records point into the index itself
+    DeviceIndex(const DeviceIndex&) = delete;
+    DeviceIndex& operator=(const DeviceIndex&) = delete;
+
+    /**
+     * @brief Rebuild from a device scan and the loaded rules
+     */
+    void build(const std::vector<DeviceInfo>& devices, const std::vector<UdevRule>& rules);
+
+    /**
+     * @brief Resolve a query to matching records
+     * @param query /dev/<symlink>, <symlink>, /dev/ttyUSB0, ttyUSB0,
+     *              serial, vid:pid:serial or USB port path
+     * @return Matching records (several when a serial or port is shared
+     *         by the interfaces of one adapter), empty if nothing matches
+     */
+    std::vector<DeviceRecord> resolve(const std::string& query) const;
+
+    /**
+     * @brief Rule naming a device, nullptr if none
+     */
+    const UdevRule* ruleForDevice(const DeviceInfo& device) const;
+
+    /**
+     * @brief Connected device matched by a rule, nullptr if absent
+     */
+    const DeviceInfo* deviceForRule(const UdevRule& rule) const;
+
+    /**
+     * @brief Check the symlink of a record against its device
+     */
+    LinkStatus linkStatus(const DeviceRecord& record) const;
+
+    const std::vector<DeviceInfo>& getDevices() const { return devices_; }
+    const std::vector<UdevRule>& getRules() const { return rules_; }
+    const RuleIndex& getRuleIndex() const { return ruleIndex_; }
+
+private:
+    std::vector<DeviceInfo> devices_;
+    std::vector<UdevRule> rules_;
+    RuleIndex ruleIndex_;
+
+    // Lookup key (devPath, devNode, serial, port, uniqueId) -> device positions
+    std::unordered_map<std::string, std::vector<size_t>> byKey_;
+    // Device position -> rule owned by ruleIndex_ (or nullptr)
+    std::vector<const UdevRule*> deviceRule_;
+    // Symlink -> device position
+    std::unordered_map<std::string, size_t> symlinkDevice_;
+};
+
+} // namespace easytty
@@ -0,0 +1,125 @@
+#pragma once
+
+#include "common/Types.hpp"
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace easytty {
+
+/**
+ * @brief Every device easyTTY has seen, with when and where
+ *
+ * One entry per device identity, the same identity a rule matches on:
+ * vid:pid:serial, or vid:pid@port for devices without a serial (whose
+ * getUniqueId() bus/device numbers change on every replug). Entries record
+ * when the device was first and last seen and the USB ports it used.
+ *
+ * The inventory is fed from --watch events and from the scans of --gc,
+ * --list --record and the TUI's stale rules view. Plain listing does not
+ * record, so it needs no write access to the state file. Last-seen times are kept at LAST_SEEN_RESOLUTION, so
+ * a rescan of the same devices changes nothing and the state file is
+ * only rewritten when something moved.
+ */
+class DeviceInventory {
+public:
+    struct Entry {
+        std::string vendorId;
+        std::string productId;
+        std::string serial;             // Empty for devices identified by port
+        uint64_t firstSeen = 0;         // Unix seconds
+        uint64_t lastSeen = 0;
+        std::vector<std::string> ports; // USB ports used, oldest first
+        std::string devNode;            // As last seen, e.g. ttyUSB0
+        std::string product;
+    };
+
+    /**
+     * @brief A rule whose device has not been seen since missingSince
+     */
+    struct StaleRule {
+        UdevRule rule;
+        std::optional<uint64_t> lastSeen;   // Nothing if never seen
+        uint64_t missingSince = 0;          // lastSeen, or when tracking (or the rule) started
+    };
+
+    static constexpr const char* STATE_FILE = "/var/lib/easytty/inventory.state";
+    static constexpr uint64_t LAST_SEEN_RESOLUTION = 3600;
+    static constexpr size_t MAX_PORTS = 8;
+
+    /**
+     * @brief Identity of a device in the inventory, empty if it has none
+     */
+    static std::string deviceKey(const DeviceInfo& device);
+
+    /**
+     * @brief Record that a device is present at nowSec
+     */
+    void observe(const DeviceInfo& device, uint64_t nowSec);
+
+    /**
+     * @brief Record the result of a full scan
+     */
+    void observe(const std::vector<DeviceInfo>& devices, uint64_t nowSec);
+
+    /**
+     * @brief True once after the inventory changed enough to be saved
+     */
+    bool takeChanged();
+
+    const Entry* find(const DeviceInfo& device) const;
+
+    /**
+     * @brief Most recent time a device matching the rule was seen
+     * @return Nothing if no matching device was ever seen
+     */
+    std::optional<uint64_t> lastSeenForRule(const UdevRule& rule) const;
+
+    /**
+     * @brief Rules whose devices have not been seen since cutoffSec
+     *
+     * A rule whose device was never seen counts as missing since the
+     * inventory started recording or the rule file was written, whichever
+     * is later, so a fresh inventory reports nothing as stale.
+     */
+    std::vector<StaleRule> findStaleRules(const std::vector<UdevRule>& rules, uint64_t cutoffSec) const;
+
+    const std::map<std::string, Entry>& getEntries() const { return entries_; }
+
+    /**
+     * @brief When this inventory started recording (Unix seconds)
+     *
+     * A rule whose device was never seen has not been missing for longer
+     * than this.
+     */
+    uint64_t getTrackingSince() const { return trackingSince_; }
+
+    /**
+     * @brief Write the inventory to a state file (atomic replace)
+     */
+    OperationResult save(const std::string& path = STATE_FILE) const;
+
+    /**
+     * @brief Replace the inventory with the one in a state file
+     * @return false if the file does not exist or cannot be read
+     */
+    bool load(const std::string& path = STATE_FILE);
+
+    /**
+     * @brief Load the state file, record a scan and save it if it changed
+     *
+     * For one-shot commands that record on request.
+     *
+     * @return Failure only if the changed inventory could not be saved
+     */
+    static OperationResult recordScan(const std::vector<DeviceInfo>& devices);
+
+private:
+    std::map<std::string, Entry> entries_;
+    uint64_t trackingSince_ = 0;
+    bool changed_ = false;
+};
+
+} // namespace easytty
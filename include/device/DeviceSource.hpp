@@ -0,0 +1,72 @@
+#pragma once
+
+#include "common/Types.hpp"
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace easytty {
+
+/**
+ * @brief Where DeviceDetector gets its serial devices from
+ *
+ * Backends:
+ *   udev           live libudev database (default)
+ *   fixture:<file> JSON array of DeviceInfo records, e.g. the output of
+ *                  `easyTTY --list --format json`
+ *   sysfs:<root>   sysfs tree below <root>, such as an extracted
+ *                  --capture-snapshot archive ("sysfs:/" reads the live
+ *                  system without libudev)
+ *
+ * The backend is chosen with the EASYTTY_DEVICE_SOURCE environment
+ * variable (or --device-source), so every detector in the process uses
+ * the same one.
+ */
+class DeviceSource {
+public:
+    virtual ~DeviceSource() = default;
+
+    /**
+     * @brief All serial devices, in no particular order
+     */
+    virtual std::vector<DeviceInfo> enumerate() = 0;
+
+    /**
+     * @brief A single device by node (e.g. /dev/ttyUSB0)
+     *
+     * The default enumerates everything and picks the match.
+     */
+    virtual std::optional<DeviceInfo> lookup(const std::string& devPath);
+
+    /**
+     * @brief Backend name for diagnostics
+     */
+    virtual const char* name() const = 0;
+
+    /**
+     * @brief True if the devices are the ones attached to this machine,
+     *        not a fixture or snapshot (only those go into the inventory)
+     */
+    virtual bool isLive() const { return false; }
+
+    /**
+     * @brief Create a backend from a spec (udev, fixture:<file>, sysfs:<root>)
+     * @throws std::runtime_error for an unknown spec or unreadable source
+     */
+    static std::unique_ptr<DeviceSource> create(const std::string& spec);
+
+    /**
+     * @brief Backend selected by EASYTTY_DEVICE_SOURCE, udev if unset
+     */
+    static std::unique_ptr<DeviceSource> createDefault();
+
+    /**
+     * @brief Check if a device node is one of the serial devices we manage
+     */
+    static bool isSerialDevNode(const std::string& devPath);
+
+    static constexpr const char* ENV_VAR = "EASYTTY_DEVICE_SOURCE";
+};
+
+} // namespace easytty
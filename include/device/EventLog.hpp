@@ -0,0 +1,92 @@
+#pragma once
+
+#include "common/Types.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace easytty {
+
+/**
+ * @brief Persistent hotplug history in a fixed-size memory-mapped ring
+ *
+ * Every attach, detach and change seen by --watch is written as one
+ * fixed-size record into a file under /var/lib/easytty, overwriting the
+ * oldest record once the ring is full. Records go into a shared mapping
+ * and are never fsynced: the page cache survives a crash of the process,
+ * and the kernel writes it back in the background. Each record carries a
+ * checksum, so one torn by a power loss is skipped instead of misread.
+ *
+ * The default 6 MiB hold 32768 events, three weeks of a port flapping
+ * once a minute.
+ */
+class EventLog {
+public:
+    /**
+     * @brief One logged event, as read back by --history
+     *
+     * Device fields are truncated to the record's fixed sizes.
+     */
+    struct Entry {
+        uint64_t sequence;          // Write order, 1-based
+        uint64_t timestampUsec;     // Wall clock when the event was received
+        uint64_t seqnum;            // Kernel uevent sequence number
+        DeviceAction action;
+        DeviceInfo device;          // devPath, devNode, vendorId, productId, serial, kernelPath, interfaceNum
+        std::string symlink;        // Name the rule gave the device, empty if unmanaged
+    };
+
+    /**
+     * @brief On-disk record layout, defined in EventLog.cpp
+     */
+    struct Record;
+
+    static constexpr const char* DEFAULT_PATH = "/var/lib/easytty/events.log";
+    static constexpr size_t DEFAULT_CAPACITY = 32768;
+
+    EventLog();
+    ~EventLog();
+
+    // Prevent copying
+    EventLog(const EventLog&) = delete;
+    EventLog& operator=(const EventLog&) = delete;
+
+    /**
+     * @brief Open or create the ring for appending
+     *
+     * An existing ring keeps its capacity and contents. Only one writer
+     * may have the file open; a second one fails.
+     *
+     * @param capacity Records in a newly created ring
+     */
+    OperationResult open(const std::string& path = DEFAULT_PATH, size_t capacity = DEFAULT_CAPACITY);
+
+    bool isOpen() const { return records_ != nullptr; }
+
+    /**
+     * @brief Append an event, overwriting the oldest one when full
+     * @param rule Rule naming the device, nullptr if unmanaged
+     */
+    void append(const DeviceEvent& event, const UdevRule* rule);
+
+    /**
+     * @brief Read all events at or after sinceUsec, oldest first
+     *
+     * Works while a writer is appending; a record being overwritten at
+     * that moment fails its checksum and is left out.
+     */
+    static OperationResult read(const std::string& path, uint64_t sinceUsec, std::vector<Entry>& entries);
+
+private:
+    int fd_;
+    void* mapping_;
+    size_t mappingSize_;
+    Record* records_;
+    size_t capacity_;
+    uint64_t nextSequence_;
+
+    void close();
+};
+
+} // namespace easytty
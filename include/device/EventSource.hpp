@@ -0,0 +1,82 @@
+#pragma once
+
+#include "common/Types.hpp"
+#include <memory>
+#include <optional>
+#include <string>
+
+namespace easytty {
+
+/**
+ * @brief Where DeviceDetector gets its hotplug events from
+ *
+ * Backends:
+ *   udev    processed events from udevd via libudev (rules applied,
+ *           ID_* properties and USEC_INITIALIZED available)
+ *   kernel  raw NETLINK_KOBJECT_UEVENT messages, for initramfs and early
+ *           boot where udevd is not running (initial network namespace
+ *           only: containers with their own receive nothing)
+ *   auto    udev if udevd is running, kernel otherwise (default)
+ *   replay:<file>[@<speed>]
+ *           a recorded --watch trace at 1x (default), 10x, ... or max
+ *           speed, see ReplayEventSource
+ *
+ * The backend is chosen with the EASYTTY_EVENT_SOURCE environment
+ * variable (or --event-source).
+ */
+class EventSource {
+public:
+    virtual ~EventSource() = default;
+
+    /**
+     * @brief Open the event socket
+     * @return False if it cannot be opened
+     */
+    virtual bool start() = 0;
+
+    /**
+     * @brief File descriptor to poll for events, -1 if not started
+     */
+    virtual int getFd() const = 0;
+
+    /**
+     * @brief Receive one pending event without blocking
+     *
+     * Events for non-serial devices are consumed and skipped. Remove
+     * events may carry only the device node; DeviceDetector fills in the
+     * rest from its device table.
+     *
+     * @return Event if a serial device changed
+     */
+    virtual std::optional<DeviceEvent> receive() = 0;
+
+    /**
+     * @brief Backend name for diagnostics
+     */
+    virtual const char* name() const = 0;
+
+    /**
+     * @brief True if the events come from this machine, not a recording
+     */
+    virtual bool isLive() const { return true; }
+
+    /**
+     * @brief Create a backend from a spec (auto, udev, kernel, replay:<file>)
+     * @throws std::runtime_error for an unknown spec or unreadable trace
+     */
+    static std::unique_ptr<EventSource> create(const std::string& spec);
+
+    /**
+     * @brief Backend selected by EASYTTY_EVENT_SOURCE, auto if unset
+     */
+    static std::unique_ptr<EventSource> createDefault();
+
+    /**
+     * @brief Check whether udevd is running (its control socket exists)
+     */
+    static bool udevdRunning();
+
+    static constexpr const char* ENV_VAR = "EASYTTY_EVENT_SOURCE";
+};
+
+} // namespace easytty
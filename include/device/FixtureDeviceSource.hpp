@@ -0,0 +1,39 @@
+#pragma once
+
+#include "device/DeviceSource.hpp"
+#include "common/Json.hpp"
+
+namespace easytty {
+
+/**
+ * @brief Device source serving a fixed device list
+ *
+ * Loaded from a JSON array of objects using the DeviceInfo field names
+ * (devPath, vendorId, serial, kernelPath, ...), which is exactly what
+ * `easyTTY --list --format json` prints. Missing fields stay empty.
+ */
+class FixtureDeviceSource : public DeviceSource {
+public:
+    explicit FixtureDeviceSource(std::vector<DeviceInfo> devices);
+
+    /**
+     * @brief Load a fixture file
+     * @throws std::runtime_error if the file cannot be read or parsed
+     */
+    static std::unique_ptr<FixtureDeviceSource> load(const std::string& path);
+
+    /**
+     * @brief Device from one JSON object with DeviceInfo field names
+     *
+     * Also used for the device records of replayed --watch traces.
+     */
+    static DeviceInfo deviceFromJson(const JsonValue& record);
+
+    std::vector<DeviceInfo> enumerate() override { return devices_; }
+    const char* name() const override { return "fixture"; }
+
+private:
+    std::vector<DeviceInfo> devices_;
+};
+
+} // namespace easytty
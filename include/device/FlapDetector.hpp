@@ -0,0 +1,97 @@
+#pragma once
+
+#include "common/Types.hpp"
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace easytty {
+
+/**
+ * @brief Detects devices that keep attaching and detaching
+ *
+ * A device flaps once it attached or detached THRESHOLD times within
+ * WINDOW; a marginal cable or a brown-out loop looks like this. It stays
+ * flapping until it has been quiet for a hold time. The hold time doubles
+ * every time the device starts flapping again (up to a cap), so a port
+ * that keeps relapsing is reported less and less often; it is reset once
+ * the device has been stable for that cap.
+ *
+ * Time comes from the events themselves, so the same detector works on
+ * live events and on the --history ring.
+ */
+class FlapDetector {
+public:
+    struct Options {
+        size_t threshold = 6;                       // Attach/detach transitions ...
+        uint64_t windowUsec = 60ULL * 1000000;      // ... within this window
+        uint64_t holdUsec = 30ULL * 1000000;        // Quiet time to clear, first time
+        uint64_t maxHoldUsec = 3600ULL * 1000000;   // Backoff cap
+    };
+
+    enum class Transition { None, Started, Stopped };
+
+    struct State {
+        std::vector<uint64_t> recent;   // Transition times within the window
+        uint64_t transitions = 0;       // Since the detector started
+        uint64_t suppressed = 0;        // Events while flapping
+        bool flapping = false;
+        uint64_t flappingSinceUsec = 0;
+        uint64_t holdUntilUsec = 0;
+        uint64_t stableSinceUsec = 0;
+        unsigned backoff = 0;           // Hold is holdUsec << backoff
+        DeviceInfo device;              // As last seen
+    };
+
+    FlapDetector() = default;
+    explicit FlapDetector(const Options& options) : options_(options) {}
+
+    /**
+     * @brief Count an event; change events do not count
+     * @return Started if it made the device flap, Stopped if its hold
+     *         time ran out before this event
+     */
+    Transition record(const DeviceEvent& event);
+
+    /**
+     * @brief Clear devices that have been quiet for their hold time
+     * @return The devices that stopped flapping
+     */
+    std::vector<DeviceInfo> expire(uint64_t nowUsec);
+
+    /**
+     * @brief Replay the --history ring up to nowUsec
+     *
+     * Lets one-shot commands show which devices are flapping right now.
+     */
+    OperationResult loadHistory(const std::string& path, uint64_t nowUsec);
+
+    /**
+     * @brief poll() timeout until the next device may clear, -1 if none flaps
+     */
+    int nextTimeoutMs(uint64_t nowUsec) const;
+
+    bool isFlapping(const DeviceInfo& device) const;
+
+    /**
+     * @brief State of a device, nullptr if it never attached or detached
+     */
+    const State* find(const DeviceInfo& device) const;
+
+    const Options& getOptions() const { return options_; }
+
+    /**
+     * @brief Identity that survives renumbering: vid:pid:serial, else
+     *        vid:pid@port, plus the USB interface; else the device node
+     */
+    static std::string deviceKey(const DeviceInfo& device);
+
+private:
+    Options options_;
+    std::map<std::string, State> states_;
+
+    uint64_t holdFor(const State& state) const;
+};
+
+} // namespace easytty
@@ -0,0 +1,156 @@
+#pragma once
+
+#include "common/Filter.hpp"
+#include "common/Types.hpp"
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <istream>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace easytty {
+
+/**
+ * @brief Runs site hooks for hotplug events on a bounded worker pool
+ *
+ * A hooks file holds one hook per line:
+ *
+ *   # <attach|detach|change|any> [timeout=<t>] [debounce=<t>] [<filter>] => <action>
+ *   attach symlink^=plc_            => exec /usr/bin/systemctl restart collector@{symlink}
+ *   detach timeout=2s vid==0403     => socket /run/plc-watch.sock
+ *
+ * The filter is a --where expression over the device and the rule
+ * naming it. "exec" runs the program directly, without a shell; {field}
+ * in its arguments is replaced by the device's field ({action} by the
+ * udev action), and the event is also in EASYTTY_* environment
+ * variables. "socket" writes the event as one JSON line to a Unix socket.
+ * Times take ms, s or m (timeout defaults to 10s, debounce to 500ms).
+ *
+ * submit() only queues. Worker threads run the hooks, so a slow hook
+ * delays neither the event loop nor the hooks of other devices. Events
+ * for the same hook and device are debounced: a run starts once the
+ * device has been quiet for the debounce time, with its latest event,
+ * and never while the previous run for that hook and device is still
+ * going. A hook that outlives its timeout is killed.
+ */
+class HookDispatcher {
+public:
+    enum class Trigger { Attach, Detach, Change, Any };
+    enum class ActionType { Exec, Socket };
+
+    struct Hook {
+        Trigger trigger = Trigger::Any;
+        Filter filter;
+        ActionType type = ActionType::Exec;
+        std::vector<std::string> argv;          // Exec: program and argument templates
+        std::string socketPath;                 // Socket
+        std::chrono::milliseconds timeout{10000};
+        std::chrono::milliseconds debounce{500};
+        int line = 0;
+    };
+
+    struct Options {
+        size_t workers = 4;
+        size_t maxPending = 256;    // Debounced runs waiting; events beyond are dropped
+    };
+
+    struct Result {
+        const Hook* hook = nullptr;
+        DeviceEvent event{};
+        std::string symlink;                    // Rule name at submit time, empty if none
+        bool success = false;
+        bool timedOut = false;
+        int exitStatus = 0;                     // Exec: exit code, or -signal
+        std::chrono::milliseconds duration{0};
+        std::string message;                    // Why it failed
+        size_t superseded = 0;                  // Earlier events debounced into this run
+    };
+
+    struct Stats {
+        uint64_t queued = 0;
+        uint64_t superseded = 0;
+        uint64_t dropped = 0;
+        uint64_t succeeded = 0;
+        uint64_t failed = 0;
+        uint64_t timedOut = 0;
+    };
+
+    /**
+     * @brief Read a hooks file
+     * @param error Set to "<path>: line N: <problem>" on failure
+     */
+    static std::optional<std::vector<Hook>> load(const std::string& path, std::string& error);
+
+    /**
+     * @brief Parse hooks text
+     * @param error Set to "line N: <problem>" on failure
+     */
+    static std::optional<std::vector<Hook>> parse(std::istream& in, std::string& error);
+
+    /**
+     * @param onResult Called after every run, from a worker thread, one
+     *                 call at a time
+     */
+    HookDispatcher(std::vector<Hook> hooks, const Options& options,
+                   std::function<void(const Result&)> onResult = nullptr);
+    ~HookDispatcher();
+
+    // Prevent copying
+    HookDispatcher(const HookDispatcher&) = delete;
+    HookDispatcher& operator=(const HookDispatcher&) = delete;
+
+    /**
+     * @brief Queue the hooks an event triggers
+     * @param rule Rule naming the device, null if none
+     * @return Number of hooks the event triggered
+     */
+    size_t submit(const DeviceEvent& event, const UdevRule* rule);
+
+    /**
+     * @brief Drop runs still waiting out their debounce, wait for running ones
+     */
+    void shutdown();
+
+    Stats getStats() const;
+
+    const std::vector<Hook>& getHooks() const { return hooks_; }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Job {
+        size_t hook;
+        DeviceEvent event;
+        std::string symlink;
+        Clock::time_point due;
+        size_t superseded = 0;
+    };
+
+    std::vector<Hook> hooks_;
+    Options options_;
+    std::function<void(const Result&)> onResult_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable wake_;
+    std::map<std::string, Job> pending_;    // hook/device key -> latest event
+    std::set<std::string> running_;
+    Stats stats_;
+    bool stopping_ = false;
+
+    std::mutex resultMutex_;
+    std::vector<std::thread> workers_;
+
+    void work();
+    Result run(const Job& job) const;
+    Result runExec(const Hook& hook, const Job& job) const;
+    Result runSocket(const Hook& hook, const Job& job) const;
+};
+
+} // namespace easytty
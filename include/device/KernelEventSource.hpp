@@ -0,0 +1,66 @@
+#pragma once
+
+#include "device/EventSource.hpp"
+#include <cstdint>
+#include <string_view>
+
+namespace easytty {
+
+class SysfsDeviceSource;
+
+/**
+ * @brief Event source reading kernel uevents from NETLINK_KOBJECT_UEVENT
+ *
+ * Works without udevd: events arrive as soon as the kernel emits them,
+ * before any rule has run. Attach events read the device's USB
+ * attributes from /sys; there is no USEC_INITIALIZED, so attach latency
+ * is not measured.
+ *
+ * The kernel broadcasts uevents only in the initial network namespace.
+ * In a container with its own network namespace the socket opens fine
+ * but never receives an event.
+ */
+class KernelEventSource : public EventSource {
+public:
+    /**
+     * @brief Fields of one uevent message
+     *
+     * The views point into the receive buffer; nothing is copied until
+     * the event is known to concern a serial device.
+     */
+    struct Uevent {
+        std::string_view action;        // add, remove, change, bind, ...
+        std::string_view devPath;       // /devices/... below /sys
+        std::string_view subsystem;
+        std::string_view devName;       // ttyUSB0 (relative to /dev)
+        uint64_t seqnum = 0;
+    };
+
+    KernelEventSource();
+    ~KernelEventSource() override;
+
+    // Prevent copying
+    KernelEventSource(const KernelEventSource&) = delete;
+    KernelEventSource& operator=(const KernelEventSource&) = delete;
+
+    bool start() override;
+    int getFd() const override { return fd_; }
+    std::optional<DeviceEvent> receive() override;
+    const char* name() const override { return "kernel"; }
+
+    /**
+     * @brief Parse a kernel uevent message ("action@devpath\0KEY=value\0...")
+     * @return Nothing for malformed messages and libudev-formatted ones
+     */
+    static std::optional<Uevent> parse(std::string_view message);
+
+    // Largest uevent the kernel sends (UEVENT_BUFFER_SIZE)
+    static constexpr size_t BUFFER_SIZE = 2048;
+
+private:
+    int fd_;
+    std::unique_ptr<SysfsDeviceSource> sysfs_;
+    char buffer_[BUFFER_SIZE];
+};
+
+} // namespace easytty
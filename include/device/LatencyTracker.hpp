@@ -0,0 +1,97 @@
+#pragma once
+
+#include "common/Types.hpp"
+#include "common/Histogram.hpp"
+#include <array>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace easytty {
+
+/**
+ * @brief Measures how long an attached device takes to become usable
+ *
+ * Every stage is measured from USEC_INITIALIZED, the moment udevd
+ * started handling the device (the event receive time if udevd did not
+ * report it):
+ *   udev     until the event reached us, i.e. rule processing and RUN
+ *            helpers finished
+ *   symlink  until /dev/<name> was created (taken from the link's ctime)
+ *   ready    until the node existed with permissions that let us read
+ *            and write it; the port is never opened, since that raises
+ *            DTR/RTS and resets Arduino-class boards
+ *
+ * Samples are kept in histograms per rule name and per driver, and can
+ * be saved to a state file so the TUI and reports can read them.
+ */
+class LatencyTracker {
+public:
+    enum class Stage { Udev, Symlink, Ready };
+    static constexpr size_t STAGE_COUNT = 3;
+
+    using StageHistograms = std::array<Histogram, STAGE_COUNT>;
+
+    static constexpr const char* STATE_FILE = "/var/lib/easytty/latency.state";
+
+    // Retry interval for ports that are not ready yet, and how long
+    // to keep trying before a device is given up on
+    static constexpr int RETRY_INTERVAL_MS = 10;
+    static constexpr uint64_t GIVE_UP_USEC = 30ULL * 1000000;
+
+    static const char* stageName(Stage stage);
+
+    /**
+     * @brief Start (add) or abandon (remove) a measurement
+     * @param rule Rule naming the device, nullptr if unmanaged
+     */
+    void onEvent(const DeviceEvent& event, const UdevRule* rule);
+
+    /**
+     * @brief Check pending devices for their symlink and node permissions
+     */
+    void update();
+
+    /**
+     * @brief poll() timeout until the next update is due, -1 if idle
+     */
+    int nextTimeoutMs() const;
+
+    /**
+     * @brief True once after new samples were recorded
+     */
+    bool takeChanged();
+
+    const std::map<std::string, StageHistograms>& getByRule() const { return byRule_; }
+    const std::map<std::string, StageHistograms>& getByDriver() const { return byDriver_; }
+
+    /**
+     * @brief Write all histograms to a state file (atomic replace)
+     */
+    OperationResult save(const std::string& path = STATE_FILE) const;
+
+    /**
+     * @brief Replace the histograms with those from a state file
+     * @return false if the file does not exist or cannot be read
+     */
+    bool load(const std::string& path = STATE_FILE);
+
+private:
+    struct Pending {
+        std::string devPath;
+        std::string symlink;    // Empty for unmanaged devices
+        std::string driver;
+        uint64_t baseUsec;      // CLOCK_MONOTONIC
+        uint64_t receivedUsec;
+        bool symlinkSeen;
+    };
+
+    std::vector<Pending> pending_;
+    std::map<std::string, StageHistograms> byRule_;
+    std::map<std::string, StageHistograms> byDriver_;
+    bool changed_ = false;
+
+    void recordStage(const Pending& pending, Stage stage, uint64_t atUsec);
+};
+
+} // namespace easytty
@@ -0,0 +1,93 @@
+#pragma once
+
+#include "device/EventSource.hpp"
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace easytty {
+
+/**
+ * @brief Event source replaying a recorded --watch trace
+ *
+ * A trace is the NDJSON output of `easyTTY --watch --format ndjson`: one
+ * record per event with its action, seqnum, timestamp and device. A
+ * producer thread re-emits the events with their original spacing
+ * divided by the speed factor (or back to back at MAX_SPEED) into a
+ * bounded queue. The queue stands in for the netlink socket buffer: when
+ * the consumer falls behind and it is full, events are dropped, just as
+ * the kernel drops them with ENOBUFS.
+ *
+ * Replayed events carry the time they were queued as timestampUsec, so
+ * consumers can measure how long each one waited and was processed.
+ */
+class ReplayEventSource : public EventSource {
+public:
+    static constexpr double MAX_SPEED = 0;
+    static constexpr size_t QUEUE_CAPACITY = 4096;
+
+    struct Stats {
+        uint64_t events = 0;        // In the trace
+        uint64_t queued = 0;        // Emitted so far
+        uint64_t delivered = 0;     // Taken by receive()
+        uint64_t dropped = 0;       // Queue was full
+        size_t maxQueueDepth = 0;
+    };
+
+    /**
+     * @param speed Replay speed factor (1 = recorded pace), MAX_SPEED for no delays
+     */
+    ReplayEventSource(std::vector<DeviceEvent> trace, double speed, size_t queueCapacity = QUEUE_CAPACITY);
+    ~ReplayEventSource() override;
+
+    // Prevent copying
+    ReplayEventSource(const ReplayEventSource&) = delete;
+    ReplayEventSource& operator=(const ReplayEventSource&) = delete;
+
+    /**
+     * @brief Load a trace file
+     * @throws std::runtime_error if the file cannot be read or parsed
+     */
+    static std::unique_ptr<ReplayEventSource> load(const std::string& path, double speed);
+
+    /**
+     * @brief Parse a speed: a factor such as 1, 10 or 10x, or "max"
+     * @return Nothing if invalid
+     */
+    static std::optional<double> parseSpeed(const std::string& text);
+
+    /**
+     * @brief Starts the producer thread
+     */
+    bool start() override;
+    int getFd() const override { return fd_; }
+    std::optional<DeviceEvent> receive() override;
+    const char* name() const override { return "replay"; }
+    bool isLive() const override { return false; }
+
+    /**
+     * @brief True once every event was emitted and the queue is drained
+     */
+    bool finished() const;
+
+    Stats getStats() const;
+
+private:
+    std::vector<DeviceEvent> trace_;
+    double speed_;
+    size_t queueCapacity_;
+    int fd_;        // eventfd in semaphore mode, counts queued events
+
+    mutable std::mutex mutex_;
+    std::deque<DeviceEvent> queue_;
+    Stats stats_;
+    std::atomic<bool> producerDone_;
+    std::atomic<bool> stopping_;
+    std::thread producer_;
+
+    void produce();
+};
+
+} // namespace easytty
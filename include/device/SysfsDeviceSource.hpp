@@ -0,0 +1,47 @@
+#pragma once
+
+#include "device/DeviceSource.hpp"
+#include <cstdio>
+
+namespace easytty {
+
+/**
+ * @brief Device source reading a sysfs tree directly
+ *
+ * Walks <root>/sys/class/tty and each device's parents up to its USB
+ * interface and device, reading the same attributes libudev would.
+ * With root "/" this is the live system; with an extracted snapshot it
+ * reproduces a customer's topology anywhere.
+ */
+class SysfsDeviceSource : public DeviceSource {
+public:
+    /**
+     * @param root Directory containing the sys/ tree
+     */
+    explicit SysfsDeviceSource(const std::string& root);
+
+    std::vector<DeviceInfo> enumerate() override;
+    std::optional<DeviceInfo> lookup(const std::string& devPath) override;
+    const char* name() const override { return "sysfs"; }
+    bool isLive() const override { return root_ == "/"; }
+
+    /**
+     * @brief Write the sysfs entries of all serial devices as a ustar archive
+     *
+     * Captures /sys/class/tty links and, for each serial device, its
+     * directory chain up to the USB device with the attributes and
+     * driver links the detector reads. Extract with `tar xf` and use
+     * EASYTTY_DEVICE_SOURCE=sysfs:<dir>.
+     *
+     * @param out Archive output
+     * @param root sysfs root to capture ("/" for the live system)
+     */
+    static OperationResult captureSnapshot(std::FILE* out, const std::string& root = "/");
+
+private:
+    std::string root_;
+
+    std::optional<DeviceInfo> readDevice(const std::string& name) const;
+};
+
+} // namespace easytty
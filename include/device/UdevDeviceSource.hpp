@@ -0,0 +1,42 @@
+#pragma once
+
+#include "device/DeviceSource.hpp"
+#include <libudev.h>
+
+namespace easytty {
+
+/**
+ * @brief Device source backed by the live libudev database
+ */
+class UdevDeviceSource : public DeviceSource {
+public:
+    UdevDeviceSource();
+    ~UdevDeviceSource() override;
+
+    // Prevent copying
+    UdevDeviceSource(const UdevDeviceSource&) = delete;
+    UdevDeviceSource& operator=(const UdevDeviceSource&) = delete;
+
+    std::vector<DeviceInfo> enumerate() override;
+    std::optional<DeviceInfo> lookup(const std::string& devPath) override;
+    const char* name() const override { return "udev"; }
+    bool isLive() const override { return true; }
+
+    /**
+     * @brief Extract device information from a udev device
+     *
+     * Shared with the hotplug monitor, which receives udev_device
+     * objects directly.
+     */
+    static DeviceInfo extractDeviceInfo(struct udev_device* dev);
+
+private:
+    struct udev* udev_;
+
+    /**
+     * @brief Get sysattr safely
+     */
+    static std::string getSysAttr(struct udev_device* dev, const char* attr);
+};
+
+} // namespace easytty
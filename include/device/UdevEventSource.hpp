@@ -0,0 +1,37 @@
+#pragma once
+
+#include "device/EventSource.hpp"
+#include <libudev.h>
+
+namespace easytty {
+
+/**
+ * @brief Event source listening to udevd on the "udev" netlink group
+ */
+class UdevEventSource : public EventSource {
+public:
+    UdevEventSource();
+    ~UdevEventSource() override;
+
+    // Prevent copying
+    UdevEventSource(const UdevEventSource&) = delete;
+    UdevEventSource& operator=(const UdevEventSource&) = delete;
+
+    bool start() override;
+    int getFd() const override;
+    std::optional<DeviceEvent> receive() override;
+    const char* name() const override { return "udev"; }
+
+private:
+    struct udev* udev_;
+    struct udev_monitor* monitor_;
+
+    void stop();
+
+    /**
+     * @brief Get udev property safely
+     */
+    static std::string getProperty(struct udev_device* dev, const char* key);
+};
+
+} // namespace easytty
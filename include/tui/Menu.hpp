@@ -105,6 +105,19 @@ public:
      * @brief Set help text
      */
     void setHelp(const std::string& help);
+    
+    /**
+     * @brief Stop the menu loop after the current action returns
+     */
+    void close() { running_ = false; }
+    
+    /**
+     * @brief Set handler for the '/' search key
+     * 
+     * The menu closes after the handler returns true so the caller can
+     * rebuild its items.
+     */
+    void setSearchHandler(std::function<bool()> handler);
 
 protected:
     std::string title_;
@@ -116,6 +129,7 @@ protected:
     bool statusIsError_;
     std::string helpText_;
     bool running_;
+    std::function<bool()> searchHandler_;
     
     /**
      * @brief Get visible height for menu items
@@ -3,6 +3,7 @@
 #include "common/Types.hpp"
 #include <ncurses.h>
 #include <string>
+#include <vector>
 #include <functional>
 #include <memory>
 
@@ -113,11 +114,24 @@ public:
      * @brief Show input dialog
      */
     std::string showInputDialog(const std::string& title, const std::string& prompt, const std::string& defaultValue = "");
+    
+    /**
+     * @brief Toggle the debug overlay (F12)
+     */
+    void toggleDebugOverlay() { debugOverlay_ = !debugOverlay_; }
+    
+    bool isDebugOverlayVisible() const { return debugOverlay_; }
+    
+    /**
+     * @brief Draw a boxed block of lines in the bottom right corner
+     */
+    void drawDebugOverlay(const std::vector<std::string>& lines);
 
 private:
     int width_;
     int height_;
     bool initialized_;
+    bool debugOverlay_;
     
     /**
      * @brief Initialize color pairs
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "common/Filter.hpp"
+#include "common/Types.hpp"
+#include <functional>
+#include <istream>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace easytty {
+
+/**
+ * @brief Maps devices to symlink names without asking anyone
+ *
+ * A policy file holds one entry per line, a --where filter and a name
+ * template separated by "=>"; the first entry that matches a device and
+ * expands to a name wins:
+ *
+ *   # Bench FTDI cables by serial, everything on hub 1-6 by port
+ *   vid==0403 && pid==6001      => {product}_{serial4}
+ *   port^="1-6."                => line3_port{port}
+ *
+ * Templates take any filter field in braces; a trailing number keeps
+ * that many characters from the end ({serial4}). Characters udev does
+ * not allow in a symlink become '_'. An entry whose template refers to
+ * a field the device does not have (an empty serial, say) does not
+ * apply, so a later entry can catch those devices.
+ */
+class NamingPolicy {
+public:
+    struct Entry {
+        Filter filter;
+        std::string nameTemplate;
+        int line = 0;
+    };
+
+    static constexpr const char* DEFAULT_PATH = "/etc/easytty/naming.policy";
+
+    /**
+     * @brief Read a policy file
+     * @param error Set to "<path>:<line>: <problem>" on failure
+     */
+    static std::optional<NamingPolicy> load(const std::string& path, std::string& error);
+
+    /**
+     * @brief Parse policy text
+     * @param error Set to "line N: <problem>" on failure
+     */
+    static std::optional<NamingPolicy> parse(std::istream& in, std::string& error);
+
+    /**
+     * @brief Name the policy gives a device
+     * @param matched Set to the entry that produced the name
+     * @return Nothing if no entry applies
+     */
+    std::optional<std::string> nameFor(const DeviceInfo& device, const Entry** matched = nullptr) const;
+
+    /**
+     * @brief Expand a name template for a device
+     * @return Nothing if a field it refers to is empty for the device
+     */
+    static std::optional<std::string> expand(const std::string& nameTemplate, const DeviceInfo& device);
+
+    /**
+     * @brief The name itself if it is free, else name_2, name_3, ...
+     *
+     * The same requests in the same order always get the same names.
+     */
+    static std::string uniqueName(const std::string& name,
+                                  const std::function<bool(const std::string&)>& taken);
+
+    const std::vector<Entry>& getEntries() const { return entries_; }
+
+private:
+    std::vector<Entry> entries_;
+};
+
+} // namespace easytty
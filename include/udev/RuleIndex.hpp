@@ -0,0 +1,75 @@
+#pragma once
+
+#include "common/Types.hpp"
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+namespace easytty {
+
+/**
+ * @brief Hash index over udev rules
+ *
+ * Answers "which rule owns this symlink" and "which rule matches this
+ * device" in O(1). The device lookup follows UdevRule::matchesDevice:
+ * a serial rule wins over a USB port rule, which wins over a
+ * vendor:product-only rule, and at each level a rule for the device's
+ * USB interface wins over one for the whole device.
+ */
+class RuleIndex {
+public:
+    RuleIndex() = default;
+
+    /**
+     * @brief Rebuild the index from a list of rules
+     */
+    void build(const std::vector<UdevRule>& rules);
+
+    /**
+     * @brief Add a rule (first rule wins on duplicate symlinks)
+     */
+    void add(const UdevRule& rule);
+
+    /**
+     * @brief Remove the rule owning a symlink
+     * @return True if a rule was removed
+     */
+    bool remove(const std::string& symlink);
+
+    /**
+     * @brief Find rule by symlink name
+     */
+    const UdevRule* findBySymlink(const std::string& symlink) const;
+
+    /**
+     * @brief Find the rule UdevManager::deleteRule() would delete
+     *
+     * The rule with the lowest symlink among those whose symlink or
+     * name is this, by a scan of all rules.
+     */
+    const UdevRule* findBySymlinkOrName(const std::string& symlinkOrName) const;
+
+    /**
+     * @brief Find the rule matching a device
+     */
+    const UdevRule* findForDevice(const DeviceInfo& device) const;
+
+    /**
+     * @brief Whether any rule lives in this rule file
+     */
+    bool holdsFile(const std::string& filePath) const { return byFile_.count(filePath) > 0; }
+
+    size_t size() const { return bySymlink_.size(); }
+
+private:
+    std::unordered_map<std::string, UdevRule> bySymlink_;
+    std::unordered_multimap<std::string, std::string> byMatchKey_;   // match key -> symlink
+    std::unordered_map<std::string, size_t> byFile_;                 // rule file -> rules in it
+
+    /**
+     * @brief Key describing what a rule matches on
+     */
+    static std::string matchKey(const UdevRule& rule);
+};
+
+} // namespace easytty
@@ -1,9 +1,13 @@
 #pragma once
 
 #include "common/Types.hpp"
+#include "udev/RuleIndex.hpp"
 #include <vector>
 #include <string>
 #include <map>
+#include <memory>
+#include <atomic>
+#include <chrono>
 
 namespace easytty {
 
@@ -12,27 +16,102 @@ namespace easytty {
  * 
  * Handles creation, deletion, and management of udev rules
  * in /etc/udev/rules.d/
+ * 
+ * Rule changes come from one thread. Loaded rules are never changed in
+ * place: each load or change publishes a new immutable RuleSet, so other
+ * threads can read getSnapshot() without locking.
  */
 class UdevManager {
 public:
-    UdevManager();
+    /**
+     * @brief Loaded rules with their index, as one load or change left them
+     */
+    struct RuleSet {
+        std::vector<UdevRule> rules;                // Sorted by symlink
+        std::vector<std::string> invalidRuleFiles;
+        RuleIndex index;
+    };
+    using RuleSnapshot = std::shared_ptr<const RuleSet>;
+    
+    /**
+     * @param rulesDir Directory holding the rule files (another directory
+     *                 is only useful for benchmarks and fixtures)
+     */
+    explicit UdevManager(const std::string& rulesDir = RULES_DIR);
     ~UdevManager() = default;
     
     // Rule priority (lower = earlier processing)
     static constexpr int DEFAULT_PRIORITY = 99;
     static constexpr const char* RULES_DIR = "/etc/udev/rules.d";
     static constexpr const char* RULE_PREFIX = "99-easytty-";
+    static constexpr const char* ARCHIVE_DIR = "/var/lib/easytty/archived-rules";
+    
+    /**
+     * @brief Directory this manager reads and writes rules in
+     */
+    const std::string& getRulesDir() const { return rulesDir_; }
     
     /**
      * @brief Create a new udev rule for a device
      * @param device Device to create rule for
      * @param symlinkName Name for the symlink (without /dev/)
+     * @param matchInterface Also match the USB interface number, so the
+     *                       rule names one port of a multi-port adapter
+     * @return Operation result
+     */
+    OperationResult createRule(const DeviceInfo& device, const std::string& symlinkName,
+                               bool matchInterface = false);
+    
+    /**
+     * @brief Name every interface of a multi-port adapter at once
+     * 
+     * Writes one rule file holding one interface rule per tty, so udev
+     * is reloaded once for the whole device. Nothing is written unless
+     * every rule is valid.
+     * 
+     * @param interfaces ttys of one physical USB device
+     * @param symlinkNames One name per interface, in the same order
      * @return Operation result
      */
-    OperationResult createRule(const DeviceInfo& device, const std::string& symlinkName);
+    OperationResult createInterfaceRules(const std::vector<DeviceInfo>& interfaces,
+                                         const std::vector<std::string>& symlinkNames);
+    
+    /**
+     * @brief Default names for the interfaces of one device: base_A, base_B, ...
+     */
+    static std::vector<std::string> interfaceNames(const std::string& baseName, size_t count);
+    
+    /**
+     * @brief Check whether a rule could be created, without writing anything
+     * @param device Device to create rule for
+     * @param symlinkName Name for the symlink (without /dev/)
+     * @param matchInterface As for createRule()
+     * @return Operation result describing the first problem found
+     */
+    OperationResult validateRule(const DeviceInfo& device, const std::string& symlinkName,
+                                 bool matchInterface = false) const;
+    
+    /**
+     * @brief validateRule() against other rules than the loaded ones
+     * 
+     * For planning several rules before writing any: pending is a copy
+     * of getRuleIndex() with the planned rules added.
+     */
+    OperationResult validateRule(const DeviceInfo& device, const std::string& symlinkName,
+                                 bool matchInterface, const RuleIndex& pending) const;
+    
+    /**
+     * @brief Build the rule that createRule() would write for a device
+     */
+    UdevRule makeRule(const DeviceInfo& device, const std::string& symlinkName,
+                      bool matchInterface = false) const;
     
     /**
      * @brief Delete an existing udev rule
+     * 
+     * A rule sharing its file with other interface rules is cut out of
+     * the file; the file goes once its last rule does.
+     * 
      * @param ruleName Name of the rule to delete
      * @return Operation result
      */
@@ -45,6 +124,18 @@ public:
      */
     OperationResult deleteRuleFile(const std::string& filePath);
     
+    /**
+     * @brief Delete or archive several rule files, then reload udev once
+     * 
+     * Stops at the first file that cannot be removed; the files removed
+     * before it stay removed and udev is still reloaded.
+     * 
+     * @param archiveDir Move the files here instead of deleting them; empty deletes
+     * @return Operation result; the message counts the removed files
+     */
+    OperationResult removeRuleFiles(const std::vector<std::string>& filePaths,
+                                    const std::string& archiveDir = "");
+    
     /**
      * @brief Check if a rule already exists for a device
      * @param device Device to check
@@ -84,6 +175,17 @@ public:
      */
     OperationResult triggerRules();
     
+    /**
+     * @brief Trigger udev to re-apply rules to some devices only
+     * 
+     * Much cheaper than triggerRules() when a few new rules were written
+     * for devices that are already attached.
+     * 
+     * @param sysPaths /sys paths of the devices
+     * @return Operation result
+     */
+    OperationResult triggerDevices(const std::vector<std::string>& sysPaths);
+    
     /**
      * @brief Reload and trigger rules
      * @return Operation result
@@ -97,8 +199,33 @@ public:
     
     /**
      * @brief Get existing rules (cached)
+     * 
+     * Like getRuleIndex() and getInvalidRuleFiles(), for the thread that
+     * changes rules. The reference dies at the next change (create,
+     * delete, refresh): code that may change rules while it holds the
+     * list, and other threads, keep getSnapshot() instead.
+     */
+    const std::vector<UdevRule>& getExistingRules() const { return rules_->rules; }
+    
+    /**
+     * @brief Wall time spent in the last full rule load
+     */
+    std::chrono::microseconds getLastLoadDuration() const { return lastLoadDuration_; }
+    
+    /**
+     * @brief easyTTY rule files that could not be parsed on the last load
+     */
+    const std::vector<std::string>& getInvalidRuleFiles() const { return rules_->invalidRuleFiles; }
+    
+    /**
+     * @brief Get the symlink/device index over existing rules
+     */
+    const RuleIndex& getRuleIndex() const { return rules_->index; }
+    
+    /**
+     * @brief Current rules, safe to keep and read from any thread
      */
-    const std::vector<UdevRule>& getExistingRules() const { return rules_; }
+    RuleSnapshot getSnapshot() const { return std::atomic_load(&rules_); }
     
     /**
      * @brief Verify symlink was created
@@ -108,12 +235,17 @@ public:
     bool verifySymlink(const std::string& symlinkName) const;
 
 private:
-    std::vector<UdevRule> rules_;
+    std::string rulesDir_;
+    RuleSnapshot rules_;
+    std::chrono::microseconds lastLoadDuration_;
     
     /**
      * @brief Generate rule file content
+     * @param devices The device each rule was made for (the first one
+     *                describes the file)
      */
-    std::string generateRuleContent(const DeviceInfo& device, const std::string& symlinkName) const;
+    std::string generateRuleContent(const std::vector<DeviceInfo>& devices,
+                                    const std::vector<UdevRule>& rules) const;
     
     /**
      * @brief Generate rule file name
@@ -122,19 +254,40 @@ private:
     
     /**
      * @brief Parse existing rule file
+     * @return One rule per SYMLINK line, empty if the file holds none
      */
-    std::optional<UdevRule> parseRuleFile(const std::string& filePath) const;
+    std::vector<UdevRule> parseRuleFile(const std::string& filePath) const;
     
     /**
      * @brief Load all existing easyTTY rules
      */
     void loadExistingRules();
     
+    /**
+     * @brief Insert the rules of a freshly written file without rescanning the rules directory
+     */
+    void addLoadedRules(const std::vector<UdevRule>& rules);
+    
+    /**
+     * @brief Drop the rules of a removed rule file without rescanning the rules directory
+     */
+    void removeLoadedRule(const std::string& filePath);
+    
+    /**
+     * @brief Make a new rule set the current one
+     */
+    void publish(RuleSet rules);
+    
     /**
      * @brief Check if we have write access to rules directory
      */
     bool hasWriteAccess() const;
     
+    /**
+     * @brief Whether rule files can be written and removed without sudo
+     */
+    bool canWriteDirectly() const;
+    
     /**
      * @brief Write rule to file (may need sudo)
      */
@@ -144,6 +297,11 @@ private:
      * @brief Remove rule file (may need sudo)
      */
     OperationResult removeRuleFile(const std::string& filePath);
+    
+    /**
+     * @brief Copy a rule file into the archive directory (may need sudo)
+     */
+    OperationResult archiveRuleFile(const std::string& filePath, const std::string& archiveDir);
 };
 
 } // namespace easytty
@@ -1,7 +1,14 @@
 #include "app/Application.hpp"
 #include "common/Utils.hpp"
+#include "common/AllocStats.hpp"
+#include "device/DeviceInventory.hpp"
+#include "device/EventLog.hpp"
+#include "device/FlapDetector.hpp"
+#include "device/LatencyTracker.hpp"
 #include <sstream>
 #include <iomanip>
+#include <algorithm>
+#include <chrono>
 
 namespace easytty {
 
@@ -34,6 +41,8 @@ int Application::run() {
 
 void Application::showMainMenu() {
     while (running_) {
+        alloc::PhaseScope rebuild(alloc::Phase::MenuRebuild);
+        
         // Refresh data before showing menu
         refreshAll();
         
@@ -75,6 +84,20 @@ void Application::showMainMenu() {
             }
         ));
         
+        items.push_back(tui::MenuItem(
+            "Attach Latency",
+            "Hotplug-to-usable latency recorded by easyTTY --watch --latency",
+            MenuItemType::Submenu,
+            [this]() { showLatency(); }
+        ));
+        
+        items.push_back(tui::MenuItem(
+            "Stale Rules",
+            "Rules whose devices have not been seen for a long time",
+            MenuItemType::Submenu,
+            [this]() { showStaleRules(); }
+        ));
+        
         items.push_back(tui::MenuItem::Separator());
         
         items.push_back(tui::MenuItem(
@@ -105,6 +128,7 @@ void Application::showMainMenu() {
             menu.setStatus("Note: Running without root - some operations may require sudo password", false);
         }
         
+        rebuild.end();
         int result = menu.run();
         // Any exit from main menu (ESC, Q, or Exit selection) should quit
         running_ = false;
@@ -113,19 +137,43 @@ void Application::showMainMenu() {
 
 void Application::showDeviceList() {
     while (true) {
+        alloc::PhaseScope rebuild(alloc::Phase::MenuRebuild);
+        
         // Refresh devices and rules before showing menu
-        deviceDetector_->scanDevices();
-        udevManager_->refresh();
+        refreshAll();
+        
+        // Flapping state from the events a running --watch recorded
+        FlapDetector flaps;
+        flaps.loadHistory(EventLog::DEFAULT_PATH, std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count());
         
-        tui::Menu menu("Connected USB Serial Devices", "Select a device to create a persistent name");
+        tui::Menu menu("Connected USB Serial Devices",
+                       deviceFilter_.empty() ? "Select a device to create a persistent name"
+                                             : "Filter: " + deviceFilter_.getExpression());
         
         std::vector<tui::MenuItem> items;
         
-        const auto& devices = deviceDetector_->getDevices();
+        // Held across menu.run(): actions in the menu rescan and publish
+        // a new list, which frees the one getDevices() refers to
+        DeviceDetector::DeviceList snapshot = deviceDetector_->getSnapshot();
+        const auto& devices = *snapshot;
+        bool filterChanged = false;
+        auto changeFilter = [this, &menu, &filterChanged]() {
+            filterChanged = editFilter(deviceFilter_, "Filter Devices");
+            if (filterChanged) {
+                menu.close();
+            }
+            return filterChanged;
+        };
+        
+        size_t shown = std::count_if(devices.begin(), devices.end(),
+                                     [this](const DeviceInfo& device) {
+                                         return deviceFilter_.matches(device);
+                                     });
         
-        if (devices.empty()) {
+        if (shown == 0) {
             items.push_back(tui::MenuItem(
-                "No USB serial devices found",
+                devices.empty() ? "No USB serial devices found" : "No devices match the filter",
                 "",
                 MenuItemType::Action,
                 nullptr,
@@ -133,6 +181,10 @@ void Application::showDeviceList() {
             ));
         } else {
             for (const auto& device : devices) {
+                if (!deviceFilter_.matches(device)) {
+                    continue;
+                }
+                
                 // Check rule match type: 0=none, 1=shared (no serial), 2=unique
                 int matchType = udevManager_->getRuleMatchType(device);
                 std::string label = formatDeviceForList(device);
@@ -141,6 +193,9 @@ void Application::showDeviceList() {
                 } else if (matchType == 1) {
                     label += " [SHARED RULE]";
                 }
+                if (flaps.isFlapping(device)) {
+                    label += " [FLAPPING]";
+                }
                 
                 items.push_back(tui::MenuItem(
                     label,
@@ -153,6 +208,13 @@ void Application::showDeviceList() {
         
         items.push_back(tui::MenuItem::Separator());
         
+        items.push_back(tui::MenuItem(
+            "Filter Devices...",
+            "e.g. vid==0403 && serial~\"A5*\"",
+            MenuItemType::Action,
+            [changeFilter]() { changeFilter(); }
+        ));
+        
         // Use Back type for Refresh so it exits menu loop and rebuilds
         items.push_back(tui::MenuItem(
             "Refresh",
@@ -167,10 +229,16 @@ void Application::showDeviceList() {
         ));
         
         menu.setItems(items);
-        menu.setHelp("↑/↓: Navigate  Enter: Select device  ESC: Back");
+        menu.setHelp("↑/↓: Navigate  Enter: Select device  /: Filter  ESC: Back");
+        menu.setSearchHandler(changeFilter);
         
+        rebuild.end();
         int result = menu.run();
         
+        if (filterChanged) {
+            continue;
+        }
+        
         // Check which item was selected
         if (result == -1) {
             // ESC or Q pressed
@@ -188,18 +256,37 @@ void Application::showDeviceList() {
 
 void Application::showExistingRules() {
     while (true) {
+        alloc::PhaseScope rebuild(alloc::Phase::MenuRebuild);
+        
         // Refresh rules before showing menu
         udevManager_->refresh();
         
-        tui::Menu menu("Existing udev Rules", "Manage EasyTTY created udev rules");
+        tui::Menu menu("Existing udev Rules",
+                       ruleFilter_.empty() ? "Manage EasyTTY created udev rules"
+                                           : "Filter: " + ruleFilter_.getExpression());
         
         std::vector<tui::MenuItem> items;
         
-        const auto& rules = udevManager_->getExistingRules();
+        // Held across menu.run(): deleting a rule publishes a new rule set
+        UdevManager::RuleSnapshot snapshot = udevManager_->getSnapshot();
+        const auto& rules = snapshot->rules;
+        bool filterChanged = false;
+        auto changeFilter = [this, &menu, &filterChanged]() {
+            filterChanged = editFilter(ruleFilter_, "Filter Rules");
+            if (filterChanged) {
+                menu.close();
+            }
+            return filterChanged;
+        };
+        
+        size_t shown = std::count_if(rules.begin(), rules.end(),
+                                     [this](const UdevRule& rule) {
+                                         return ruleFilter_.matches(rule);
+                                     });
         
-        if (rules.empty()) {
+        if (shown == 0) {
             items.push_back(tui::MenuItem(
-                "No EasyTTY rules found",
+                rules.empty() ? "No EasyTTY rules found" : "No rules match the filter",
                 "",
                 MenuItemType::Action,
                 nullptr,
@@ -207,6 +294,10 @@ void Application::showExistingRules() {
             ));
         } else {
             for (const auto& rule : rules) {
+                if (!ruleFilter_.matches(rule)) {
+                    continue;
+                }
+                
                 std::string label = formatRuleForList(rule);
                 bool symlinkExists = udevManager_->verifySymlink(rule.symlink);
                 
@@ -227,6 +318,13 @@ void Application::showExistingRules() {
         
         items.push_back(tui::MenuItem::Separator());
         
+        items.push_back(tui::MenuItem(
+            "Filter Rules...",
+            "e.g. symlink^=plc_ || serial~\"A5*\"",
+            MenuItemType::Action,
+            [changeFilter]() { changeFilter(); }
+        ));
+        
         // Use Back type for Refresh so it exits menu loop and rebuilds
         items.push_back(tui::MenuItem(
             "Refresh",
@@ -241,10 +339,16 @@ void Application::showExistingRules() {
         ));
         
         menu.setItems(items);
-        menu.setHelp("↑/↓: Navigate  Enter: Select rule  ESC: Back");
+        menu.setHelp("↑/↓: Navigate  Enter: Select rule  /: Filter  ESC: Back");
+        menu.setSearchHandler(changeFilter);
         
+        rebuild.end();
         int result = menu.run();
         
+        if (filterChanged) {
+            continue;
+        }
+        
         // Check which item was selected
         if (result == -1) {
             // ESC or Q pressed
@@ -300,6 +404,11 @@ void Application::showDeviceDetails(const DeviceInfo& device) {
             items.push_back(tui::MenuItem("USB Port:     " + device.kernelPath + (device.serial.empty() ? " (used for identification)" : ""), "", MenuItemType::Action, nullptr, false));
         }
         
+        auto interfaces = interfacesOf(device);
+        if (interfaces.size() > 1) {
+            items.push_back(tui::MenuItem("Interface:    " + device.interfaceNum + " (one of " + std::to_string(interfaces.size()) + " on this USB device)", "", MenuItemType::Action, nullptr, false));
+        }
+        
         items.push_back(tui::MenuItem::Separator());
         
         // Refresh and check rule match type
@@ -339,6 +448,16 @@ void Application::showDeviceDetails(const DeviceInfo& device) {
                     createRuleForDevice(device); 
                 }
             ));
+            if (interfaces.size() > 1) {
+                items.push_back(tui::MenuItem(
+                    "Name All " + std::to_string(interfaces.size()) + " Interfaces",
+                    "One rule file for every port of this adapter",
+                    MenuItemType::Action,
+                    [this, interfaces]() {
+                        createInterfaceRules(interfaces);
+                    }
+                ));
+            }
         }
         
         items.push_back(tui::MenuItem::Separator());
@@ -395,8 +514,8 @@ void Application::createRuleForDevice(const DeviceInfo& device) {
         return;
     }
     
-    // Create the rule
-    auto result = udevManager_->createRule(device, symlinkName);
+    // Create the rule; one port of a multi-port adapter is named by its interface
+    auto result = udevManager_->createRule(device, symlinkName, interfacesOf(device).size() > 1);
     
     if (result.success) {
         // Apply rules
@@ -414,6 +533,71 @@ void Application::createRuleForDevice(const DeviceInfo& device) {
     }
 }
 
+void Application::createInterfaceRules(const std::vector<DeviceInfo>& interfaces) {
+    const DeviceInfo& device = interfaces.front();
+    std::string defaultName = !device.product.empty() ? utils::sanitizeForUdev(device.product) : "port";
+    
+    std::string baseName = tui::gScreen->showInputDialog(
+        "Name All Interfaces",
+        "Enter base name (interfaces become /dev/<name>_A, _B, ...):",
+        defaultName
+    );
+    baseName = utils::trim(baseName);
+    
+    if (baseName.empty()) {
+        tui::gScreen->showMessageDialog("Cancelled", "No name entered, rules not created.", false);
+        return;
+    }
+    
+    if (!utils::isValidSymlinkName(baseName)) {
+        tui::gScreen->showMessageDialog(
+            "Invalid Name",
+            "Name must start with letter, contain only letters, numbers, _ or -",
+            true
+        );
+        return;
+    }
+    
+    auto names = UdevManager::interfaceNames(baseName, interfaces.size());
+    std::stringstream confirmMsg;
+    confirmMsg << "Create one rule file for:";
+    for (size_t i = 0; i < interfaces.size(); i++) {
+        confirmMsg << "\n/dev/" << names[i] << " -> " << interfaces[i].devNode
+                   << " (interface " << interfaces[i].interfaceNum << ")";
+    }
+    
+    if (!tui::gScreen->showConfirmDialog("Confirm Rule Creation", confirmMsg.str())) {
+        return;
+    }
+    
+    auto result = udevManager_->createInterfaceRules(interfaces, names);
+    
+    if (result.success) {
+        // One reload for the whole device
+        auto applyResult = udevManager_->applyRules();
+        
+        std::stringstream successMsg;
+        successMsg << "Rules created: /dev/" << names.front() << " .. /dev/" << names.back();
+        if (applyResult.success) {
+            successMsg << "\nRules applied successfully!";
+        }
+        
+        tui::gScreen->showMessageDialog("Success", successMsg.str(), false);
+    } else {
+        tui::gScreen->showMessageDialog("Error", result.message, true);
+    }
+}
+
+std::vector<DeviceInfo> Application::interfacesOf(const DeviceInfo& device) const {
+    std::string key = DeviceDetector::physicalDeviceKey(device);
+    for (auto& group : DeviceDetector::groupInterfaces(deviceDetector_->getDevices())) {
+        if (DeviceDetector::physicalDeviceKey(group.front()) == key) {
+            return group;
+        }
+    }
+    return {device};
+}
+
 void Application::deleteRuleMenu(const UdevRule& rule) {
     std::stringstream subtitle;
     subtitle << "/dev/" << rule.symlink << " -> " << rule.vendorId << ":" << rule.productId;
@@ -428,6 +612,9 @@ void Application::deleteRuleMenu(const UdevRule& rule) {
     if (!rule.serial.empty()) {
         items.push_back(tui::MenuItem("Serial: " + rule.serial, "", MenuItemType::Action, nullptr, false));
     }
+    if (!rule.interfaceNum.empty()) {
+        items.push_back(tui::MenuItem("Interface: " + rule.interfaceNum, "", MenuItemType::Action, nullptr, false));
+    }
     items.push_back(tui::MenuItem("File: " + rule.filePath, "", MenuItemType::Action, nullptr, false));
     
     items.push_back(tui::MenuItem::Separator());
@@ -439,7 +626,8 @@ void Application::deleteRuleMenu(const UdevRule& rule) {
         [this, rule]() {
             std::string msg = "Delete rule for /dev/" + rule.symlink + "?";
             if (tui::gScreen->showConfirmDialog("Confirm Deletion", msg)) {
-                auto result = udevManager_->deleteRuleFile(rule.filePath);
+                // Interface rules may share their file with other ports of the adapter
+                auto result = udevManager_->deleteRule(rule.symlink);
                 if (result.success) {
                     udevManager_->applyRules();
                     tui::gScreen->showMessageDialog("Success", "Rule deleted and udev reloaded", false);
@@ -515,11 +703,196 @@ void Application::showAbout() {
     aboutMenu.run();
 }
 
+void Application::showLatency() {
+    tui::Menu latencyMenu("Attach Latency", "ms from udev initializing a device (p50 / p90 / p99 / max)");
+    
+    std::vector<tui::MenuItem> items;
+    
+    LatencyTracker tracker;
+    if (!tracker.load()) {
+        items.push_back(tui::MenuItem("No latency data recorded yet.", "", MenuItemType::Action, nullptr, false));
+        items.push_back(tui::MenuItem("Run 'easyTTY --watch --latency' as root and attach devices.", "", MenuItemType::Action, nullptr, false));
+    } else {
+        auto addGroup = [&items](const std::string& title,
+                                 const std::map<std::string, LatencyTracker::StageHistograms>& groups) {
+            items.push_back(tui::MenuItem("=== " + title + " ===", "", MenuItemType::Action, nullptr, false));
+            for (const auto& entry : groups) {
+                for (size_t i = 0; i < LatencyTracker::STAGE_COUNT; i++) {
+                    const Histogram& h = entry.second[i];
+                    if (!h.count()) continue;
+                    
+                    std::ostringstream row;
+                    row << std::left << std::setw(16) << entry.first << " "
+                        << std::setw(8) << LatencyTracker::stageName(static_cast<LatencyTracker::Stage>(i))
+                        << std::right << std::fixed << std::setprecision(1)
+                        << std::setw(8) << h.percentile(0.5) / 1000.0
+                        << std::setw(8) << h.percentile(0.9) / 1000.0
+                        << std::setw(8) << h.percentile(0.99) / 1000.0
+                        << std::setw(8) << h.max() / 1000.0
+                        << "  n=" << h.count();
+                    items.push_back(tui::MenuItem(row.str(), "", MenuItemType::Action, nullptr, false));
+                }
+            }
+            items.push_back(tui::MenuItem::Separator());
+        };
+        addGroup("BY RULE", tracker.getByRule());
+        addGroup("BY DRIVER", tracker.getByDriver());
+    }
+    
+    items.push_back(tui::MenuItem::Back());
+    
+    latencyMenu.setItems(items);
+    latencyMenu.run();
+}
+
+void Application::showStaleRules() {
+    std::string window = "90d";
+    
+    while (true) {
+        refreshAll();
+        
+        // Whatever is plugged in right now is not stale. Only this view
+        // records, like --gc; without root the inventory does not advance
+        if (deviceDetector_->getSource().isLive()) {
+            DeviceInventory::recordScan(deviceDetector_->getDevices());
+        }
+        
+        uint64_t windowSec = 0;
+        utils::parseDuration(window, windowSec);
+        uint64_t now = std::chrono::duration_cast<std::chrono::seconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+        
+        DeviceInventory inventory;
+        inventory.load();
+        auto stale = inventory.findStaleRules(udevManager_->getExistingRules(),
+                                              windowSec < now ? now - windowSec : 0);
+        
+        tui::Menu menu("Stale Rules", "Rules whose devices have not been seen for " + window);
+        std::vector<tui::MenuItem> items;
+        bool changed = false;
+        
+        if (inventory.getTrackingSince() == 0) {
+            items.push_back(tui::MenuItem("No devices recorded yet.", "", MenuItemType::Action, nullptr, false));
+            items.push_back(tui::MenuItem("Devices are recorded as root by this view, --gc, --list --record and --watch.", "", MenuItemType::Action, nullptr, false));
+        } else if (stale.empty()) {
+            items.push_back(tui::MenuItem("No stale rules (devices recorded since " +
+                                          utils::formatLocalDate(inventory.getTrackingSince()) + ")",
+                                          "", MenuItemType::Action, nullptr, false));
+        } else {
+            for (const auto& entry : stale) {
+                std::ostringstream row;
+                row << std::left << std::setw(20) << ("/dev/" + entry.rule.symlink) << " "
+                    << (entry.lastSeen ? "last seen " : "never seen, since ")
+                    << utils::formatLocalDate(entry.missingSince)
+                    << " (" << (now - entry.missingSince) / 86400 << " days)";
+                UdevRule rule = entry.rule;
+                items.push_back(tui::MenuItem(
+                    row.str(),
+                    rule.filePath,
+                    MenuItemType::Submenu,
+                    [this, rule, &changed, &menu]() {
+                        deleteRuleMenu(rule);
+                        changed = true;
+                        menu.close();
+                    }
+                ));
+            }
+        }
+        
+        items.push_back(tui::MenuItem::Separator());
+        
+        items.push_back(tui::MenuItem(
+            "Window: " + window + "...",
+            "How long a device must be unseen, e.g. 30d or 12w",
+            MenuItemType::Action,
+            [&window, &changed, &menu]() {
+                std::string text = utils::trim(tui::gScreen->showInputDialog(
+                    "Stale Rules", "Devices not seen for (e.g. 30d or 12w)", window));
+                uint64_t seconds = 0;
+                if (text.empty() || text == window) {
+                    return;
+                }
+                if (!utils::parseDuration(text, seconds)) {
+                    tui::gScreen->showMessageDialog("Invalid Window", "Expected a duration such as 90d or 12w", true);
+                    return;
+                }
+                window = text;
+                changed = true;
+                menu.close();
+            }
+        ));
+        
+        if (!stale.empty()) {
+            std::vector<std::string> files;
+            for (const auto& entry : stale) {
+                files.push_back(entry.rule.filePath);
+            }
+            auto removeAll = [this, files, &changed, &menu](const std::string& archiveDir) {
+                std::string what = archiveDir.empty() ? "Delete" : "Archive";
+                std::string msg = what + " " + std::to_string(files.size()) + " stale rule(s) and reload udev once?";
+                if (!tui::gScreen->showConfirmDialog("Confirm " + what, msg)) {
+                    return;
+                }
+                auto result = udevManager_->removeRuleFiles(files, archiveDir);
+                tui::gScreen->showMessageDialog(result.success ? "Success" : "Error", result.message, !result.success);
+                changed = true;
+                menu.close();
+            };
+            
+            items.push_back(tui::MenuItem(
+                "Archive " + std::to_string(stale.size()) + " Stale Rule(s)",
+                std::string("Move the rule files to ") + UdevManager::ARCHIVE_DIR,
+                MenuItemType::Action,
+                [removeAll]() { removeAll(UdevManager::ARCHIVE_DIR); }
+            ));
+            items.push_back(tui::MenuItem(
+                "Delete " + std::to_string(stale.size()) + " Stale Rule(s)",
+                "Remove the rule files",
+                MenuItemType::Action,
+                [removeAll]() { removeAll(""); }
+            ));
+        }
+        
+        items.push_back(tui::MenuItem::Separator());
+        items.push_back(tui::MenuItem::Back());
+        
+        menu.setItems(items);
+        menu.run();
+        
+        if (!changed) {
+            return;
+        }
+    }
+}
+
 void Application::refreshAll() {
     deviceDetector_->scanDevices();
     udevManager_->refresh();
 }
 
+bool Application::editFilter(Filter& filter, const std::string& title) {
+    std::string expr = tui::gScreen->showInputDialog(
+        title,
+        "Filter expression (empty clears), e.g. vid==0403 && port^=1-6.",
+        filter.getExpression()
+    );
+    expr = utils::trim(expr);
+    
+    if (expr == filter.getExpression()) {
+        return false;
+    }
+    
+    std::string error;
+    auto compiled = Filter::compile(expr, error);
+    if (!compiled) {
+        tui::gScreen->showMessageDialog("Invalid Filter", error, true);
+        return false;
+    }
+    
+    filter = *compiled;
+    return true;
+}
+
 std::string Application::formatDeviceForList(const DeviceInfo& device) const {
     std::stringstream ss;
     ss << device.devNode;
@@ -0,0 +1,272 @@
+#include "capi/easytty.h"
+#include "device/DeviceDetector.hpp"
+#include "device/DeviceIndex.hpp"
+#include "udev/UdevManager.hpp"
+#include <memory>
+#include <poll.h>
+
+using easytty::DeviceInfo;
+using easytty::UdevRule;
+
+struct easytty_device {
+    DeviceInfo info;
+};
+
+struct easytty_rule {
+    UdevRule rule;
+};
+
+struct easytty_context {
+    easytty::DeviceDetector detector;
+    easytty::UdevManager manager;
+    std::string lastError;
+
+    // Snapshots handed out to callers; the detector and manager keep
+    // rescanning underneath without invalidating them
+    std::vector<easytty_device> devices;
+    std::vector<easytty_rule> rules;
+    bool scanned = false;
+    bool rulesLoaded = false;
+
+    easytty::DeviceIndex index;
+    bool indexStale = true;
+    easytty_device resolvedDevice;
+    easytty_rule resolvedRule;
+
+    easytty_event_callback callback = nullptr;
+    void* userData = nullptr;
+    easytty_device eventDevice;
+
+    explicit easytty_context(const std::string& rulesDir) : manager(rulesDir) {}
+};
+
+namespace {
+
+// Exceptions must not cross the C boundary
+template <typename Fn>
+int guarded(easytty_context* ctx, Fn&& fn) {
+    if (!ctx) {
+        return -1;
+    }
+    try {
+        ctx->lastError.clear();
+        return fn();
+    } catch (const std::exception& e) {
+        ctx->lastError = e.what();
+    } catch (...) {
+        ctx->lastError = "unknown error";
+    }
+    return -1;
+}
+
+easytty_context* create(const char* rulesDir) {
+    try {
+        return new easytty_context(rulesDir ? rulesDir : easytty::UdevManager::RULES_DIR);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void scan(easytty_context* ctx) {
+    ctx->devices.clear();
+    for (const auto& device : ctx->detector.scanDevices()) {
+        ctx->devices.push_back({device});
+    }
+    ctx->scanned = true;
+    ctx->indexStale = true;
+}
+
+void loadRules(easytty_context* ctx) {
+    ctx->manager.refresh();
+    ctx->rules.clear();
+    for (const auto& rule : ctx->manager.getExistingRules()) {
+        ctx->rules.push_back({rule});
+    }
+    ctx->rulesLoaded = true;
+    ctx->indexStale = true;
+}
+
+} // namespace
+
+extern "C" {
+
+int easytty_abi_version(void) {
+    return EASYTTY_ABI_VERSION;
+}
+
+easytty_context* easytty_new(void) {
+    return create(nullptr);
+}
+
+easytty_context* easytty_new_with_rules_dir(const char* rules_dir) {
+    return create(rules_dir);
+}
+
+void easytty_free(easytty_context* ctx) {
+    delete ctx;
+}
+
+const char* easytty_last_error(const easytty_context* ctx) {
+    return ctx ? ctx->lastError.c_str() : "no context";
+}
+
+int easytty_scan_devices(easytty_context* ctx, size_t* count) {
+    return guarded(ctx, [&]() {
+        scan(ctx);
+        if (count) *count = ctx->devices.size();
+        return 0;
+    });
+}
+
+const easytty_device* easytty_device_at(const easytty_context* ctx, size_t index) {
+    return ctx && index < ctx->devices.size() ? &ctx->devices[index] : nullptr;
+}
+
+const char* easytty_device_get(const easytty_device* device, easytty_device_field field) {
+    if (!device) {
+        return "";
+    }
+    const DeviceInfo& info = device->info;
+    switch (field) {
+        case EASYTTY_DEVICE_PATH:          return info.devPath.c_str();
+        case EASYTTY_DEVICE_NODE:          return info.devNode.c_str();
+        case EASYTTY_DEVICE_SYS_PATH:      return info.sysPath.c_str();
+        case EASYTTY_DEVICE_VENDOR_ID:     return info.vendorId.c_str();
+        case EASYTTY_DEVICE_PRODUCT_ID:    return info.productId.c_str();
+        case EASYTTY_DEVICE_SERIAL:        return info.serial.c_str();
+        case EASYTTY_DEVICE_MANUFACTURER:  return info.manufacturer.c_str();
+        case EASYTTY_DEVICE_PRODUCT:       return info.product.c_str();
+        case EASYTTY_DEVICE_DRIVER:        return info.driver.c_str();
+        case EASYTTY_DEVICE_BUS_NUM:       return info.busNum.c_str();
+        case EASYTTY_DEVICE_DEV_NUM:       return info.devNum.c_str();
+        case EASYTTY_DEVICE_INTERFACE_NUM: return info.interfaceNum.c_str();
+        case EASYTTY_DEVICE_KERNEL_PATH:   return info.kernelPath.c_str();
+    }
+    return "";
+}
+
+int easytty_load_rules(easytty_context* ctx, size_t* count) {
+    return guarded(ctx, [&]() {
+        loadRules(ctx);
+        if (count) *count = ctx->rules.size();
+        return 0;
+    });
+}
+
+const easytty_rule* easytty_rule_at(const easytty_context* ctx, size_t index) {
+    return ctx && index < ctx->rules.size() ? &ctx->rules[index] : nullptr;
+}
+
+const char* easytty_rule_get(const easytty_rule* rule, easytty_rule_field field) {
+    if (!rule) {
+        return "";
+    }
+    const UdevRule& info = rule->rule;
+    switch (field) {
+        case EASYTTY_RULE_SYMLINK:     return info.symlink.c_str();
+        case EASYTTY_RULE_VENDOR_ID:   return info.vendorId.c_str();
+        case EASYTTY_RULE_PRODUCT_ID:  return info.productId.c_str();
+        case EASYTTY_RULE_SERIAL:      return info.serial.c_str();
+        case EASYTTY_RULE_KERNEL_PATH: return info.kernelPath.c_str();
+        case EASYTTY_RULE_FILE_PATH:   return info.filePath.c_str();
+    }
+    return "";
+}
+
+int easytty_resolve(easytty_context* ctx, const char* query, const easytty_device** device,
+                    const easytty_rule** rule, easytty_link_status* status) {
+    return guarded(ctx, [&]() {
+        if (!query) {
+            ctx->lastError = "query is NULL";
+            return -1;
+        }
+        if (!ctx->scanned) scan(ctx);
+        if (!ctx->rulesLoaded) loadRules(ctx);
+        if (ctx->indexStale) {
+            std::vector<DeviceInfo> devices;
+            devices.reserve(ctx->devices.size());
+            for (const auto& entry : ctx->devices) devices.push_back(entry.info);
+            std::vector<UdevRule> rules;
+            rules.reserve(ctx->rules.size());
+            for (const auto& entry : ctx->rules) rules.push_back(entry.rule);
+            ctx->index.build(devices, rules);
+            ctx->indexStale = false;
+        }
+
+        auto records = ctx->index.resolve(query);
+        if (device) *device = nullptr;
+        if (rule) *rule = nullptr;
+        if (status) *status = EASYTTY_LINK_UNMANAGED;
+        if (records.empty()) {
+            return 0;
+        }
+
+        const easytty::DeviceRecord& first = records.front();
+        if (first.device && device) {
+            ctx->resolvedDevice.info = *first.device;
+            *device = &ctx->resolvedDevice;
+        }
+        if (first.rule && rule) {
+            ctx->resolvedRule.rule = *first.rule;
+            *rule = &ctx->resolvedRule;
+        }
+        if (status) {
+            *status = static_cast<easytty_link_status>(ctx->index.linkStatus(first));
+        }
+        return static_cast<int>(records.size());
+    });
+}
+
+int easytty_monitor_start(easytty_context* ctx, easytty_event_callback callback, void* user_data) {
+    return guarded(ctx, [&]() {
+        if (!callback) {
+            ctx->lastError = "callback is NULL";
+            return -1;
+        }
+        if (!ctx->detector.startMonitor()) {
+            ctx->lastError = "cannot start the udev monitor";
+            return -1;
+        }
+        ctx->callback = callback;
+        ctx->userData = user_data;
+        return ctx->detector.getMonitorFd();
+    });
+}
+
+int easytty_monitor_dispatch(easytty_context* ctx) {
+    return guarded(ctx, [&]() {
+        int fd = ctx->detector.getMonitorFd();
+        if (fd < 0 || !ctx->callback) {
+            ctx->lastError = "monitor not started";
+            return -1;
+        }
+
+        int delivered = 0;
+        struct pollfd pfd = {fd, POLLIN, 0};
+        while (poll(&pfd, 1, 0) > 0 && (pfd.revents & POLLIN)) {
+            auto event = ctx->detector.receiveEvent();
+            if (!event) continue;
+
+            easytty_event_action action = EASYTTY_EVENT_CHANGE;
+            if (event->action == easytty::DeviceAction::Add) {
+                action = EASYTTY_EVENT_ADD;
+            } else if (event->action == easytty::DeviceAction::Remove) {
+                action = EASYTTY_EVENT_REMOVE;
+            }
+            ctx->eventDevice.info = event->device;
+            ctx->callback(action, &ctx->eventDevice, ctx->userData);
+            delivered++;
+        }
+        return delivered;
+    });
+}
+
+void easytty_monitor_stop(easytty_context* ctx) {
+    if (ctx) {
+        ctx->detector.stopMonitor();
+        ctx->callback = nullptr;
+        ctx->userData = nullptr;
+    }
+}
+
+} // extern "C"
@@ -0,0 +1,152 @@
+#include "cli/Commands.hpp"
+#include "device/DeviceDetector.hpp"
+#include "udev/NamingPolicy.hpp"
+#include "udev/UdevManager.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+
+namespace easytty {
+namespace cli {
+
+std::vector<NameAssignment> planNames(const NamingPolicy& policy, const std::vector<DeviceInfo>& candidates,
+                                      const UdevManager& manager, RuleIndex& pending,
+                                      std::vector<std::string>& errors) {
+    // Attach order must not decide who gets the plain name and who gets _2
+    std::vector<DeviceInfo> ordered = candidates;
+    std::stable_sort(ordered.begin(), ordered.end(), [](const DeviceInfo& a, const DeviceInfo& b) {
+        std::string keyA = DeviceDetector::physicalDeviceKey(a);
+        std::string keyB = DeviceDetector::physicalDeviceKey(b);
+        return keyA != keyB ? keyA < keyB : a.interfaceNum < b.interfaceNum;
+    });
+
+    std::vector<NameAssignment> assignments;
+    for (const auto& device : ordered) {
+        if (!device.isValid() || pending.findForDevice(device)) continue;
+
+        const NamingPolicy::Entry* entry = nullptr;
+        auto name = policy.nameFor(device, &entry);
+        if (!name) continue;
+
+        NameAssignment assignment;
+        assignment.device = device;
+        assignment.matchInterface = !device.interfaceNum.empty();
+        assignment.policyLine = entry->line;
+        assignment.symlinkName = NamingPolicy::uniqueName(*name, [&pending](const std::string& candidate) {
+            return pending.findBySymlink(candidate) != nullptr;
+        });
+        // Everything createRule() will check, so applyNames() does not stop halfway
+        auto validation = manager.validateRule(device, assignment.symlinkName, assignment.matchInterface, pending);
+        if (!validation.success) {
+            errors.push_back(device.devNode + ": policy line " + std::to_string(entry->line) + " gives '" +
+                             assignment.symlinkName + "': " + validation.message);
+            continue;
+        }
+
+        pending.add(manager.makeRule(device, assignment.symlinkName, assignment.matchInterface));
+        assignments.push_back(std::move(assignment));
+    }
+    return assignments;
+}
+
+size_t applyNames(UdevManager& manager, const std::vector<NameAssignment>& assignments, std::string& error) {
+    size_t created = 0;
+    std::vector<std::string> sysPaths;
+    for (const auto& assignment : assignments) {
+        auto result = manager.createRule(assignment.device, assignment.symlinkName, assignment.matchInterface);
+        if (!result.success) {
+            error = assignment.device.devNode + ": " + result.message;
+            break;
+        }
+        created++;
+        sysPaths.push_back(assignment.device.sysPath);
+    }
+
+    // The devices are already attached: reload once, then replay only them
+    if (created > 0) {
+        auto result = manager.reloadRules();
+        if (result.success) {
+            result = manager.triggerDevices(sysPaths);
+        }
+        if (!result.success && error.empty()) {
+            error = result.message;
+        }
+    }
+    return created;
+}
+
+int autoNameCommand(const std::string& policyPath, bool dryRun, OutputFormat format) {
+    std::string error;
+    auto policy = NamingPolicy::load(policyPath, error);
+    if (!policy) {
+        std::cerr << "Error: " << error << "\n";
+        return 1;
+    }
+
+    try {
+        DeviceDetector detector;
+        UdevManager manager;
+
+        RuleIndex pending = manager.getRuleIndex();
+        std::vector<std::string> errors;
+        auto assignments = planNames(*policy, detector.scanDevices(), manager, pending, errors);
+        for (const auto& problem : errors) {
+            std::cerr << "Warning: " << problem << "\n";
+        }
+
+        size_t created = 0;
+        if (!dryRun) {
+            created = applyNames(manager, assignments, error);
+        }
+
+        if (format != OutputFormat::Text) {
+            RecordWriter writer(format);
+            auto writeAssignment = [&writer](const NameAssignment& assignment, bool isCreated) {
+                writer.field("symlink", assignment.symlinkName);
+                writer.field("policyLine", assignment.policyLine);
+                writer.field("created", isCreated);
+                writer.beginObject("device");
+                writeDeviceFields(writer, assignment.device);
+                writer.endObject();
+            };
+            writer.beginHeader();
+            writeAssignment(NameAssignment(), false);
+            writer.endHeader();
+            for (size_t i = 0; i < assignments.size(); i++) {
+                writer.beginRecord();
+                writeAssignment(assignments[i], i < created);
+                writer.endRecord();
+            }
+            writer.finish();
+        } else if (assignments.empty()) {
+            std::cout << "No unnamed devices match " << policyPath << "\n";
+        } else {
+            for (const auto& assignment : assignments) {
+                char line[256];
+                std::snprintf(line, sizeof(line), "  /dev/%-20s %-10s [%s:%s%s%s] (policy line %d)\n",
+                              assignment.symlinkName.c_str(), assignment.device.devNode.c_str(),
+                              assignment.device.vendorId.c_str(), assignment.device.productId.c_str(),
+                              assignment.device.serial.empty() ? "" : " S:",
+                              assignment.device.serial.c_str(), assignment.policyLine);
+                std::cout << line;
+            }
+            if (dryRun) {
+                std::cout << "Dry run, no rules were written.\n";
+            } else {
+                std::cout << created << " rule(s) created, udev reloaded\n";
+            }
+        }
+
+        if (!error.empty()) {
+            std::cerr << "Error: " << error << "\n";
+            return 1;
+        }
+        return errors.empty() ? 0 : 1;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+}
+
+} // namespace cli
+} // namespace easytty
@@ -0,0 +1,123 @@
+#include "cli/Commands.hpp"
+#include "device/DeviceDetector.hpp"
+#include "device/DeviceIndex.hpp"
+#include "udev/UdevManager.hpp"
+#include <iostream>
+
+namespace easytty {
+namespace cli {
+
+namespace {
+
+const char* statusName(int code) {
+    switch (code) {
+        case CHECK_OK:       return "OK";
+        case CHECK_WARNING:  return "WARNING";
+        case CHECK_CRITICAL: return "CRITICAL";
+        default:             return "UNKNOWN";
+    }
+}
+
+} // namespace
+
+int checkCommand(OutputFormat format) {
+    int status = CHECK_OK;
+    std::string message;
+    size_t ruleCount = 0;
+    size_t active = 0;
+    size_t absent = 0;
+    size_t missing = 0;
+    size_t wrongDevice = 0;
+    size_t invalid = 0;
+    size_t duplicates = 0;
+    
+    auto problem = [&](int severity, const std::string& text) {
+        status = std::max(status, severity);
+        if (!message.empty()) {
+            message += "; ";
+        }
+        message += text;
+    };
+    
+    try {
+        DeviceDetector detector;
+        UdevManager manager;
+        
+        DeviceIndex index;
+        index.build(detector.scanDevices(), manager.getExistingRules());
+        
+        const auto& rules = index.getRules();
+        ruleCount = rules.size();
+        
+        for (const auto& file : manager.getInvalidRuleFiles()) {
+            invalid++;
+            problem(CHECK_CRITICAL, "unparsable rule " + file);
+        }
+        
+        for (size_t i = 0; i < rules.size(); i++) {
+            const UdevRule& rule = rules[i];
+            
+            // Rules are sorted by symlink, so collisions are adjacent
+            if (i > 0 && rules[i - 1].symlink == rule.symlink) {
+                duplicates++;
+                problem(CHECK_CRITICAL, "name " + rule.symlink + " defined twice (" +
+                        rules[i - 1].filePath + ", " + rule.filePath + ")");
+                continue;
+            }
+            
+            const DeviceInfo* device = index.deviceForRule(rule);
+            LinkStatus link = index.linkStatus({device, &rule});
+            
+            if (link == LinkStatus::Active) {
+                active++;
+            } else if (link == LinkStatus::WrongDevice) {
+                wrongDevice++;
+                problem(CHECK_CRITICAL, rule.symlink + " points at the wrong device");
+            } else if (device) {
+                missing++;
+                problem(CHECK_CRITICAL, rule.symlink + " missing for " + device->devPath);
+            } else {
+                absent++;
+                problem(CHECK_WARNING, rule.symlink + " device not connected");
+            }
+        }
+    } catch (const std::exception& e) {
+        status = CHECK_UNKNOWN;
+        message = e.what();
+    }
+    
+    if (message.empty()) {
+        message = std::to_string(ruleCount) + " rules, " + std::to_string(active) + " active";
+    }
+    
+    if (format != OutputFormat::Text) {
+        RecordWriter writer(format);
+        writer.beginRecord();
+        writer.field("status", statusName(status));
+        writer.field("code", status);
+        writer.field("message", message);
+        writer.field("rules", static_cast<unsigned long long>(ruleCount));
+        writer.field("active", static_cast<unsigned long long>(active));
+        writer.field("absent", static_cast<unsigned long long>(absent));
+        writer.field("missing", static_cast<unsigned long long>(missing));
+        writer.field("wrongDevice", static_cast<unsigned long long>(wrongDevice));
+        writer.field("invalid", static_cast<unsigned long long>(invalid));
+        writer.field("duplicates", static_cast<unsigned long long>(duplicates));
+        writer.endRecord();
+        writer.finish();
+        return status;
+    }
+    
+    std::cout << "EASYTTY " << statusName(status) << " - " << message
+              << " | rules=" << ruleCount
+              << " active=" << active
+              << " absent=" << absent
+              << " missing=" << missing
+              << " wrong_device=" << wrongDevice
+              << " invalid=" << invalid
+              << " duplicates=" << duplicates << "\n";
+    return status;
+}
+
+} // namespace cli
+} // namespace easytty
@@ -0,0 +1,329 @@
+#include "cli/Commands.hpp"
+#include "common/Utils.hpp"
+#include "device/DeviceDetector.hpp"
+#include "udev/UdevManager.hpp"
+#include <algorithm>
+#include <iostream>
+#include <sstream>
+
+namespace easytty {
+namespace cli {
+
+namespace {
+
+struct BatchEntry {
+    enum class Op { Create, Delete };
+
+    int line;
+    Op op;
+    std::string symlinkName;
+    DeviceInfo device;
+    bool matchInterface;
+};
+
+bool isDeviceNodeSpec(const std::string& spec) {
+    return spec.find('/') != std::string::npos || utils::startsWith(spec, "tty");
+}
+
+// The ttys of the physical device a tty belongs to, ordered by interface
+std::vector<DeviceInfo> interfacesOf(const std::vector<DeviceInfo>& devices, const DeviceInfo& device) {
+    std::string key = DeviceDetector::physicalDeviceKey(device);
+    for (auto& group : DeviceDetector::groupInterfaces(devices)) {
+        if (DeviceDetector::physicalDeviceKey(group.front()) == key) {
+            return group;
+        }
+    }
+    return {device};
+}
+
+std::string describeInterfaces(const std::vector<DeviceInfo>& interfaces) {
+    std::string nodes;
+    for (const auto& dev : interfaces) {
+        nodes += (nodes.empty() ? "" : ", ") + dev.devNode;
+    }
+    return nodes;
+}
+
+} // namespace
+
+std::optional<DeviceInfo> resolveDeviceSpec(const std::vector<DeviceInfo>& devices,
+                                            const std::string& spec,
+                                            std::string& error) {
+    std::vector<const DeviceInfo*> matches;
+
+    if (isDeviceNodeSpec(spec)) {
+        // Device node
+        for (const auto& dev : devices) {
+            if (dev.devPath == spec || dev.devNode == spec) {
+                matches.push_back(&dev);
+            }
+        }
+    } else if (std::count(spec.begin(), spec.end(), ':') == 2) {
+        // vid:pid:serial
+        auto parts = utils::split(spec, ':');
+        std::string vendorId = utils::formatHexId(parts[0]);
+        std::string productId = utils::formatHexId(parts[1]);
+        for (const auto& dev : devices) {
+            if (dev.vendorId == vendorId && dev.productId == productId && dev.serial == parts[2]) {
+                matches.push_back(&dev);
+            }
+        }
+    } else {
+        // USB port path
+        for (const auto& dev : devices) {
+            if (dev.kernelPath == spec) {
+                matches.push_back(&dev);
+            }
+        }
+    }
+
+    if (matches.empty()) {
+        error = "No connected device matches '" + spec + "'";
+        return std::nullopt;
+    }
+
+    for (const DeviceInfo* dev : matches) {
+        if (dev->getUniqueId() != matches.front()->getUniqueId()) {
+            error = "'" + spec + "' matches more than one device, use the device node instead";
+            return std::nullopt;
+        }
+    }
+
+    return *matches.front();
+}
+
+int createCommand(const std::string& spec, const std::string& symlinkName) {
+    try {
+        DeviceDetector detector;
+        UdevManager manager;
+
+        std::string error;
+        auto devices = detector.scanDevices();
+        auto device = resolveDeviceSpec(devices, spec, error);
+        if (!device) {
+            std::cerr << "Error: " << error << "\n";
+            return 1;
+        }
+
+        // One port of a multi-port adapter gets a rule for its interface
+        auto interfaces = interfacesOf(devices, *device);
+        if (interfaces.size() > 1 && !isDeviceNodeSpec(spec)) {
+            std::cerr << "Error: '" << spec << "' has " << interfaces.size() << " interfaces ("
+                      << describeInterfaces(interfaces) << "); give the device node of one, "
+                      << "or name all with --create-interfaces\n";
+            return 1;
+        }
+
+        auto result = manager.createRule(*device, symlinkName, interfaces.size() > 1);
+        if (!result.success) {
+            std::cerr << "Error: " << result.message << "\n";
+            return 1;
+        }
+        std::cout << result.message << "\n";
+
+        auto applyResult = manager.applyRules();
+        if (!applyResult.success) {
+            std::cerr << "Warning: " << applyResult.message << "\n";
+        }
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+}
+
+int createInterfacesCommand(const std::string& spec, const std::string& names) {
+    try {
+        DeviceDetector detector;
+        UdevManager manager;
+
+        std::string error;
+        auto devices = detector.scanDevices();
+        auto device = resolveDeviceSpec(devices, spec, error);
+        if (!device) {
+            std::cerr << "Error: " << error << "\n";
+            return 1;
+        }
+
+        auto interfaces = interfacesOf(devices, *device);
+        std::vector<std::string> symlinkNames = names.find(',') != std::string::npos
+            ? utils::split(names, ',')
+            : UdevManager::interfaceNames(names, interfaces.size());
+        if (symlinkNames.size() != interfaces.size()) {
+            std::cerr << "Error: " << symlinkNames.size() << " names given for " << interfaces.size()
+                      << " interfaces (" << describeInterfaces(interfaces) << ")\n";
+            return 1;
+        }
+
+        auto result = manager.createInterfaceRules(interfaces, symlinkNames);
+        if (!result.success) {
+            std::cerr << "Error: " << result.message << "\n";
+            return 1;
+        }
+        for (size_t i = 0; i < interfaces.size(); i++) {
+            std::cout << "/dev/" << symlinkNames[i] << " -> interface " << interfaces[i].interfaceNum
+                      << " (" << interfaces[i].devNode << ")\n";
+        }
+        std::cout << result.message << "\n";
+
+        auto applyResult = manager.applyRules();
+        if (!applyResult.success) {
+            std::cerr << "Warning: " << applyResult.message << "\n";
+        }
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+}
+
+int deleteCommand(const std::string& symlinkName) {
+    try {
+        UdevManager manager;
+
+        auto result = manager.deleteRule(symlinkName);
+        if (!result.success) {
+            std::cerr << "Error: " << result.message << "\n";
+            return 1;
+        }
+        std::cout << result.message << ": /dev/" << symlinkName << "\n";
+
+        auto applyResult = manager.applyRules();
+        if (!applyResult.success) {
+            std::cerr << "Warning: " << applyResult.message << "\n";
+        }
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+}
+
+int batchCommand(std::istream& in) {
+    try {
+        UdevManager manager;
+        DeviceDetector detector;
+        return batchCommand(in, manager, detector);
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+}
+
+int batchCommand(std::istream& in, UdevManager& manager, DeviceDetector& detector) {
+    try {
+        bool scanned = false;
+        std::vector<DeviceInfo> devices;
+
+        // Validate everything against a scratch copy of the rule index so
+        // later lines see the effect of earlier ones
+        RuleIndex pending = manager.getRuleIndex();
+        std::vector<BatchEntry> entries;
+        std::vector<std::string> errors;
+
+        std::string line;
+        int lineNum = 0;
+        while (std::getline(in, line)) {
+            lineNum++;
+            line = utils::trim(line);
+            if (line.empty() || line[0] == '#') continue;
+
+            std::istringstream tokens(line);
+            std::string command, arg1, arg2, extra;
+            tokens >> command >> arg1 >> arg2 >> extra;
+
+            auto fail = [&](const std::string& msg) {
+                errors.push_back("line " + std::to_string(lineNum) + ": " + msg);
+            };
+
+            if (command == "create") {
+                if (arg2.empty() || !extra.empty()) {
+                    fail("usage: create <device> <name>");
+                    continue;
+                }
+                if (!scanned) {
+                    devices = detector.scanDevices();
+                    scanned = true;
+                }
+
+                std::string error;
+                auto device = resolveDeviceSpec(devices, arg1, error);
+                if (!device) {
+                    fail(error);
+                    continue;
+                }
+                bool matchInterface = interfacesOf(devices, *device).size() > 1;
+                if (matchInterface && !isDeviceNodeSpec(arg1)) {
+                    fail("'" + arg1 + "' has several interfaces, give the device node of one");
+                    continue;
+                }
+                // Everything createRule() checks, against the rules as the earlier lines leave them
+                auto validation = manager.validateRule(*device, arg2, matchInterface, pending);
+                if (!validation.success) {
+                    fail(arg1 + ": " + validation.message);
+                    continue;
+                }
+
+                pending.add(manager.makeRule(*device, arg2, matchInterface));
+                entries.push_back({lineNum, BatchEntry::Op::Create, arg2, *device, matchInterface});
+            } else if (command == "delete") {
+                if (arg1.empty() || !arg2.empty()) {
+                    fail("usage: delete <name>");
+                    continue;
+                }
+                // deleteRule() takes a rule name as well as a symlink
+                const UdevRule* rule = pending.findBySymlinkOrName(arg1);
+                if (!rule) {
+                    fail("rule not found: " + arg1);
+                    continue;
+                }
+                pending.remove(std::string(rule->symlink));
+                entries.push_back({lineNum, BatchEntry::Op::Delete, arg1, DeviceInfo(), false});
+            } else {
+                fail("unknown command '" + command + "'");
+            }
+        }
+
+        if (!errors.empty()) {
+            for (const auto& error : errors) {
+                std::cerr << "Error: " << error << "\n";
+            }
+            std::cerr << "Batch rejected, no rules were changed.\n";
+            return 1;
+        }
+
+        // Write all changes, then reload udev once
+        int created = 0;
+        int deleted = 0;
+        bool failed = false;
+        for (const auto& entry : entries) {
+            auto result = (entry.op == BatchEntry::Op::Create)
+                ? manager.createRule(entry.device, entry.symlinkName, entry.matchInterface)
+                : manager.deleteRule(entry.symlinkName);
+
+            if (!result.success) {
+                std::cerr << "Error: line " << entry.line << ": " << result.message << "\n";
+                failed = true;
+                break;
+            }
+            (entry.op == BatchEntry::Op::Create ? created : deleted)++;
+        }
+
+        if (created + deleted > 0) {
+            auto applyResult = manager.applyRules();
+            if (!applyResult.success) {
+                std::cerr << "Warning: " << applyResult.message << "\n";
+            }
+        }
+
+        std::cout << "Batch " << (failed ? "stopped" : "complete") << ": "
+                  << created << " created, " << deleted << " deleted\n";
+        return failed ? 1 : 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+}
+
+} // namespace cli
+} // namespace easytty
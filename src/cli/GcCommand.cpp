@@ -0,0 +1,123 @@
+#include "cli/Commands.hpp"
+#include "common/Utils.hpp"
+#include "device/DeviceDetector.hpp"
+#include "device/DeviceInventory.hpp"
+#include "udev/UdevManager.hpp"
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+
+namespace easytty {
+namespace cli {
+
+namespace {
+
+std::string describeRule(const UdevRule& rule) {
+    std::string id = rule.vendorId + ":" + rule.productId;
+    if (!rule.serial.empty()) {
+        id += ":" + rule.serial;
+    } else if (!rule.kernelPath.empty()) {
+        id += " port " + rule.kernelPath;
+    }
+    if (!rule.interfaceNum.empty()) {
+        id += " if" + rule.interfaceNum;
+    }
+    return id;
+}
+
+} // namespace
+
+int gcCommand(const std::string& olderThan, bool archive, bool dryRun, OutputFormat format) {
+    uint64_t window = 0;
+    if (!utils::parseDuration(olderThan, window)) {
+        std::cerr << "Error: Invalid --older-than '" << olderThan << "' (expected e.g. 90d or 12w)\n";
+        return 1;
+    }
+
+    try {
+        uint64_t now = std::chrono::duration_cast<std::chrono::seconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+
+        // Whatever is plugged in right now is not stale
+        DeviceInventory inventory;
+        inventory.load();
+        DeviceDetector detector;
+        if (detector.getSource().isLive()) {
+            inventory.observe(detector.scanDevices(), now);
+            if (inventory.takeChanged()) {
+                auto result = inventory.save();
+                if (!result.success) {
+                    std::cerr << "Warning: " << result.message << "\n";
+                }
+            }
+        }
+
+        UdevManager manager;
+        auto stale = inventory.findStaleRules(manager.getExistingRules(), window < now ? now - window : 0);
+
+        if (format != OutputFormat::Text) {
+            RecordWriter writer(format);
+            auto writeStale = [&](const DeviceInventory::StaleRule& entry) {
+                writer.field("symlink", entry.rule.symlink);
+                writer.field("filePath", entry.rule.filePath);
+                writer.field("vendorId", entry.rule.vendorId);
+                writer.field("productId", entry.rule.productId);
+                writer.field("serial", entry.rule.serial);
+                writer.field("kernelPath", entry.rule.kernelPath);
+                writer.field("lastSeen", static_cast<unsigned long long>(entry.lastSeen.value_or(0)));
+                writer.field("missingDays", static_cast<unsigned long long>((now - entry.missingSince) / 86400));
+            };
+            writer.beginHeader();
+            writeStale(DeviceInventory::StaleRule());
+            writer.endHeader();
+            for (const auto& entry : stale) {
+                writer.beginRecord();
+                writeStale(entry);
+                writer.endRecord();
+            }
+            writer.finish();
+        } else if (stale.empty()) {
+            std::cout << "No rules for devices unseen in " << olderThan << " (" << manager.getExistingRules().size()
+                      << " rules, inventory since "
+                      << (inventory.getTrackingSince() ? utils::formatLocalDate(inventory.getTrackingSince()) : "now") << ")\n";
+        } else {
+            std::cout << "Rules for devices not seen in " << olderThan << ":\n";
+            for (const auto& entry : stale) {
+                char line[256];
+                std::snprintf(line, sizeof(line), "  /dev/%-20s %-32s %s %s (%llu days)\n",
+                              entry.rule.symlink.c_str(), describeRule(entry.rule).c_str(),
+                              entry.lastSeen ? "last seen" : "never seen, since",
+                              utils::formatLocalDate(entry.missingSince).c_str(),
+                              static_cast<unsigned long long>((now - entry.missingSince) / 86400));
+                std::cout << line;
+            }
+        }
+
+        if (dryRun || stale.empty()) {
+            if (dryRun && format == OutputFormat::Text && !stale.empty()) {
+                std::cout << "Dry run, no rules were changed.\n";
+            }
+            return 0;
+        }
+
+        std::vector<std::string> files;
+        for (const auto& entry : stale) {
+            files.push_back(entry.rule.filePath);
+        }
+        auto result = manager.removeRuleFiles(files, archive ? UdevManager::ARCHIVE_DIR : "");
+        if (!result.success) {
+            std::cerr << "Error: " << result.message << "\n";
+            return 1;
+        }
+        if (format == OutputFormat::Text) {
+            std::cout << result.message << ", udev reloaded\n";
+        }
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+}
+
+} // namespace cli
+} // namespace easytty
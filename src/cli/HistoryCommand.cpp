@@ -0,0 +1,127 @@
+#include "cli/Commands.hpp"
+#include "common/Utils.hpp"
+#include "device/EventLog.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+
+namespace easytty {
+namespace cli {
+
+namespace {
+
+// "7d" / "12h" back from now, or a local date with optional time
+bool parseSince(const std::string& text, uint64_t& usec) {
+    uint64_t now = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+
+    uint64_t seconds = 0;
+    if (utils::parseDuration(text, seconds)) {
+        uint64_t back = seconds * 1000000;
+        usec = back < now ? now - back : 0;
+        return true;
+    }
+
+    const char* const FORMATS[] = {"%Y-%m-%dT%H:%M:%S", "%Y-%m-%dT%H:%M", "%Y-%m-%d %H:%M:%S",
+                                   "%Y-%m-%d %H:%M", "%Y-%m-%d"};
+    for (const char* format : FORMATS) {
+        struct tm local = {};
+        const char* rest = strptime(text.c_str(), format, &local);
+        if (rest && *rest == '\0') {
+            local.tm_isdst = -1;
+            std::time_t seconds = std::mktime(&local);
+            if (seconds < 0) return false;
+            usec = static_cast<uint64_t>(seconds) * 1000000;
+            return true;
+        }
+    }
+    return false;
+}
+
+void printEntryText(const EventLog::Entry& entry) {
+    const DeviceInfo& dev = entry.device;
+    std::string line = utils::formatTimestampUsec(entry.timestampUsec);
+    line += ' ';
+    line += toString(entry.action);
+    line.append(8 - std::strlen(toString(entry.action)), ' ');
+    line += dev.devPath;
+
+    if (!dev.vendorId.empty()) {
+        line += " [" + dev.vendorId + ":" + dev.productId;
+        if (!dev.serial.empty()) {
+            line += " S:" + dev.serial;
+        }
+        if (!dev.kernelPath.empty()) {
+            line += " Port:" + dev.kernelPath;
+        }
+        line += "]";
+    }
+    if (!entry.symlink.empty()) {
+        line += " -> /dev/" + entry.symlink;
+    }
+    line += '\n';
+    std::fwrite(line.data(), 1, line.size(), stdout);
+}
+
+void writeEntryFields(RecordWriter& writer, const EventLog::Entry& entry) {
+    writer.field("sequence", static_cast<unsigned long long>(entry.sequence));
+    writer.field("timestamp", static_cast<unsigned long long>(entry.timestampUsec));
+    writer.field("seqnum", static_cast<unsigned long long>(entry.seqnum));
+    writer.field("action", toString(entry.action));
+    writer.field("symlink", entry.symlink.empty() ? std::string() : "/dev/" + entry.symlink);
+    writer.field("devPath", entry.device.devPath);
+    writer.field("vendorId", entry.device.vendorId);
+    writer.field("productId", entry.device.productId);
+    writer.field("serial", entry.device.serial);
+    writer.field("kernelPath", entry.device.kernelPath);
+    writer.field("interfaceNum", entry.device.interfaceNum);
+}
+
+} // namespace
+
+int historyCommand(OutputFormat format, const Filter& filter, const std::string& since, const std::string& name) {
+    uint64_t sinceUsec = 0;
+    if (!since.empty() && !parseSince(since, sinceUsec)) {
+        std::cerr << "Error: Invalid --since '" << since
+                  << "' (expected e.g. 30m, 12h, 7d or 2026-10-01T08:00)\n";
+        return 1;
+    }
+    std::string symlink = utils::startsWith(name, "/dev/") ? name.substr(5) : name;
+
+    std::vector<EventLog::Entry> entries;
+    auto result = EventLog::read(EventLog::DEFAULT_PATH, sinceUsec, entries);
+    if (!result.success) {
+        std::cerr << "No event history: " << result.message << " (record it with --watch)\n";
+        return 1;
+    }
+
+    std::optional<RecordWriter> writer;
+    if (format != OutputFormat::Text) {
+        writer.emplace(format);
+        writer->beginHeader();
+        writeEntryFields(*writer, EventLog::Entry());
+        writer->endHeader();
+    }
+    for (const auto& entry : entries) {
+        if (!symlink.empty() && entry.symlink != symlink) continue;
+        if (!filter.matches(entry.device)) continue;
+
+        if (writer) {
+            writer->beginRecord();
+            writeEntryFields(*writer, entry);
+            writer->endRecord();
+        } else {
+            printEntryText(entry);
+        }
+    }
+    if (writer) {
+        writer->finish();
+    }
+    return 0;
+}
+
+} // namespace cli
+} // namespace easytty
@@ -0,0 +1,78 @@
+#include "cli/Commands.hpp"
+#include "device/LatencyTracker.hpp"
+#include <cstdio>
+#include <iostream>
+
+namespace easytty {
+namespace cli {
+
+namespace {
+
+const LatencyTracker::Stage STAGES[] = {
+    LatencyTracker::Stage::Udev, LatencyTracker::Stage::Symlink, LatencyTracker::Stage::Ready
+};
+
+void printGroup(const char* title, const std::map<std::string, LatencyTracker::StageHistograms>& groups) {
+    std::printf("%-20s %-8s %8s %9s %9s %9s %9s\n", title, "STAGE", "COUNT", "P50", "P90", "P99", "MAX");
+    for (const auto& entry : groups) {
+        for (LatencyTracker::Stage stage : STAGES) {
+            const Histogram& h = entry.second[static_cast<size_t>(stage)];
+            if (!h.count()) continue;
+            std::printf("%-20s %-8s %8llu %9.2f %9.2f %9.2f %9.2f\n",
+                        entry.first.c_str(), LatencyTracker::stageName(stage),
+                        static_cast<unsigned long long>(h.count()),
+                        h.percentile(0.5) / 1000.0, h.percentile(0.9) / 1000.0,
+                        h.percentile(0.99) / 1000.0, h.max() / 1000.0);
+        }
+    }
+}
+
+void writeGroup(RecordWriter& writer, const char* group,
+                const std::map<std::string, LatencyTracker::StageHistograms>& groups) {
+    for (const auto& entry : groups) {
+        for (LatencyTracker::Stage stage : STAGES) {
+            const Histogram& h = entry.second[static_cast<size_t>(stage)];
+            if (!h.count()) continue;
+            writer.beginRecord();
+            writer.field("group", group);
+            writer.field("key", entry.first);
+            writer.field("stage", LatencyTracker::stageName(stage));
+            writer.field("count", static_cast<unsigned long long>(h.count()));
+            writer.field("minUsec", static_cast<unsigned long long>(h.min()));
+            writer.field("p50Usec", static_cast<unsigned long long>(h.percentile(0.5)));
+            writer.field("p90Usec", static_cast<unsigned long long>(h.percentile(0.9)));
+            writer.field("p99Usec", static_cast<unsigned long long>(h.percentile(0.99)));
+            writer.field("maxUsec", static_cast<unsigned long long>(h.max()));
+            writer.field("meanUsec", static_cast<unsigned long long>(h.mean()));
+            writer.endRecord();
+        }
+    }
+}
+
+} // namespace
+
+int latencyCommand(OutputFormat format) {
+    LatencyTracker tracker;
+    if (!tracker.load()) {
+        std::cerr << "No latency data in " << LatencyTracker::STATE_FILE
+                  << " (record it with --watch --latency)\n";
+        return 1;
+    }
+
+    if (format != OutputFormat::Text) {
+        RecordWriter writer(format);
+        writeGroup(writer, "rule", tracker.getByRule());
+        writeGroup(writer, "driver", tracker.getByDriver());
+        writer.finish();
+        return 0;
+    }
+
+    std::printf("Attach latency in ms since udev initialized the device\n\n");
+    printGroup("RULE", tracker.getByRule());
+    std::printf("\n");
+    printGroup("DRIVER", tracker.getByDriver());
+    return 0;
+}
+
+} // namespace cli
+} // namespace easytty
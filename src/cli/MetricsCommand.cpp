@@ -0,0 +1,38 @@
+#include "cli/Commands.hpp"
+#include "cli/MetricsExporter.hpp"
+#include "device/DeviceDetector.hpp"
+#include "device/LatencyTracker.hpp"
+#include "udev/UdevManager.hpp"
+#include <iostream>
+
+namespace easytty {
+namespace cli {
+
+int metricsCommand(const std::string& path, bool portCounters) {
+    try {
+        DeviceDetector detector;
+        UdevManager manager;
+        detector.scanDevices();
+
+        MetricsExporter exporter(path, portCounters, false);
+
+        // Include latency recorded by a running --watch --latency, if any
+        LatencyTracker latency;
+        if (latency.load()) {
+            exporter.setLatencyTracker(&latency);
+        }
+
+        auto result = exporter.write(detector, manager);
+        if (!result.success) {
+            std::cerr << "Error: " << result.message << "\n";
+            return 1;
+        }
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+}
+
+} // namespace cli
+} // namespace easytty
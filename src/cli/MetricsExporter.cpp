@@ -0,0 +1,289 @@
+#include "cli/MetricsExporter.hpp"
+#include "device/DeviceDetector.hpp"
+#include "device/LatencyTracker.hpp"
+#include "udev/UdevManager.hpp"
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <map>
+#include <unordered_set>
+#include <vector>
+#include <fcntl.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+#include <linux/serial.h>
+
+namespace easytty {
+namespace cli {
+
+namespace {
+
+// Label values may contain anything a rule or sysfs attribute holds
+std::string label(const char* name, const std::string& value) {
+    std::string out = name;
+    out += "=\"";
+    for (char c : value) {
+        switch (c) {
+            case '\\': out += "\\\\"; break;
+            case '"':  out += "\\\""; break;
+            case '\n': out += "\\n"; break;
+            default:   out += c; break;
+        }
+    }
+    out += '"';
+    return out;
+}
+
+double seconds(std::chrono::microseconds duration) {
+    return static_cast<double>(duration.count()) / 1e6;
+}
+
+} // namespace
+
+MetricsExporter::MetricsExporter(const std::string& path, bool portCounters, bool eventCounters)
+    : path_(path), tmpPath_(path + ".tmp"), portCounters_(portCounters),
+      eventCounters_(eventCounters), events_{0, 0, 0}, latency_(nullptr) {
+    buffer_.reserve(4096);
+}
+
+void MetricsExporter::countEvent(DeviceAction action) {
+    events_[static_cast<size_t>(action)]++;
+}
+
+void MetricsExporter::header(const char* name, const char* type, const char* help) {
+    buffer_ += "# HELP ";
+    buffer_ += name;
+    buffer_ += ' ';
+    buffer_ += help;
+    buffer_ += "\n# TYPE ";
+    buffer_ += name;
+    buffer_ += ' ';
+    buffer_ += type;
+    buffer_ += '\n';
+}
+
+void MetricsExporter::sample(const char* name, const std::string& labels, unsigned long long value) {
+    buffer_ += name;
+    if (!labels.empty()) {
+        buffer_ += '{';
+        buffer_ += labels;
+        buffer_ += '}';
+    }
+    buffer_ += ' ';
+    buffer_ += std::to_string(value);
+    buffer_ += '\n';
+}
+
+void MetricsExporter::sample(const char* name, const std::string& labels, double value) {
+    char number[32];
+    snprintf(number, sizeof(number), "%.6f", value);
+    buffer_ += name;
+    if (!labels.empty()) {
+        buffer_ += '{';
+        buffer_ += labels;
+        buffer_ += '}';
+    }
+    buffer_ += ' ';
+    buffer_ += number;
+    buffer_ += '\n';
+}
+
+OperationResult MetricsExporter::write(const DeviceDetector& detector, const UdevManager& manager) {
+    buffer_.clear();
+
+    DeviceDetector::DeviceList deviceSnapshot = detector.getSnapshot();
+    UdevManager::RuleSnapshot ruleSnapshot = manager.getSnapshot();
+    const auto& devices = *deviceSnapshot;
+    const auto& rules = ruleSnapshot->rules;
+    const RuleIndex& ruleIndex = ruleSnapshot->index;
+
+    // Devices per vid:pid, and which rules currently have their device
+    std::map<std::pair<std::string, std::string>, unsigned long long> perModel;
+    std::unordered_set<std::string> present;
+    for (const auto& dev : devices) {
+        perModel[{dev.vendorId, dev.productId}]++;
+        if (const UdevRule* rule = ruleIndex.findForDevice(dev)) {
+            present.insert(rule->symlink);
+        }
+    }
+
+    header("easytty_devices", "gauge", "Connected USB serial devices by vendor and product ID");
+    for (const auto& entry : perModel) {
+        sample("easytty_devices",
+               label("vendor_id", entry.first.first) + "," + label("product_id", entry.first.second),
+               entry.second);
+    }
+
+    unsigned long long active = 0;
+    for (const auto& rule : rules) {
+        if (manager.verifySymlink(rule.symlink)) {
+            active++;
+        }
+    }
+    header("easytty_rules", "gauge", "easyTTY rules by symlink state");
+    sample("easytty_rules", "state=\"active\"", active);
+    sample("easytty_rules", "state=\"inactive\"", static_cast<unsigned long long>(rules.size() - active));
+
+    header("easytty_rule_files_invalid", "gauge", "easyTTY rule files that could not be parsed");
+    sample("easytty_rule_files_invalid", "",
+           static_cast<unsigned long long>(ruleSnapshot->invalidRuleFiles.size()));
+
+    unsigned long long missingDevice = 0;
+    header("easytty_name_device_present", "gauge", "1 if the device named by a rule is connected");
+    for (const auto& rule : rules) {
+        bool connected = present.count(rule.symlink) > 0;
+        if (!connected) {
+            missingDevice++;
+        }
+        sample("easytty_name_device_present", label("name", rule.symlink),
+               static_cast<unsigned long long>(connected));
+    }
+    header("easytty_names_missing_device", "gauge", "easyTTY names whose device is not connected");
+    sample("easytty_names_missing_device", "", missingDevice);
+
+    if (eventCounters_) {
+        header("easytty_hotplug_events_total", "counter", "Hotplug events received since start");
+        for (DeviceAction action : {DeviceAction::Add, DeviceAction::Remove, DeviceAction::Change}) {
+            sample("easytty_hotplug_events_total", label("action", toString(action)),
+                   static_cast<unsigned long long>(events_[static_cast<size_t>(action)]));
+        }
+    }
+
+    header("easytty_scan_duration_seconds", "gauge", "Duration of the last full device scan");
+    sample("easytty_scan_duration_seconds", "", seconds(detector.getLastScanDuration()));
+    header("easytty_rule_load_duration_seconds", "gauge", "Duration of the last rule directory load");
+    sample("easytty_rule_load_duration_seconds", "", seconds(manager.getLastLoadDuration()));
+
+    if (portCounters_) {
+        appendPortCounters(detector, manager);
+    }
+
+    if (latency_) {
+        appendLatency();
+    }
+
+    header("easytty_metrics_timestamp_seconds", "gauge", "Unix time these metrics were written");
+    sample("easytty_metrics_timestamp_seconds", "",
+           static_cast<unsigned long long>(std::time(nullptr)));
+
+    // Publish atomically: the collector sees either the old or the new file
+    int fd = open(tmpPath_.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        return OperationResult::Failure("Cannot write " + tmpPath_ + ": " + std::strerror(errno));
+    }
+
+    const char* data = buffer_.data();
+    size_t remaining = buffer_.size();
+    while (remaining > 0) {
+        ssize_t written = ::write(fd, data, remaining);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            int err = errno;
+            close(fd);
+            unlink(tmpPath_.c_str());
+            return OperationResult::Failure("Cannot write " + tmpPath_ + ": " + std::strerror(err));
+        }
+        data += written;
+        remaining -= static_cast<size_t>(written);
+    }
+    close(fd);
+
+    if (rename(tmpPath_.c_str(), path_.c_str()) != 0) {
+        int err = errno;
+        unlink(tmpPath_.c_str());
+        return OperationResult::Failure("Cannot replace " + path_ + ": " + std::strerror(err));
+    }
+
+    return OperationResult::Success();
+}
+
+void MetricsExporter::appendPortCounters(const DeviceDetector& detector, const UdevManager& manager) {
+    struct PortCounters {
+        std::string labels;
+        struct serial_icounter_struct icount;
+    };
+    std::vector<PortCounters> ports;
+
+    for (const auto& dev : detector.getDevices()) {
+        // Non-blocking so a port without carrier does not stall the write
+        int fd = open(dev.devPath.c_str(), O_RDONLY | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+        if (fd < 0) {
+            continue;
+        }
+        PortCounters port;
+        std::memset(&port.icount, 0, sizeof(port.icount));
+        bool supported = ioctl(fd, TIOCGICOUNT, &port.icount) == 0;
+        close(fd);
+        if (!supported) {
+            continue;       // Driver does not keep counters
+        }
+
+        const UdevRule* rule = manager.getRuleIndex().findForDevice(dev);
+        port.labels = label("port", dev.devNode) + "," + label("name", rule ? rule->symlink : "");
+        ports.push_back(std::move(port));
+    }
+
+    struct Counter {
+        const char* name;
+        const char* help;
+        int serial_icounter_struct::*field;
+    };
+    static const Counter COUNTERS[] = {
+        {"easytty_port_rx_bytes_total", "Bytes received by the UART", &serial_icounter_struct::rx},
+        {"easytty_port_tx_bytes_total", "Bytes transmitted by the UART", &serial_icounter_struct::tx},
+        {"easytty_port_frame_errors_total", "Framing errors", &serial_icounter_struct::frame},
+        {"easytty_port_parity_errors_total", "Parity errors", &serial_icounter_struct::parity},
+        {"easytty_port_overrun_errors_total", "Hardware overruns", &serial_icounter_struct::overrun},
+        {"easytty_port_buffer_overrun_errors_total", "Receive buffer overruns", &serial_icounter_struct::buf_overrun},
+        {"easytty_port_breaks_total", "Break conditions", &serial_icounter_struct::brk},
+    };
+
+    for (const auto& counter : COUNTERS) {
+        header(counter.name, "counter", counter.help);
+        for (const auto& port : ports) {
+            sample(counter.name, port.labels,
+                   static_cast<unsigned long long>(static_cast<unsigned int>(port.icount.*counter.field)));
+        }
+    }
+}
+
+void MetricsExporter::appendLatency() {
+    static const double QUANTILES[] = {0.5, 0.9, 0.99};
+    static const LatencyTracker::Stage STAGES[] = {
+        LatencyTracker::Stage::Udev, LatencyTracker::Stage::Symlink, LatencyTracker::Stage::Ready
+    };
+
+    auto appendGroup = [this](const char* name, const char* keyLabel,
+                              const std::map<std::string, LatencyTracker::StageHistograms>& groups) {
+        std::string sumName = std::string(name) + "_sum";
+        std::string countName = std::string(name) + "_count";
+        for (const auto& entry : groups) {
+            for (LatencyTracker::Stage stage : STAGES) {
+                const Histogram& h = entry.second[static_cast<size_t>(stage)];
+                if (!h.count()) continue;
+
+                std::string labels = label("stage", LatencyTracker::stageName(stage)) + "," +
+                                     label(keyLabel, entry.first);
+                for (double q : QUANTILES) {
+                    char quantile[16];
+                    snprintf(quantile, sizeof(quantile), "%g", q);
+                    sample(name, labels + "," + label("quantile", quantile),
+                           static_cast<double>(h.percentile(q)) / 1e6);
+                }
+                sample(sumName.c_str(), labels, static_cast<double>(h.sum()) / 1e6);
+                sample(countName.c_str(), labels, static_cast<unsigned long long>(h.count()));
+            }
+        }
+    };
+
+    header("easytty_attach_latency_seconds", "summary",
+           "Time from udev initializing a device until each stage, per rule");
+    appendGroup("easytty_attach_latency_seconds", "name", latency_->getByRule());
+    header("easytty_attach_latency_by_driver_seconds", "summary",
+           "Time from udev initializing a device until each stage, per driver");
+    appendGroup("easytty_attach_latency_by_driver_seconds", "driver", latency_->getByDriver());
+}
+
+} // namespace cli
+} // namespace easytty
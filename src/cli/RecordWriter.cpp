@@ -0,0 +1,262 @@
+#include "cli/RecordWriter.hpp"
+#include <charconv>
+#include <cstring>
+
+namespace easytty {
+namespace cli {
+
+std::optional<OutputFormat> parseOutputFormat(const std::string& name) {
+    if (name == "text") return OutputFormat::Text;
+    if (name == "json") return OutputFormat::Json;
+    if (name == "ndjson") return OutputFormat::Ndjson;
+    if (name == "tsv") return OutputFormat::Tsv;
+    return std::nullopt;
+}
+
+RecordWriter::RecordWriter(OutputFormat format, std::FILE* out, size_t bufferSize)
+    : format_(format)
+    , out_(out)
+    , bufferSize_(bufferSize)
+    , recordCount_(0)
+    , firstField_(true)
+    , recordStart_(0)
+    , tsvHeaderWritten_(false)
+    , finished_(false) {
+    buffer_.reserve(bufferSize_ + 4096);
+}
+
+RecordWriter::~RecordWriter() {
+    finish();
+}
+
+void RecordWriter::beginHeader() {
+    beginRecord();
+}
+
+void RecordWriter::endHeader() {
+    // Drop the values; TSV keeps the names as its header row
+    buffer_.erase(recordStart_);
+    if (format_ == OutputFormat::Tsv && !tsvHeaderWritten_) {
+        buffer_ += tsvHeader_;
+        buffer_ += '\n';
+        tsvHeaderWritten_ = true;
+    }
+}
+
+void RecordWriter::beginRecord() {
+    recordStart_ = buffer_.size();
+    firstField_ = true;
+
+    switch (format_) {
+        case OutputFormat::Json:
+            buffer_ += (recordCount_ == 0) ? "[\n  {" : ",\n  {";
+            break;
+        case OutputFormat::Tsv:
+            break;
+        default:
+            buffer_ += '{';
+            break;
+    }
+}
+
+void RecordWriter::beginField(const char* name) {
+    if (format_ == OutputFormat::Tsv) {
+        if (!firstField_) {
+            buffer_ += '\t';
+        }
+        // Field names of the first record make up the header row
+        if (recordCount_ == 0 && !tsvHeaderWritten_) {
+            if (!tsvHeader_.empty()) {
+                tsvHeader_ += '\t';
+            }
+            tsvHeader_ += tsvPrefix_;
+            tsvHeader_ += name;
+        }
+    } else {
+        if (!firstField_) {
+            buffer_ += ',';
+        }
+        buffer_ += '"';
+        buffer_ += name;
+        buffer_ += "\":";
+    }
+    firstField_ = false;
+}
+
+void RecordWriter::field(const char* name, const std::string& value) {
+    beginField(name);
+    if (format_ == OutputFormat::Tsv) {
+        appendTsvValue(value.data(), value.size());
+    } else {
+        appendJsonString(value.data(), value.size());
+    }
+}
+
+void RecordWriter::field(const char* name, const char* value) {
+    beginField(name);
+    size_t len = value ? std::strlen(value) : 0;
+    if (format_ == OutputFormat::Tsv) {
+        appendTsvValue(value, len);
+    } else {
+        appendJsonString(value, len);
+    }
+}
+
+void RecordWriter::field(const char* name, long long value) {
+    beginField(name);
+    char buf[24];
+    auto res = std::to_chars(buf, buf + sizeof(buf), value);
+    buffer_.append(buf, res.ptr);
+}
+
+void RecordWriter::field(const char* name, unsigned long long value) {
+    beginField(name);
+    char buf[24];
+    auto res = std::to_chars(buf, buf + sizeof(buf), value);
+    buffer_.append(buf, res.ptr);
+}
+
+void RecordWriter::field(const char* name, bool value) {
+    beginField(name);
+    buffer_ += value ? "true" : "false";
+}
+
+void RecordWriter::beginObject(const char* name) {
+    if (format_ == OutputFormat::Tsv) {
+        tsvPrefix_ += name;
+        tsvPrefix_ += '.';
+        return;
+    }
+    beginField(name);
+    buffer_ += '{';
+    firstField_ = true;
+}
+
+void RecordWriter::endObject() {
+    if (format_ == OutputFormat::Tsv) {
+        // Drop the innermost "name." component
+        size_t pos = tsvPrefix_.empty() ? std::string::npos : tsvPrefix_.rfind('.', tsvPrefix_.size() - 2);
+        tsvPrefix_.erase(pos == std::string::npos ? 0 : pos + 1);
+        return;
+    }
+    buffer_ += '}';
+    firstField_ = false;
+}
+
+void RecordWriter::endRecord() {
+    switch (format_) {
+        case OutputFormat::Json:
+            buffer_ += '}';
+            break;
+        case OutputFormat::Tsv:
+            buffer_ += '\n';
+            if (!tsvHeaderWritten_) {
+                tsvHeader_ += '\n';
+                buffer_.insert(recordStart_, tsvHeader_);
+                tsvHeaderWritten_ = true;
+            }
+            break;
+        default:
+            buffer_ += "}\n";
+            break;
+    }
+
+    recordCount_++;
+
+    if (buffer_.size() >= bufferSize_) {
+        flush();
+    }
+}
+
+void RecordWriter::flush() {
+    if (!buffer_.empty()) {
+        std::fwrite(buffer_.data(), 1, buffer_.size(), out_);
+        buffer_.clear();
+    }
+    std::fflush(out_);
+}
+
+void RecordWriter::finish() {
+    if (finished_) {
+        return;
+    }
+    finished_ = true;
+
+    if (format_ == OutputFormat::Json) {
+        buffer_ += (recordCount_ == 0) ? "[]\n" : "\n]\n";
+    }
+    flush();
+}
+
+void RecordWriter::appendJsonString(const char* data, size_t len) {
+    static const char hex[] = "0123456789abcdef";
+
+    buffer_ += '"';
+    for (size_t i = 0; i < len; i++) {
+        char c = data[i];
+        switch (c) {
+            case '"':  buffer_ += "\\\""; break;
+            case '\\': buffer_ += "\\\\"; break;
+            case '\n': buffer_ += "\\n"; break;
+            case '\r': buffer_ += "\\r"; break;
+            case '\t': buffer_ += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    buffer_ += "\\u00";
+                    buffer_ += hex[(c >> 4) & 0xf];
+                    buffer_ += hex[c & 0xf];
+                } else {
+                    buffer_ += c;
+                }
+                break;
+        }
+    }
+    buffer_ += '"';
+}
+
+void RecordWriter::appendTsvValue(const char* data, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        char c = data[i];
+        switch (c) {
+            case '\t': buffer_ += "\\t"; break;
+            case '\n': buffer_ += "\\n"; break;
+            case '\r': buffer_ += "\\r"; break;
+            case '\\': buffer_ += "\\\\"; break;
+            default:   buffer_ += c; break;
+        }
+    }
+}
+
+void writeDeviceFields(RecordWriter& writer, const DeviceInfo& device) {
+    writer.field("devPath", device.devPath);
+    writer.field("sysPath", device.sysPath);
+    writer.field("subsystem", device.subsystem);
+    writer.field("vendor", device.vendor);
+    writer.field("vendorId", device.vendorId);
+    writer.field("productId", device.productId);
+    writer.field("serial", device.serial);
+    writer.field("manufacturer", device.manufacturer);
+    writer.field("product", device.product);
+    writer.field("driver", device.driver);
+    writer.field("devNode", device.devNode);
+    writer.field("busNum", device.busNum);
+    writer.field("devNum", device.devNum);
+    writer.field("interfaceNum", device.interfaceNum);
+    writer.field("kernelPath", device.kernelPath);
+}
+
+void writeRuleFields(RecordWriter& writer, const UdevRule& rule, bool isActive) {
+    writer.field("name", rule.name);
+    writer.field("vendorId", rule.vendorId);
+    writer.field("productId", rule.productId);
+    writer.field("serial", rule.serial);
+    writer.field("symlink", rule.symlink);
+    writer.field("filePath", rule.filePath);
+    writer.field("interfaceNum", rule.interfaceNum);
+    writer.field("kernelPath", rule.kernelPath);
+    writer.field("priority", rule.priority);
+    writer.field("isActive", isActive);
+}
+
+} // namespace cli
+} // namespace easytty
@@ -0,0 +1,103 @@
+#include "cli/Commands.hpp"
+#include "common/Histogram.hpp"
+#include "common/Utils.hpp"
+#include "device/DeviceDetector.hpp"
+#include "device/FixtureDeviceSource.hpp"
+#include "device/ReplayEventSource.hpp"
+#include "udev/UdevManager.hpp"
+#include <chrono>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <poll.h>
+
+namespace easytty {
+namespace cli {
+
+int replayCommand(const std::string& path, double speed, OutputFormat format) {
+    try {
+        auto owned = ReplayEventSource::load(path, speed);
+        ReplayEventSource* replay = owned.get();
+
+        // Start from an empty table; the trace alone drives it
+        DeviceDetector detector(std::make_unique<FixtureDeviceSource>(std::vector<DeviceInfo>{}),
+                                std::move(owned));
+        UdevManager manager;
+        if (!detector.startMonitor()) {
+            std::cerr << "Error: Failed to start the replay\n";
+            return 1;
+        }
+
+        utils::installStopHandler();
+
+        // Same per-event work as --watch: table update and rule lookup
+        Histogram latency;
+        size_t managed = 0;
+        auto start = std::chrono::steady_clock::now();
+        struct pollfd pfd = {detector.getMonitorFd(), POLLIN, 0};
+        while (!utils::stopRequested() && !replay->finished()) {
+            int ready = poll(&pfd, 1, 100);
+            if (ready < 0) {
+                if (errno == EINTR) continue;
+                std::cerr << "Error: poll failed: " << std::strerror(errno) << "\n";
+                return 1;
+            }
+
+            while (auto event = detector.receiveEvent()) {
+                managed += manager.getRuleIndex().findForDevice(event->device) != nullptr;
+
+                uint64_t now = std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::system_clock::now().time_since_epoch()).count();
+                latency.record(now > event->timestampUsec ? now - event->timestampUsec : 0);
+            }
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        auto stats = replay->getStats();
+        char speedText[32] = "max";
+        if (speed != ReplayEventSource::MAX_SPEED) {
+            std::snprintf(speedText, sizeof(speedText), "%gx", speed);
+        }
+
+        if (format != OutputFormat::Text) {
+            RecordWriter writer(format);
+            writer.beginRecord();
+            writer.field("trace", path);
+            writer.field("speed", speedText);
+            writer.field("events", static_cast<unsigned long long>(stats.events));
+            writer.field("delivered", static_cast<unsigned long long>(stats.delivered));
+            writer.field("dropped", static_cast<unsigned long long>(stats.dropped));
+            writer.field("maxQueueDepth", static_cast<unsigned long long>(stats.maxQueueDepth));
+            writer.field("queueCapacity", static_cast<unsigned long long>(ReplayEventSource::QUEUE_CAPACITY));
+            writer.field("managedEvents", static_cast<unsigned long long>(managed));
+            writer.field("devicesAtEnd", static_cast<unsigned long long>(detector.getDevices().size()));
+            writer.field("durationUsec", static_cast<unsigned long long>(seconds * 1e6));
+            writer.field("p50Usec", static_cast<unsigned long long>(latency.percentile(0.5)));
+            writer.field("p90Usec", static_cast<unsigned long long>(latency.percentile(0.9)));
+            writer.field("p99Usec", static_cast<unsigned long long>(latency.percentile(0.99)));
+            writer.field("maxUsec", static_cast<unsigned long long>(latency.max()));
+            writer.endRecord();
+            writer.finish();
+        } else {
+            std::printf("Replayed %llu of %llu events from %s at %s speed in %.2f s (%.0f events/s)\n",
+                        static_cast<unsigned long long>(stats.queued), static_cast<unsigned long long>(stats.events),
+                        path.c_str(), speedText, seconds, seconds > 0 ? stats.delivered / seconds : 0.0);
+            std::printf("  delivered    %llu (%zu named by a rule)\n",
+                        static_cast<unsigned long long>(stats.delivered), managed);
+            std::printf("  dropped      %llu\n", static_cast<unsigned long long>(stats.dropped));
+            std::printf("  queue depth  max %zu of %zu\n", stats.maxQueueDepth, ReplayEventSource::QUEUE_CAPACITY);
+            std::printf("  latency ms   p50 %.3f  p90 %.3f  p99 %.3f  max %.3f\n",
+                        latency.percentile(0.5) / 1000.0, latency.percentile(0.9) / 1000.0,
+                        latency.percentile(0.99) / 1000.0, latency.max() / 1000.0);
+            std::printf("  devices      %zu connected at the end\n", detector.getDevices().size());
+        }
+        return stats.dropped ? 2 : 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+}
+
+} // namespace cli
+} // namespace easytty
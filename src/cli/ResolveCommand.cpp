@@ -0,0 +1,116 @@
+#include "cli/Commands.hpp"
+#include "common/Utils.hpp"
+#include "device/DeviceDetector.hpp"
+#include "device/DeviceIndex.hpp"
+#include "udev/UdevManager.hpp"
+#include <iostream>
+
+namespace easytty {
+namespace cli {
+
+namespace {
+
+void printRecordText(const std::string& query, const DeviceRecord& record, LinkStatus status) {
+    std::string text = query + ": " + toString(status) + "\n";
+    
+    if (record.rule) {
+        text += "  Symlink: /dev/" + record.rule->symlink + "\n";
+    }
+    if (record.device) {
+        const DeviceInfo& dev = *record.device;
+        text += "  Device:  " + dev.devPath + " [" + dev.vendorId + ":" + dev.productId + "]";
+        if (!dev.product.empty()) {
+            text += " " + dev.product;
+        }
+        text += "\n";
+        text += "  Serial:  " + (dev.serial.empty() ? std::string("(none)") : dev.serial) + "\n";
+        if (!dev.kernelPath.empty()) {
+            text += "  USB Port: " + dev.kernelPath + "\n";
+        }
+    } else {
+        text += "  Device:  (not connected)\n";
+    }
+    if (record.rule) {
+        text += "  Rule:    " + record.rule->filePath + "\n";
+    }
+    
+    std::fwrite(text.data(), 1, text.size(), stdout);
+}
+
+} // namespace
+
+int resolveCommand(const std::vector<std::string>& queries, OutputFormat format) {
+    try {
+        DeviceDetector detector;
+        UdevManager manager;
+        
+        DeviceIndex index;
+        index.build(detector.scanDevices(), manager.getExistingRules());
+        
+        std::optional<RecordWriter> writer;
+        if (format != OutputFormat::Text) {
+            writer.emplace(format);
+        }
+        
+        int exitCode = 0;
+        auto answer = [&](const std::string& query) {
+            auto records = index.resolve(query);
+            if (records.empty()) {
+                std::cerr << query << ": not found\n";
+                exitCode = 1;
+                return;
+            }
+            
+            for (const auto& record : records) {
+                LinkStatus status = index.linkStatus(record);
+                if (!writer) {
+                    printRecordText(query, record, status);
+                    continue;
+                }
+                
+                writer->beginRecord();
+                writer->field("query", query);
+                writer->field("status", toString(status));
+                writer->beginObject("device");
+                writeDeviceFields(*writer, record.device ? *record.device : DeviceInfo{});
+                writer->endObject();
+                writer->beginObject("rule");
+                writeRuleFields(*writer, record.rule ? *record.rule : UdevRule{},
+                                status == LinkStatus::Active);
+                writer->endObject();
+                writer->endRecord();
+            }
+        };
+        
+        for (const auto& query : queries) {
+            if (query != "-") {
+                answer(query);
+                continue;
+            }
+            
+            // One query per line; answer as we go so pipes stay interactive
+            std::string line;
+            while (std::getline(std::cin, line)) {
+                line = utils::trim(line);
+                if (line.empty()) continue;
+                answer(line);
+                if (writer) {
+                    writer->flush();
+                } else {
+                    std::fflush(stdout);
+                }
+            }
+        }
+        
+        if (writer) {
+            writer->finish();
+        }
+        return exitCode;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+}
+
+} // namespace cli
+} // namespace easytty
@@ -0,0 +1,44 @@
+#include "cli/Commands.hpp"
+#include "device/SysfsDeviceSource.hpp"
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <iostream>
+
+namespace easytty {
+namespace cli {
+
+int snapshotCommand(const std::string& path) {
+    bool toStdout = path == "-";
+    std::FILE* out = toStdout ? stdout : std::fopen(path.c_str(), "wb");
+    if (!out) {
+        std::cerr << "Error: Cannot open " << path << ": " << std::strerror(errno) << "\n";
+        return 1;
+    }
+
+    OperationResult result = OperationResult::Failure("");
+    try {
+        result = SysfsDeviceSource::captureSnapshot(out);
+    } catch (const std::exception& e) {
+        result = OperationResult::Failure(e.what());
+    }
+
+    if ((toStdout ? std::fflush(out) : std::fclose(out)) != 0 && result.success) {
+        result = OperationResult::Failure("Cannot write " + path + ": " + std::strerror(errno));
+    }
+    if (!result.success) {
+        std::cerr << "Error: " << result.message << "\n";
+        if (!toStdout) {
+            std::remove(path.c_str());
+        }
+        return 1;
+    }
+
+    if (!toStdout) {
+        std::cerr << result.message << " to " << path << "\n";
+    }
+    return 0;
+}
+
+} // namespace cli
+} // namespace easytty
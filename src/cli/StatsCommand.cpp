@@ -0,0 +1,78 @@
+#include "cli/Commands.hpp"
+#include "common/AllocStats.hpp"
+#include "device/DeviceDetector.hpp"
+#include "udev/UdevManager.hpp"
+#include <cstdio>
+#include <iostream>
+
+namespace easytty {
+namespace cli {
+
+namespace {
+
+// Refreshes after the cold one; the last is reported as "warm"
+constexpr int WARM_REFRESHES = 3;
+
+const alloc::Phase PHASES[] = {alloc::Phase::ScanDevices, alloc::Phase::LoadRules};
+
+} // namespace
+
+int statsCommand(OutputFormat format) {
+    if (!alloc::ENABLED) {
+        std::cerr << "Error: Allocation accounting is not compiled in "
+                  << "(configure with -DEASYTTY_ALLOC_STATS=ON)\n";
+        return 1;
+    }
+
+    try {
+        DeviceDetector detector;
+        UdevManager manager;   // Loads the rules: the cold rule load
+
+        detector.scanDevices();
+        alloc::PhaseStats cold[2] = {alloc::getStats(PHASES[0]), alloc::getStats(PHASES[1])};
+
+        for (int i = 0; i < WARM_REFRESHES; i++) {
+            detector.scanDevices();
+            manager.refresh();
+        }
+
+        if (format != OutputFormat::Text) {
+            RecordWriter writer(format);
+            for (size_t i = 0; i < 2; i++) {
+                alloc::PhaseStats warm = alloc::getStats(PHASES[i]);
+                writer.beginRecord();
+                writer.field("phase", alloc::phaseName(PHASES[i]));
+                writer.field("calls", static_cast<unsigned long long>(warm.calls));
+                writer.field("coldAllocations", static_cast<unsigned long long>(cold[i].lastAllocations));
+                writer.field("coldBytes", static_cast<unsigned long long>(cold[i].lastBytes));
+                writer.field("warmAllocations", static_cast<unsigned long long>(warm.lastAllocations));
+                writer.field("warmBytes", static_cast<unsigned long long>(warm.lastBytes));
+                writer.field("totalAllocations", static_cast<unsigned long long>(warm.allocations));
+                writer.field("totalBytes", static_cast<unsigned long long>(warm.bytes));
+                writer.endRecord();
+            }
+            writer.finish();
+            return 0;
+        }
+
+        std::printf("Heap allocations per call (%zu devices, %zu rules)\n\n",
+                    detector.getDevices().size(), manager.getExistingRules().size());
+        std::printf("%-18s %6s %10s %12s %10s %12s\n", "PHASE", "CALLS", "COLD", "COLD BYTES", "WARM", "WARM BYTES");
+        for (size_t i = 0; i < 2; i++) {
+            alloc::PhaseStats warm = alloc::getStats(PHASES[i]);
+            std::printf("%-18s %6llu %10llu %12llu %10llu %12llu\n", alloc::phaseName(PHASES[i]),
+                        static_cast<unsigned long long>(warm.calls),
+                        static_cast<unsigned long long>(cold[i].lastAllocations),
+                        static_cast<unsigned long long>(cold[i].lastBytes),
+                        static_cast<unsigned long long>(warm.lastAllocations),
+                        static_cast<unsigned long long>(warm.lastBytes));
+        }
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+}
+
+} // namespace cli
+} // namespace easytty
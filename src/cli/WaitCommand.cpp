@@ -0,0 +1,170 @@
+#include "cli/Commands.hpp"
+#include "common/Utils.hpp"
+#include "device/DeviceDetector.hpp"
+#include "udev/UdevManager.hpp"
+#include <algorithm>
+#include <iostream>
+#include <chrono>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+namespace easytty {
+namespace cli {
+
+namespace {
+
+enum class NameState {
+    Missing,        // /dev/<name> does not exist yet
+    Settling,       // /dev/<name> exists but its device cannot be read yet
+    WrongDevice,    // /dev/<name> exists but the device does not match its rule
+    Ready
+};
+
+struct WaitTarget {
+    std::string name;
+    UdevRule rule;
+    NameState state;
+    std::string target;     // Device node the symlink resolves to
+};
+
+NameState checkTarget(WaitTarget& wait, DeviceDetector& detector) {
+    char resolved[PATH_MAX];
+    std::string link = "/dev/" + wait.name;
+    if (!realpath(link.c_str(), resolved)) {
+        wait.target.clear();
+        return NameState::Missing;
+    }
+    wait.target = resolved;
+
+    // The monitor keeps the table current; fall back to sysfs for
+    // devices whose add event has not been received yet
+    for (const auto& dev : detector.getDevices()) {
+        if (dev.devPath == wait.target) {
+            return wait.rule.matchesDevice(dev) ? NameState::Ready : NameState::WrongDevice;
+        }
+    }
+    auto dev = detector.getDeviceInfo(wait.target);
+    if (!dev) {
+        // udev may still be settling the node; not a mismatch, keep waiting
+        return NameState::Settling;
+    }
+    return wait.rule.matchesDevice(*dev) ? NameState::Ready : NameState::WrongDevice;
+}
+
+} // namespace
+
+int waitCommand(const std::vector<std::string>& names, double timeoutSeconds) {
+    try {
+        DeviceDetector detector;
+        UdevManager manager;
+
+        std::vector<WaitTarget> targets;
+        for (const auto& name : names) {
+            const UdevRule* rule = manager.getRuleIndex().findBySymlink(name);
+            if (!rule) {
+                std::cerr << "Error: No EasyTTY rule for /dev/" << name << "\n";
+                return WAIT_ERROR;
+            }
+            targets.push_back({name, *rule, NameState::Missing, ""});
+        }
+
+        // Subscribe before the first check so no event can slip in between
+        int inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (inotifyFd < 0 ||
+            inotify_add_watch(inotifyFd, "/dev", IN_CREATE | IN_MOVED_TO | IN_DELETE | IN_MOVED_FROM) < 0) {
+            std::cerr << "Error: Failed to watch /dev: " << std::strerror(errno) << "\n";
+            if (inotifyFd >= 0) close(inotifyFd);
+            return WAIT_ERROR;
+        }
+        bool monitoring = detector.startMonitor();
+        detector.scanDevices();
+
+        utils::installStopHandler();
+
+        // Checked before the conversion: it is undefined for values a long long cannot hold
+        if (!(timeoutSeconds <= WAIT_MAX_SECONDS)) {
+            timeoutSeconds = -1;
+        }
+        auto deadline = std::chrono::steady_clock::now() +
+                        std::chrono::microseconds(static_cast<long long>(std::max(timeoutSeconds, 0.0) * 1e6));
+
+        struct pollfd fds[2];
+        fds[0] = {inotifyFd, POLLIN, 0};
+        fds[1] = {detector.getMonitorFd(), POLLIN, 0};
+        nfds_t nfds = monitoring ? 2 : 1;
+
+        int exitCode = WAIT_TIMEOUT;
+        while (!utils::stopRequested()) {
+            bool allReady = true;
+            for (auto& target : targets) {
+                target.state = checkTarget(target, detector);
+                allReady = allReady && target.state == NameState::Ready;
+            }
+            if (allReady) {
+                exitCode = WAIT_READY;
+                break;
+            }
+
+            int timeoutMs = -1;
+            if (timeoutSeconds >= 0) {
+                auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    deadline - std::chrono::steady_clock::now()).count();
+                if (remaining <= 0) break;
+                timeoutMs = static_cast<int>(std::min<long long>(remaining, INT_MAX));
+            }
+
+            int ready = poll(fds, nfds, timeoutMs);
+            if (ready < 0) {
+                if (errno == EINTR) continue;
+                std::cerr << "Error: poll failed: " << std::strerror(errno) << "\n";
+                exitCode = WAIT_ERROR;
+                break;
+            }
+
+            if (fds[0].revents & POLLIN) {
+                char buffer[4096];
+                while (read(inotifyFd, buffer, sizeof(buffer)) > 0) {}
+            }
+            if (nfds > 1 && (fds[1].revents & POLLIN)) {
+                while (detector.receiveEvent()) {}
+            }
+        }
+
+        close(inotifyFd);
+
+        if (exitCode == WAIT_READY) {
+            for (const auto& target : targets) {
+                std::cout << "/dev/" << target.name << " -> " << target.target << "\n";
+            }
+            return WAIT_READY;
+        }
+        if (exitCode == WAIT_ERROR) {
+            return exitCode;
+        }
+
+        // Timed out (or interrupted): report what is still outstanding
+        for (const auto& target : targets) {
+            if (target.state == NameState::Missing) {
+                std::cerr << "Timeout: /dev/" << target.name << " does not exist\n";
+            } else if (target.state == NameState::Settling) {
+                std::cerr << "Timeout: /dev/" << target.name << " -> " << target.target
+                          << " exists but its device could not be read\n";
+            } else if (target.state == NameState::WrongDevice) {
+                std::cerr << "Mismatch: /dev/" << target.name << " -> " << target.target
+                          << " does not match its rule\n";
+                exitCode = WAIT_WRONG_DEVICE;
+            }
+        }
+        return exitCode;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return WAIT_ERROR;
+    }
+}
+
+} // namespace cli
+} // namespace easytty
@@ -0,0 +1,463 @@
+#include "cli/Commands.hpp"
+#include "cli/MetricsExporter.hpp"
+#include "common/Utils.hpp"
+#include "device/DeviceDetector.hpp"
+#include "device/DeviceInventory.hpp"
+#include "device/EventLog.hpp"
+#include "device/FlapDetector.hpp"
+#include "device/HookDispatcher.hpp"
+#include "device/LatencyTracker.hpp"
+#include "udev/NamingPolicy.hpp"
+#include "udev/UdevManager.hpp"
+#include <iostream>
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+namespace easytty {
+namespace cli {
+
+namespace {
+
+uint64_t nowUsec() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+void printDeviceLine(uint64_t timestampUsec, const char* label, const DeviceInfo& dev,
+                     const UdevRule* rule, const std::string& note = {}) {
+    std::string line = utils::formatTimestampUsec(timestampUsec);
+    line += ' ';
+    line += label;
+    line.append(8 - std::min<size_t>(7, std::strlen(label)), ' ');
+    line += dev.devPath;
+
+    if (!dev.vendorId.empty()) {
+        line += " [" + dev.vendorId + ":" + dev.productId;
+        if (!dev.serial.empty()) {
+            line += " S:" + dev.serial;
+        } else if (!dev.kernelPath.empty()) {
+            line += " Port:" + dev.kernelPath;
+        }
+        line += "]";
+    }
+    if (rule) {
+        line += " -> /dev/" + rule->symlink;
+    }
+    line += note;
+    line += '\n';
+
+    // One write per event so consumers see complete lines immediately
+    std::fwrite(line.data(), 1, line.size(), stdout);
+    std::fflush(stdout);
+}
+
+void printEventText(const DeviceEvent& event, const UdevRule* rule) {
+    printDeviceLine(event.timestampUsec, toString(event.action), event.device, rule);
+}
+
+void printFlapText(uint64_t timestampUsec, bool flapping, const FlapDetector::State& state,
+                   const FlapDetector::Options& options, const UdevRule* rule) {
+    char note[128];
+    if (flapping) {
+        std::snprintf(note, sizeof(note), " (%zu attach/detach in %llus, quiet for %llus to clear)",
+                      state.recent.size(), static_cast<unsigned long long>(options.windowUsec / 1000000),
+                      static_cast<unsigned long long>((state.holdUntilUsec - timestampUsec) / 1000000));
+    } else {
+        std::snprintf(note, sizeof(note), " (%llu events hidden)",
+                      static_cast<unsigned long long>(state.suppressed));
+    }
+    printDeviceLine(timestampUsec, flapping ? "flap" : "stable", state.device, rule, note);
+}
+
+void writeEventRecord(RecordWriter& writer, const DeviceEvent& event,
+                      const UdevRule* rule, bool isActive) {
+    writer.beginRecord();
+    writer.field("action", toString(event.action));
+    writer.field("seqnum", static_cast<unsigned long long>(event.seqnum));
+    writer.field("timestamp", static_cast<unsigned long long>(event.timestampUsec));
+    writer.field("usecInitialized", static_cast<unsigned long long>(event.initializedUsec));
+    writer.field("symlink", rule ? "/dev/" + rule->symlink : std::string());
+    writer.beginObject("device");
+    writeDeviceFields(writer, event.device);
+    writer.endObject();
+    writer.beginObject("rule");
+    writeRuleFields(writer, rule ? *rule : UdevRule{}, isActive);
+    writer.endObject();
+    writer.endRecord();
+    writer.flush();
+}
+
+void writeFlapRecord(RecordWriter& writer, uint64_t timestampUsec, bool flapping,
+                     const FlapDetector::State& state) {
+    writer.beginRecord();
+    writer.field("action", flapping ? "flapping" : "stable");
+    writer.field("timestamp", static_cast<unsigned long long>(timestampUsec));
+    writer.field("transitions", static_cast<unsigned long long>(state.recent.size()));
+    writer.field("suppressed", static_cast<unsigned long long>(state.suppressed));
+    writer.field("holdUntil", static_cast<unsigned long long>(flapping ? state.holdUntilUsec : 0));
+    writer.beginObject("device");
+    writeDeviceFields(writer, state.device);
+    writer.endObject();
+    writer.endRecord();
+    writer.flush();
+}
+
+void writeNamedRecord(RecordWriter& writer, uint64_t timestampUsec, const NameAssignment& assignment) {
+    writer.beginRecord();
+    writer.field("action", "named");
+    writer.field("timestamp", static_cast<unsigned long long>(timestampUsec));
+    writer.field("symlink", "/dev/" + assignment.symlinkName);
+    writer.field("policyLine", assignment.policyLine);
+    writer.beginObject("device");
+    writeDeviceFields(writer, assignment.device);
+    writer.endObject();
+    writer.endRecord();
+    writer.flush();
+}
+
+// Hook results go to stderr so they never interleave with records on stdout
+void printHookResult(const HookDispatcher::Result& result) {
+    const HookDispatcher::Hook& hook = *result.hook;
+    std::string line = utils::formatTimestampUsec(nowUsec()) + " hook    line " + std::to_string(hook.line) + " ";
+    line += hook.type == HookDispatcher::ActionType::Exec ? "exec " + hook.argv[0] : "socket " + hook.socketPath;
+    line += std::string(" on ") + toString(result.event.action) + " " + result.event.device.devPath;
+    if (!result.symlink.empty()) {
+        line += " -> /dev/" + result.symlink;
+    }
+    line += ": " + (result.success ? std::string("ok") : result.message);
+    line += " in " + std::to_string(result.duration.count()) + " ms";
+    if (result.superseded > 0) {
+        line += " (" + std::to_string(result.superseded) + " earlier events debounced)";
+    }
+    line += '\n';
+    std::fwrite(line.data(), 1, line.size(), stderr);
+}
+
+} // namespace
+
+int watchCommand(OutputFormat format, const Filter& filter, const WatchOptions& options) {
+    try {
+        DeviceDetector detector;
+        UdevManager manager;
+
+        std::optional<NamingPolicy> policy;
+        if (!options.policyPath.empty()) {
+            std::string error;
+            policy = NamingPolicy::load(options.policyPath, error);
+            if (!policy) {
+                std::cerr << "Error: " << error << "\n";
+                return 1;
+            }
+        }
+
+        std::optional<HookDispatcher> hooks;
+        if (!options.hooksPath.empty()) {
+            std::string error;
+            auto loaded = HookDispatcher::load(options.hooksPath, error);
+            if (!loaded) {
+                std::cerr << "Error: " << error << "\n";
+                return 1;
+            }
+            hooks.emplace(std::move(*loaded), HookDispatcher::Options{}, printHookResult);
+        }
+
+        if (!detector.startMonitor()) {
+            std::cerr << "Error: Failed to start udev monitor\n";
+            return 1;
+        }
+        // Seed the device table so detach events carry full records
+        detector.scanDevices();
+
+        // Fixtures and replayed traces must not leave real rules, hook
+        // runs or history behind
+        bool live = detector.getSource().isLive() && detector.getEventSource()->isLive();
+        if (!live && (policy || hooks)) {
+            std::cerr << "Error: " << (policy ? "--auto-name" : "--hooks") << " needs live devices and events (not "
+                      << detector.getSource().name() << " / " << detector.getEventSource()->name() << ")\n";
+            return 1;
+        }
+
+        // Keep the inventory's last-seen times current for --gc; a
+        // detached device was there until the moment it left
+        DeviceInventory inventory;
+        bool trackInventory = live;
+        auto saveInventory = [&]() {
+            if (!inventory.takeChanged()) return;
+            auto result = inventory.save();
+            if (!result.success) {
+                std::cerr << "Warning: Device inventory not saved: " << result.message << "\n";
+                trackInventory = false;
+            }
+        };
+        if (trackInventory) {
+            inventory.load();
+            inventory.observe(detector.getDevices(), nowUsec() / 1000000);
+            saveInventory();
+        }
+
+        // Pick up rule changes made while we are running
+        int inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (inotifyFd >= 0) {
+            inotify_add_watch(inotifyFd, manager.getRulesDir().c_str(),
+                              IN_CLOSE_WRITE | IN_DELETE | IN_MOVED_TO | IN_MOVED_FROM);
+        }
+
+        if (format == OutputFormat::Json) {
+            format = OutputFormat::Ndjson;
+        }
+        std::optional<RecordWriter> writer;
+        if (format != OutputFormat::Text) {
+            writer.emplace(format);
+        }
+
+        // Metrics are rendered from the tables the monitor keeps current
+        std::optional<MetricsExporter> metrics;
+        auto publishMetrics = [&]() {
+            if (!metrics) return;
+            auto result = metrics->write(detector, manager);
+            if (!result.success) {
+                std::cerr << "Warning: " << result.message << "\n";
+            }
+        };
+
+        // Attach latency accumulates across restarts in the state file
+        std::optional<LatencyTracker> latency;
+        if (options.latency) {
+            latency.emplace();
+            latency->load();
+        }
+
+        if (!options.metricsPath.empty()) {
+            metrics.emplace(options.metricsPath, options.portCounters, true);
+            if (latency) {
+                metrics->setLatencyTracker(&*latency);
+            }
+            publishMetrics();
+        }
+
+        // History for --history; watching goes on without it
+        EventLog history;
+        if (options.history && live) {
+            auto result = history.open();
+            if (!result.success) {
+                std::cerr << "Warning: Event history disabled: " << result.message << "\n";
+            }
+        }
+
+        // Coalesced bursts refresh the metrics once, when they are over
+        bool coalesce = options.coalesceMs > 0;
+        if (coalesce) {
+            detector.setCoalesceWindow(std::chrono::milliseconds(options.coalesceMs));
+        }
+        FlapDetector flaps;
+
+        auto reportFlap = [&](const DeviceInfo& device, bool flapping, uint64_t timestampUsec) {
+            const FlapDetector::State* state = flaps.find(device);
+            if (!state || !filter.matches(state->device)) return;
+            if (writer) {
+                writeFlapRecord(*writer, timestampUsec, flapping, *state);
+            } else {
+                printFlapText(timestampUsec, flapping, *state, flaps.getOptions(),
+                              manager.getRuleIndex().findForDevice(state->device));
+            }
+        };
+
+        auto reportEvent = [&](const DeviceEvent& event) {
+            if (!filter.matches(event.device)) return;
+            const UdevRule* rule = manager.getRuleIndex().findForDevice(event.device);
+            if (writer) {
+                bool isActive = rule && manager.verifySymlink(rule->symlink);
+                writeEventRecord(*writer, event, rule, isActive);
+            } else if (!flaps.isFlapping(event.device)) {
+                printEventText(event, rule);
+            }
+        };
+
+        // Name attached devices by the policy, one reload per event or burst
+        auto nameDevices = [&](const std::vector<DeviceInfo>& attached) {
+            if (!policy || attached.empty()) return;
+            RuleIndex pending = manager.getRuleIndex();
+            std::vector<std::string> errors;
+            auto assignments = planNames(*policy, attached, manager, pending, errors);
+            std::string error;
+            size_t created = applyNames(manager, assignments, error);
+            if (!error.empty()) {
+                errors.push_back(error);
+            }
+
+            uint64_t now = nowUsec();
+            for (size_t i = 0; i < created; i++) {
+                if (writer) {
+                    writeNamedRecord(*writer, now, assignments[i]);
+                } else {
+                    printDeviceLine(now, "named", assignments[i].device,
+                                    manager.getRuleIndex().findBySymlink(assignments[i].symlinkName),
+                                    " (policy line " + std::to_string(assignments[i].policyLine) + ")");
+                }
+            }
+            for (const auto& problem : errors) {
+                std::cerr << "Warning: " << problem << "\n";
+            }
+            if (created > 0) {
+                publishMetrics();
+            }
+        };
+
+        // Hooks see the rule as it is after naming
+        auto dispatchHooks = [&](const DeviceEvent& event) {
+            if (hooks) {
+                hooks->submit(event, manager.getRuleIndex().findForDevice(event.device));
+            }
+        };
+
+        utils::installStopHandler();
+
+        struct pollfd fds[2];
+        fds[0] = {detector.getMonitorFd(), POLLIN, 0};
+        fds[1] = {inotifyFd, POLLIN, 0};
+        nfds_t nfds = inotifyFd >= 0 ? 2 : 1;
+
+        while (!utils::stopRequested()) {
+            int timeout = -1;
+            for (int candidate : {latency ? latency->nextTimeoutMs() : -1, detector.burstTimeoutMs(),
+                                  flaps.nextTimeoutMs(nowUsec())}) {
+                if (candidate >= 0 && (timeout < 0 || candidate < timeout)) {
+                    timeout = candidate;
+                }
+            }
+
+            int ready = poll(fds, nfds, timeout);
+            if (ready < 0) {
+                if (errno == EINTR) continue;
+                std::cerr << "Error: poll failed: " << std::strerror(errno) << "\n";
+                break;
+            }
+
+            if (nfds > 1 && (fds[1].revents & POLLIN)) {
+                char buffer[4096];
+                while (read(inotifyFd, buffer, sizeof(buffer)) > 0) {}
+                manager.refresh();
+                publishMetrics();
+            }
+
+            auto event = (fds[0].revents & POLLIN) ? detector.receiveEvent() : std::nullopt;
+            if (event) {
+                const UdevRule* rule = manager.getRuleIndex().findForDevice(event->device);
+                history.append(*event, rule);
+                if (trackInventory) {
+                    inventory.observe(event->device, event->timestampUsec / 1000000);
+                    saveInventory();
+                }
+                if (latency) {
+                    latency->onEvent(*event, rule);
+                }
+                if (metrics) {
+                    metrics->countEvent(event->action);
+                    if (!coalesce) {
+                        publishMetrics();
+                    }
+                }
+
+                auto transition = flaps.record(*event);
+                if (transition == FlapDetector::Transition::Stopped) {
+                    reportFlap(event->device, false, event->timestampUsec);
+                }
+                if (!coalesce) {
+                    reportEvent(*event);
+                    if (event->action == DeviceAction::Add) {
+                        nameDevices({event->device});
+                    }
+                    dispatchHooks(*event);
+                }
+                if (transition == FlapDetector::Transition::Started) {
+                    reportFlap(event->device, true, event->timestampUsec);
+                }
+            }
+
+            uint64_t now = nowUsec();
+            for (const auto& device : flaps.expire(now)) {
+                reportFlap(device, false, now);
+            }
+
+            if (auto diff = detector.takeBurst()) {
+                publishMetrics();
+                // Text leaves out flapping devices; skip bursts made only of them
+                bool visible = false;
+                for (const auto* devices : {&diff->added, &diff->removed, &diff->changed}) {
+                    visible |= std::any_of(devices->begin(), devices->end(), [&](const DeviceInfo& device) {
+                        return filter.matches(device) && !flaps.isFlapping(device);
+                    });
+                }
+                if (!writer && visible) {
+                    std::printf("%s burst   %zu events: %zu added, %zu removed, %zu changed\n",
+                                utils::formatTimestampUsec(now).c_str(), diff->events,
+                                diff->added.size(), diff->removed.size(), diff->changed.size());
+                    std::fflush(stdout);
+                }
+                auto reportDiff = [&](const std::vector<DeviceInfo>& devices, DeviceAction action) {
+                    for (const auto& device : devices) {
+                        reportEvent(DeviceEvent{action, device, 0, now, 0});
+                    }
+                };
+                reportDiff(diff->removed, DeviceAction::Remove);
+                reportDiff(diff->added, DeviceAction::Add);
+                reportDiff(diff->changed, DeviceAction::Change);
+
+                // A device swapped for another between two events shows up as changed
+                std::vector<DeviceInfo> attached = diff->added;
+                attached.insert(attached.end(), diff->changed.begin(), diff->changed.end());
+                nameDevices(attached);
+
+                for (const auto& device : diff->removed) {
+                    dispatchHooks(DeviceEvent{DeviceAction::Remove, device, 0, now, 0});
+                }
+                for (const auto& device : diff->added) {
+                    dispatchHooks(DeviceEvent{DeviceAction::Add, device, 0, now, 0});
+                }
+                for (const auto& device : diff->changed) {
+                    dispatchHooks(DeviceEvent{DeviceAction::Change, device, 0, now, 0});
+                }
+            }
+
+            if (latency) {
+                latency->update();
+                if (latency->takeChanged()) {
+                    auto result = latency->save();
+                    if (!result.success) {
+                        std::cerr << "Warning: " << result.message << "\n";
+                    }
+                    publishMetrics();
+                }
+            }
+        }
+
+        if (inotifyFd >= 0) {
+            close(inotifyFd);
+        }
+        if (hooks) {
+            // Runs still waiting out their debounce are dropped, running ones finish
+            hooks->shutdown();
+            auto stats = hooks->getStats();
+            std::fprintf(stderr, "Hooks: %llu succeeded, %llu failed (%llu timed out), "
+                         "%llu debounced, %llu dropped\n",
+                         static_cast<unsigned long long>(stats.succeeded),
+                         static_cast<unsigned long long>(stats.failed),
+                         static_cast<unsigned long long>(stats.timedOut),
+                         static_cast<unsigned long long>(stats.superseded),
+                         static_cast<unsigned long long>(stats.dropped));
+        }
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+}
+
+} // namespace cli
+} // namespace easytty
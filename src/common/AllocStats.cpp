@@ -0,0 +1,163 @@
+#include "common/AllocStats.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+namespace easytty {
+namespace alloc {
+
+namespace {
+
+const char* const PHASE_NAMES[] = {"other", "scanDevices", "loadExistingRules", "menuRebuild", "render"};
+static_assert(sizeof(PHASE_NAMES) / sizeof(PHASE_NAMES[0]) == static_cast<size_t>(Phase::Count),
+              "PHASE_NAMES out of sync with Phase");
+
+#ifdef EASYTTY_ALLOC_STATS
+// Plain atomics with constant initialization: operator new may run
+// before any dynamic initializer
+struct Counters {
+    std::atomic<uint64_t> calls{0};
+    std::atomic<uint64_t> allocations{0};
+    std::atomic<uint64_t> bytes{0};
+    std::atomic<uint64_t> lastAllocations{0};
+    std::atomic<uint64_t> lastBytes{0};
+};
+
+Counters gCounters[static_cast<size_t>(Phase::Count)];
+thread_local Phase tCurrent = Phase::Other;
+
+inline void count(std::size_t size) {
+    Counters& counters = gCounters[static_cast<size_t>(tCurrent)];
+    counters.allocations.fetch_add(1, std::memory_order_relaxed);
+    counters.bytes.fetch_add(size, std::memory_order_relaxed);
+}
+
+void* allocate(std::size_t size) {
+    count(size);
+    for (;;) {
+        if (void* p = std::malloc(size ? size : 1)) {
+            return p;
+        }
+        std::new_handler handler = std::get_new_handler();
+        if (!handler) {
+            throw std::bad_alloc();
+        }
+        handler();
+    }
+}
+
+void* allocateAligned(std::size_t size, std::align_val_t alignment) {
+    count(size);
+    std::size_t align = static_cast<std::size_t>(alignment);
+    for (;;) {
+        void* p = nullptr;
+        if (posix_memalign(&p, align < sizeof(void*) ? sizeof(void*) : align, size ? size : 1) == 0) {
+            return p;
+        }
+        std::new_handler handler = std::get_new_handler();
+        if (!handler) {
+            throw std::bad_alloc();
+        }
+        handler();
+    }
+}
+#endif
+
+} // namespace
+
+const char* phaseName(Phase phase) {
+    return PHASE_NAMES[static_cast<size_t>(phase)];
+}
+
+#ifdef EASYTTY_ALLOC_STATS
+PhaseStats getStats(Phase phase) {
+    const Counters& counters = gCounters[static_cast<size_t>(phase)];
+    PhaseStats stats;
+    stats.calls = counters.calls.load(std::memory_order_relaxed);
+    stats.allocations = counters.allocations.load(std::memory_order_relaxed);
+    stats.bytes = counters.bytes.load(std::memory_order_relaxed);
+    stats.lastAllocations = counters.lastAllocations.load(std::memory_order_relaxed);
+    stats.lastBytes = counters.lastBytes.load(std::memory_order_relaxed);
+    return stats;
+}
+
+PhaseScope::PhaseScope(Phase phase)
+    : phase_(phase), previous_(tCurrent), active_(true) {
+    Counters& counters = gCounters[static_cast<size_t>(phase)];
+    counters.calls.fetch_add(1, std::memory_order_relaxed);
+    startAllocations_ = counters.allocations.load(std::memory_order_relaxed);
+    startBytes_ = counters.bytes.load(std::memory_order_relaxed);
+    tCurrent = phase;
+}
+
+void PhaseScope::end() {
+    if (!active_) {
+        return;
+    }
+    active_ = false;
+    tCurrent = previous_;
+
+    Counters& counters = gCounters[static_cast<size_t>(phase_)];
+    counters.lastAllocations.store(counters.allocations.load(std::memory_order_relaxed) - startAllocations_,
+                                   std::memory_order_relaxed);
+    counters.lastBytes.store(counters.bytes.load(std::memory_order_relaxed) - startBytes_,
+                             std::memory_order_relaxed);
+}
+#else
+PhaseStats getStats(Phase) {
+    return {};
+}
+#endif
+
+} // namespace alloc
+} // namespace easytty
+
+#ifdef EASYTTY_ALLOC_STATS
+// Replacements of the global allocation functions. They live in the same
+// object file as PhaseScope, which every instrumented path references, so
+// the linker always pulls them in from the static library.
+
+void* operator new(std::size_t size) {
+    return easytty::alloc::allocate(size);
+}
+
+void* operator new[](std::size_t size) {
+    return easytty::alloc::allocate(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    try {
+        return easytty::alloc::allocate(size);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    try {
+        return easytty::alloc::allocate(size);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    return easytty::alloc::allocateAligned(size, alignment);
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+    return easytty::alloc::allocateAligned(size, alignment);
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+#endif
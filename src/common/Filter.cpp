@@ -0,0 +1,395 @@
+#include "common/Filter.hpp"
+#include <cctype>
+#include <cstring>
+#include <strings.h>
+
+namespace easytty {
+
+namespace {
+
+struct FieldName {
+    const char* name;
+    Filter::Field field;
+};
+
+const FieldName FIELD_NAMES[] = {
+    {"devPath", Filter::Field::DevPath},
+    {"dev", Filter::Field::DevPath},
+    {"sysPath", Filter::Field::SysPath},
+    {"subsystem", Filter::Field::Subsystem},
+    {"vendor", Filter::Field::Vendor},
+    {"vendorId", Filter::Field::VendorId},
+    {"vid", Filter::Field::VendorId},
+    {"productId", Filter::Field::ProductId},
+    {"pid", Filter::Field::ProductId},
+    {"serial", Filter::Field::Serial},
+    {"manufacturer", Filter::Field::Manufacturer},
+    {"product", Filter::Field::Product},
+    {"driver", Filter::Field::Driver},
+    {"devNode", Filter::Field::DevNode},
+    {"node", Filter::Field::DevNode},
+    {"busNum", Filter::Field::BusNum},
+    {"devNum", Filter::Field::DevNum},
+    {"interfaceNum", Filter::Field::InterfaceNum},
+    {"iface", Filter::Field::InterfaceNum},
+    {"kernelPath", Filter::Field::KernelPath},
+    {"port", Filter::Field::KernelPath},
+    {"name", Filter::Field::Name},
+    {"symlink", Filter::Field::Symlink},
+    {"filePath", Filter::Field::FilePath},
+    {"file", Filter::Field::FilePath},
+};
+
+const std::string EMPTY;
+
+const std::string& getField(const DeviceInfo& dev, Filter::Field field) {
+    switch (field) {
+        case Filter::Field::DevPath:      return dev.devPath;
+        case Filter::Field::SysPath:      return dev.sysPath;
+        case Filter::Field::Subsystem:    return dev.subsystem;
+        case Filter::Field::Vendor:       return dev.vendor;
+        case Filter::Field::VendorId:     return dev.vendorId;
+        case Filter::Field::ProductId:    return dev.productId;
+        case Filter::Field::Serial:       return dev.serial;
+        case Filter::Field::Manufacturer: return dev.manufacturer;
+        case Filter::Field::Product:      return dev.product;
+        case Filter::Field::Driver:       return dev.driver;
+        case Filter::Field::DevNode:      return dev.devNode;
+        case Filter::Field::BusNum:       return dev.busNum;
+        case Filter::Field::DevNum:       return dev.devNum;
+        case Filter::Field::InterfaceNum: return dev.interfaceNum;
+        case Filter::Field::KernelPath:   return dev.kernelPath;
+        default:                          return EMPTY;
+    }
+}
+
+const std::string& getField(const UdevRule& rule, Filter::Field field) {
+    switch (field) {
+        case Filter::Field::VendorId:     return rule.vendorId;
+        case Filter::Field::ProductId:    return rule.productId;
+        case Filter::Field::Serial:       return rule.serial;
+        case Filter::Field::InterfaceNum: return rule.interfaceNum;
+        case Filter::Field::KernelPath:   return rule.kernelPath;
+        case Filter::Field::Name:         return rule.name;
+        case Filter::Field::Symlink:      return rule.symlink;
+        case Filter::Field::FilePath:     return rule.filePath;
+        default:                          return EMPTY;
+    }
+}
+
+// A device with the rule naming it; rule fields come from the rule
+struct DeviceWithRule {
+    const DeviceInfo& device;
+    const UdevRule* rule;
+};
+
+const std::string& getField(const DeviceWithRule& record, Filter::Field field) {
+    switch (field) {
+        case Filter::Field::Name:
+        case Filter::Field::Symlink:
+        case Filter::Field::FilePath:
+            return record.rule ? getField(*record.rule, field) : EMPTY;
+        default:
+            return getField(record.device, field);
+    }
+}
+
+} // namespace
+
+/**
+ * @brief Recursive descent parser emitting a postfix program
+ */
+class FilterParser {
+public:
+    FilterParser(const std::string& text, Filter& filter)
+        : text_(text), pos_(0), depth_(0), nesting_(0), filter_(filter) {}
+
+    bool parse(std::string& error) {
+        skipSpace();
+        if (pos_ >= text_.size()) {
+            return true;    // Empty expression matches everything
+        }
+        if (!parseOr()) {
+            error = error_;
+            return false;
+        }
+        skipSpace();
+        if (pos_ < text_.size()) {
+            error = "unexpected '" + text_.substr(pos_, 1) + "' at position " + std::to_string(pos_ + 1);
+            return false;
+        }
+        return true;
+    }
+
+private:
+    const std::string& text_;
+    size_t pos_;
+    size_t depth_;          // Evaluation stack depth of the program so far
+    size_t nesting_;        // Open '!' and '(' being parsed, i.e. recursion depth
+    std::string error_;
+    Filter& filter_;
+
+    void skipSpace() {
+        while (pos_ < text_.size() && std::isspace(static_cast<unsigned char>(text_[pos_]))) {
+            pos_++;
+        }
+    }
+
+    bool accept(const char* token) {
+        skipSpace();
+        size_t len = std::strlen(token);
+        if (text_.compare(pos_, len, token) == 0) {
+            pos_ += len;
+            return true;
+        }
+        return false;
+    }
+
+    bool fail(const std::string& msg) {
+        if (error_.empty()) {
+            error_ = msg + " at position " + std::to_string(pos_ + 1);
+        }
+        return false;
+    }
+
+    void emit(Filter::OpCode op, Filter::Field field = Filter::Field::DevPath, size_t value = 0) {
+        filter_.program_.push_back({op, field, value});
+    }
+
+    bool parseOr() {
+        if (!parseAnd()) return false;
+        while (accept("||")) {
+            if (!parseAnd()) return false;
+            emit(Filter::OpCode::Or);
+            depth_--;
+        }
+        return true;
+    }
+
+    bool parseAnd() {
+        if (!parseUnary()) return false;
+        while (accept("&&")) {
+            if (!parseUnary()) return false;
+            emit(Filter::OpCode::And);
+            depth_--;
+        }
+        return true;
+    }
+
+    bool parseUnary() {
+        skipSpace();
+        bool negate = text_.compare(pos_, 2, "!=") != 0 && text_.compare(pos_, 2, "!~") != 0 && accept("!");
+        if (!negate && !accept("(")) {
+            return parseCompare();
+        }
+
+        // Bound the recursion too, or a long run of '!' or '(' from the
+        // command line or the TUI prompt overflows the stack
+        if (++nesting_ > Filter::MAX_DEPTH) {
+            return fail("expression nested too deeply");
+        }
+        bool ok = negate ? parseUnary() : parseOr() && (accept(")") || fail("expected ')'"));
+        nesting_--;
+        if (ok && negate) {
+            emit(Filter::OpCode::Not);
+        }
+        return ok;
+    }
+
+    bool parseCompare() {
+        skipSpace();
+        size_t start = pos_;
+        while (pos_ < text_.size() &&
+               (std::isalnum(static_cast<unsigned char>(text_[pos_])) || text_[pos_] == '_')) {
+            pos_++;
+        }
+        if (pos_ == start) {
+            return fail("expected field name");
+        }
+
+        std::string name = text_.substr(start, pos_ - start);
+        auto field = Filter::findField(name);
+        if (!field) {
+            pos_ = start;
+            return fail("unknown field '" + name + "'");
+        }
+
+        Filter::OpCode op;
+        if (accept("==")) {
+            op = Filter::OpCode::Equal;
+        } else if (accept("!=")) {
+            op = Filter::OpCode::NotEqual;
+        } else if (accept("^=")) {
+            op = Filter::OpCode::Prefix;
+        } else if (accept("!~")) {
+            op = Filter::OpCode::NotGlob;
+        } else if (accept("~")) {
+            op = Filter::OpCode::Glob;
+        } else {
+            return fail("expected ==, !=, ^=, ~ or !~");
+        }
+
+        std::string value;
+        if (!parseValue(value)) return false;
+
+        filter_.values_.push_back(value);
+        emit(op, *field, filter_.values_.size() - 1);
+
+        if (++depth_ > Filter::MAX_DEPTH) {
+            return fail("expression nested too deeply");
+        }
+        return true;
+    }
+
+    bool parseValue(std::string& value) {
+        skipSpace();
+        if (pos_ < text_.size() && text_[pos_] == '"') {
+            pos_++;
+            while (pos_ < text_.size() && text_[pos_] != '"') {
+                if (text_[pos_] == '\\' && pos_ + 1 < text_.size()) {
+                    pos_++;
+                }
+                value += text_[pos_++];
+            }
+            if (pos_ >= text_.size()) {
+                return fail("unterminated string");
+            }
+            pos_++;
+            return true;
+        }
+
+        size_t start = pos_;
+        while (pos_ < text_.size()) {
+            char c = text_[pos_];
+            if (std::isspace(static_cast<unsigned char>(c)) || c == '(' || c == ')' ||
+                c == '&' || c == '|' || c == '!' || c == '"') {
+                break;
+            }
+            pos_++;
+        }
+        if (pos_ == start) {
+            return fail("expected value");
+        }
+        value = text_.substr(start, pos_ - start);
+        return true;
+    }
+};
+
+std::optional<Filter> Filter::compile(const std::string& expr, std::string& error) {
+    Filter filter;
+    filter.expression_ = expr;
+
+    FilterParser parser(expr, filter);
+    if (!parser.parse(error)) {
+        return std::nullopt;
+    }
+    return filter;
+}
+
+std::optional<Filter::Field> Filter::findField(const std::string& name) {
+    for (const auto& candidate : FIELD_NAMES) {
+        if (strcasecmp(candidate.name, name.c_str()) == 0) {
+            return candidate.field;
+        }
+    }
+    return std::nullopt;
+}
+
+const std::string& Filter::fieldValue(const DeviceInfo& device, Field field) {
+    return getField(device, field);
+}
+
+bool Filter::matches(const DeviceInfo& device) const {
+    return evaluate(device);
+}
+
+bool Filter::matches(const UdevRule& rule) const {
+    return evaluate(rule);
+}
+
+bool Filter::matches(const DeviceInfo& device, const UdevRule* rule) const {
+    return evaluate(DeviceWithRule{device, rule});
+}
+
+template <typename Record>
+bool Filter::evaluate(const Record& record) const {
+    if (program_.empty()) {
+        return true;
+    }
+
+    bool stack[MAX_DEPTH];
+    size_t top = 0;
+
+    for (const auto& ins : program_) {
+        switch (ins.op) {
+            case OpCode::And:
+                top--;
+                stack[top - 1] = stack[top - 1] && stack[top];
+                break;
+            case OpCode::Or:
+                top--;
+                stack[top - 1] = stack[top - 1] || stack[top];
+                break;
+            case OpCode::Not:
+                stack[top - 1] = !stack[top - 1];
+                break;
+            default: {
+                const std::string& actual = getField(record, ins.field);
+                const std::string& value = values_[ins.value];
+                bool result = false;
+                switch (ins.op) {
+                    case OpCode::Equal:
+                        result = actual == value;
+                        break;
+                    case OpCode::NotEqual:
+                        result = actual != value;
+                        break;
+                    case OpCode::Prefix:
+                        result = actual.compare(0, value.size(), value) == 0;
+                        break;
+                    case OpCode::Glob:
+                    case OpCode::NotGlob:
+                        result = globMatch(value.data(), value.size(), actual.data(), actual.size());
+                        if (ins.op == OpCode::NotGlob) result = !result;
+                        break;
+                    default:
+                        break;
+                }
+                stack[top++] = result;
+                break;
+            }
+        }
+    }
+
+    return stack[0];
+}
+
+bool Filter::globMatch(const char* pattern, size_t patternLen, const char* str, size_t strLen) {
+    size_t p = 0;
+    size_t s = 0;
+    size_t starP = std::string::npos;
+    size_t starS = 0;
+
+    while (s < strLen) {
+        if (p < patternLen && (pattern[p] == '?' || pattern[p] == str[s])) {
+            p++;
+            s++;
+        } else if (p < patternLen && pattern[p] == '*') {
+            // Remember the star and try matching it against nothing first
+            starP = p++;
+            starS = s;
+        } else if (starP != std::string::npos) {
+            p = starP + 1;
+            s = ++starS;
+        } else {
+            return false;
+        }
+    }
+
+    while (p < patternLen && pattern[p] == '*') {
+        p++;
+    }
+    return p == patternLen;
+}
+
+} // namespace easytty
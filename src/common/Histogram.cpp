@@ -0,0 +1,123 @@
+#include "common/Histogram.hpp"
+#include <algorithm>
+#include <limits>
+#include <sstream>
+
+namespace easytty {
+
+Histogram::Histogram()
+    : buckets_(BUCKET_COUNT, 0), count_(0), sum_(0),
+      min_(std::numeric_limits<uint64_t>::max()), max_(0) {}
+
+size_t Histogram::bucketIndex(uint64_t value) {
+    if (value < SUB_COUNT) {
+        return static_cast<size_t>(value);
+    }
+    int msb = 63 - __builtin_clzll(value);
+    int shift = msb - SUB_BITS;
+    if (shift > MAX_SHIFT) {
+        return BUCKET_COUNT - 1;
+    }
+    // value >> shift lies in [SUB_COUNT, 2 * SUB_COUNT)
+    return static_cast<size_t>(SUB_COUNT * (shift + 1) + ((value >> shift) - SUB_COUNT));
+}
+
+uint64_t Histogram::bucketUpperBound(size_t index) {
+    if (index < SUB_COUNT) {
+        return index;
+    }
+    uint64_t shift = (index - SUB_COUNT) / SUB_COUNT;
+    uint64_t sub = (index - SUB_COUNT) % SUB_COUNT + SUB_COUNT;
+    return ((sub + 1) << shift) - 1;
+}
+
+void Histogram::record(uint64_t value) {
+    buckets_[bucketIndex(value)]++;
+    count_++;
+    sum_ += value;
+    min_ = std::min(min_, value);
+    max_ = std::max(max_, value);
+}
+
+void Histogram::merge(const Histogram& other) {
+    for (size_t i = 0; i < BUCKET_COUNT; i++) {
+        buckets_[i] += other.buckets_[i];
+    }
+    count_ += other.count_;
+    sum_ += other.sum_;
+    min_ = std::min(min_, other.min_);
+    max_ = std::max(max_, other.max_);
+}
+
+uint64_t Histogram::percentile(double quantile) const {
+    if (count_ == 0) {
+        return 0;
+    }
+    quantile = std::min(1.0, std::max(0.0, quantile));
+    uint64_t rank = static_cast<uint64_t>(quantile * static_cast<double>(count_) + 0.5);
+    rank = std::max<uint64_t>(rank, 1);
+
+    uint64_t seen = 0;
+    for (size_t i = 0; i < BUCKET_COUNT; i++) {
+        seen += buckets_[i];
+        if (seen >= rank) {
+            return std::min(bucketUpperBound(i), max_);
+        }
+    }
+    return max_;
+}
+
+std::string Histogram::serialize() const {
+    std::ostringstream out;
+    out << count_ << ' ' << sum_ << ' ' << min() << ' ' << max_;
+    for (size_t i = 0; i < BUCKET_COUNT; i++) {
+        if (buckets_[i]) {
+            out << ' ' << i << ':' << buckets_[i];
+        }
+    }
+    return out.str();
+}
+
+bool Histogram::deserialize(const std::string& text) {
+    *this = Histogram();
+
+    std::istringstream in(text);
+    uint64_t count, sum, min, max;
+    if (!(in >> count >> sum >> min >> max)) {
+        return false;
+    }
+
+    uint64_t total = 0;
+    std::string entry;
+    while (in >> entry) {
+        size_t colon = entry.find(':');
+        if (colon == std::string::npos) {
+            *this = Histogram();
+            return false;
+        }
+        try {
+            size_t index = std::stoul(entry.substr(0, colon));
+            uint64_t n = std::stoull(entry.substr(colon + 1));
+            if (index >= BUCKET_COUNT) {
+                throw std::out_of_range("bucket");
+            }
+            buckets_[index] += n;
+            total += n;
+        } catch (const std::exception&) {
+            *this = Histogram();
+            return false;
+        }
+    }
+
+    if (total != count) {
+        *this = Histogram();
+        return false;
+    }
+    count_ = count;
+    sum_ = sum;
+    min_ = count ? min : std::numeric_limits<uint64_t>::max();
+    max_ = max;
+    return true;
+}
+
+} // namespace easytty
@@ -0,0 +1,257 @@
+#include "common/Json.hpp"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace easytty {
+
+namespace {
+
+class JsonParser {
+public:
+    explicit JsonParser(const std::string& text) : text_(text), pos_(0) {}
+
+    bool parseDocument(JsonValue& value) {
+        if (!parseValue(value, 0)) return false;
+        skipSpace();
+        if (pos_ != text_.size()) return fail("trailing characters");
+        return true;
+    }
+
+    std::string error;
+
+private:
+    const std::string& text_;
+    size_t pos_;
+
+    bool fail(const char* msg) {
+        if (error.empty()) {
+            error = std::string(msg) + " at offset " + std::to_string(pos_);
+        }
+        return false;
+    }
+
+    void skipSpace() {
+        while (pos_ < text_.size() &&
+               (text_[pos_] == ' ' || text_[pos_] == '\t' || text_[pos_] == '\n' || text_[pos_] == '\r')) {
+            pos_++;
+        }
+    }
+
+    bool literal(const char* word) {
+        size_t len = std::strlen(word);
+        if (text_.compare(pos_, len, word) != 0) return false;
+        pos_ += len;
+        return true;
+    }
+
+    bool parseValue(JsonValue& value, size_t depth) {
+        if (depth > JsonValue::MAX_DEPTH) return fail("nesting too deep");
+        skipSpace();
+        if (pos_ >= text_.size()) return fail("unexpected end of input");
+
+        char c = text_[pos_];
+        if (c == '{') return parseObject(value, depth);
+        if (c == '[') return parseArray(value, depth);
+        if (c == '"') {
+            value.type = JsonValue::Type::String;
+            return parseString(value.string);
+        }
+        if (literal("true")) {
+            value.type = JsonValue::Type::Bool;
+            value.boolean = true;
+            return true;
+        }
+        if (literal("false")) {
+            value.type = JsonValue::Type::Bool;
+            return true;
+        }
+        if (literal("null")) {
+            value.type = JsonValue::Type::Null;
+            return true;
+        }
+        if (c == '-' || (c >= '0' && c <= '9')) return parseNumber(value);
+        return fail("unexpected character");
+    }
+
+    bool parseObject(JsonValue& value, size_t depth) {
+        value.type = JsonValue::Type::Object;
+        pos_++;
+        skipSpace();
+        if (pos_ < text_.size() && text_[pos_] == '}') {
+            pos_++;
+            return true;
+        }
+        while (true) {
+            skipSpace();
+            if (pos_ >= text_.size() || text_[pos_] != '"') return fail("expected member name");
+            std::string key;
+            if (!parseString(key)) return false;
+            skipSpace();
+            if (pos_ >= text_.size() || text_[pos_] != ':') return fail("expected ':'");
+            pos_++;
+            value.object.emplace_back(std::move(key), JsonValue());
+            if (!parseValue(value.object.back().second, depth + 1)) return false;
+            skipSpace();
+            if (pos_ < text_.size() && text_[pos_] == ',') {
+                pos_++;
+                continue;
+            }
+            if (pos_ < text_.size() && text_[pos_] == '}') {
+                pos_++;
+                return true;
+            }
+            return fail("expected ',' or '}'");
+        }
+    }
+
+    bool parseArray(JsonValue& value, size_t depth) {
+        value.type = JsonValue::Type::Array;
+        pos_++;
+        skipSpace();
+        if (pos_ < text_.size() && text_[pos_] == ']') {
+            pos_++;
+            return true;
+        }
+        while (true) {
+            value.array.emplace_back();
+            if (!parseValue(value.array.back(), depth + 1)) return false;
+            skipSpace();
+            if (pos_ < text_.size() && text_[pos_] == ',') {
+                pos_++;
+                continue;
+            }
+            if (pos_ < text_.size() && text_[pos_] == ']') {
+                pos_++;
+                return true;
+            }
+            return fail("expected ',' or ']'");
+        }
+    }
+
+    static void appendUtf8(std::string& out, unsigned long cp) {
+        if (cp < 0x80) {
+            out += static_cast<char>(cp);
+        } else if (cp < 0x800) {
+            out += static_cast<char>(0xC0 | (cp >> 6));
+            out += static_cast<char>(0x80 | (cp & 0x3F));
+        } else if (cp < 0x10000) {
+            out += static_cast<char>(0xE0 | (cp >> 12));
+            out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (cp & 0x3F));
+        } else {
+            out += static_cast<char>(0xF0 | (cp >> 18));
+            out += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+            out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (cp & 0x3F));
+        }
+    }
+
+    bool parseHex4(unsigned long& cp) {
+        if (pos_ + 4 > text_.size()) return fail("truncated \\u escape");
+        char digits[5] = {text_[pos_], text_[pos_ + 1], text_[pos_ + 2], text_[pos_ + 3], 0};
+        char* end = nullptr;
+        cp = std::strtoul(digits, &end, 16);
+        if (end != digits + 4) return fail("invalid \\u escape");
+        pos_ += 4;
+        return true;
+    }
+
+    bool parseString(std::string& out) {
+        pos_++;     // Opening quote
+        while (pos_ < text_.size()) {
+            char c = text_[pos_++];
+            if (c == '"') return true;
+            if (c != '\\') {
+                out += c;
+                continue;
+            }
+            if (pos_ >= text_.size()) break;
+            char esc = text_[pos_++];
+            switch (esc) {
+                case '"':  out += '"'; break;
+                case '\\': out += '\\'; break;
+                case '/':  out += '/'; break;
+                case 'b':  out += '\b'; break;
+                case 'f':  out += '\f'; break;
+                case 'n':  out += '\n'; break;
+                case 'r':  out += '\r'; break;
+                case 't':  out += '\t'; break;
+                case 'u': {
+                    unsigned long cp = 0;
+                    if (!parseHex4(cp)) return false;
+                    // Combine a surrogate pair into one code point; a half
+                    // pair has no UTF-8 encoding
+                    if (cp >= 0xDC00 && cp < 0xE000) return fail("unpaired surrogate in \\u escape");
+                    if (cp >= 0xD800 && cp < 0xDC00) {
+                        if (text_.compare(pos_, 2, "\\u") != 0) return fail("unpaired surrogate in \\u escape");
+                        pos_ += 2;
+                        unsigned long low = 0;
+                        if (!parseHex4(low)) return false;
+                        if (low < 0xDC00 || low >= 0xE000) return fail("unpaired surrogate in \\u escape");
+                        cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                    }
+                    appendUtf8(out, cp);
+                    break;
+                }
+                default:
+                    return fail("invalid escape");
+            }
+        }
+        return fail("unterminated string");
+    }
+
+    bool parseNumber(JsonValue& value) {
+        const char* start = text_.c_str() + pos_;
+        char* end = nullptr;
+        value.type = JsonValue::Type::Number;
+        value.number = std::strtod(start, &end);
+        if (end == start) return fail("invalid number");
+        pos_ += static_cast<size_t>(end - start);
+        return true;
+    }
+};
+
+} // namespace
+
+std::optional<JsonValue> JsonValue::parse(const std::string& text, std::string& error) {
+    JsonValue value;
+    JsonParser parser(text);
+    if (!parser.parseDocument(value)) {
+        error = parser.error;
+        return std::nullopt;
+    }
+    return value;
+}
+
+const JsonValue* JsonValue::find(const std::string& key) const {
+    for (const auto& member : object) {
+        if (member.first == key) {
+            return &member.second;
+        }
+    }
+    return nullptr;
+}
+
+std::string JsonValue::asString() const {
+    switch (type) {
+        case Type::String:
+            return string;
+        case Type::Bool:
+            return boolean ? "true" : "false";
+        case Type::Number: {
+            char buffer[32];
+            if (std::floor(number) == number && std::fabs(number) < 1e15) {
+                std::snprintf(buffer, sizeof(buffer), "%lld", static_cast<long long>(number));
+            } else {
+                std::snprintf(buffer, sizeof(buffer), "%.17g", number);
+            }
+            return buffer;
+        }
+        default:
+            return "";
+    }
+}
+
+} // namespace easytty
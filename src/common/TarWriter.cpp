@@ -0,0 +1,108 @@
+#include "common/TarWriter.hpp"
+#include <cstring>
+#include <ctime>
+
+namespace easytty {
+
+namespace {
+
+constexpr size_t BLOCK_SIZE = 512;
+
+// Fixed-width, NUL terminated octal field; digits beyond the width are
+// dropped, callers keep values in range
+void putOctal(char* field, size_t width, unsigned long long value) {
+    field[width - 1] = '\0';
+    for (size_t i = width - 1; i-- > 0; value >>= 3) {
+        field[i] = static_cast<char>('0' + (value & 7));
+    }
+}
+
+} // namespace
+
+TarWriter::TarWriter(std::FILE* out) : out_(out) {}
+
+OperationResult TarWriter::writeHeader(const std::string& path, char type, size_t size,
+                                       unsigned mode, const std::string& linkTarget) {
+    char header[BLOCK_SIZE];
+    std::memset(header, 0, sizeof(header));
+
+    // name[100] at 0, prefix[155] at 345
+    std::string name = path;
+    std::string prefix;
+    if (name.size() > 100) {
+        size_t split = name.rfind('/', 155);
+        if (split == std::string::npos || name.size() - split - 1 > 100 || split == 0) {
+            return OperationResult::Failure("Path too long for tar: " + path);
+        }
+        prefix = name.substr(0, split);
+        name = name.substr(split + 1);
+    }
+    if (linkTarget.size() > 100) {
+        return OperationResult::Failure("Link target too long for tar: " + linkTarget);
+    }
+
+    std::memcpy(header, name.data(), name.size());
+    putOctal(header + 100, 8, mode);
+    putOctal(header + 108, 8, 0);       // uid
+    putOctal(header + 116, 8, 0);       // gid
+    putOctal(header + 124, 12, size);
+    putOctal(header + 136, 12, static_cast<unsigned long long>(std::time(nullptr)));
+    header[156] = type;
+    std::memcpy(header + 157, linkTarget.data(), linkTarget.size());
+    std::memcpy(header + 257, "ustar", 6);
+    std::memcpy(header + 263, "00", 2);
+    std::memcpy(header + 265, "root", 4);
+    std::memcpy(header + 297, "root", 4);
+    std::memcpy(header + 345, prefix.data(), prefix.size());
+
+    // The checksum is computed with its own field filled with spaces
+    std::memset(header + 148, ' ', 8);
+    unsigned long sum = 0;
+    for (unsigned char c : header) {
+        sum += c;
+    }
+    std::snprintf(header + 148, 8, "%06lo", sum);
+    header[155] = ' ';
+
+    if (std::fwrite(header, 1, sizeof(header), out_) != sizeof(header)) {
+        return OperationResult::Failure("Failed to write tar header");
+    }
+    return OperationResult::Success();
+}
+
+OperationResult TarWriter::addDirectory(const std::string& path) {
+    std::string dir = path;
+    if (dir.empty() || dir.back() != '/') {
+        dir += '/';
+    }
+    return writeHeader(dir, '5', 0, 0755, "");
+}
+
+OperationResult TarWriter::addFile(const std::string& path, const std::string& content) {
+    auto result = writeHeader(path, '0', content.size(), 0644, "");
+    if (!result.success) {
+        return result;
+    }
+
+    static const char padding[BLOCK_SIZE] = {};
+    size_t tail = content.size() % BLOCK_SIZE;
+    if (std::fwrite(content.data(), 1, content.size(), out_) != content.size() ||
+        (tail && std::fwrite(padding, 1, BLOCK_SIZE - tail, out_) != BLOCK_SIZE - tail)) {
+        return OperationResult::Failure("Failed to write " + path);
+    }
+    return OperationResult::Success();
+}
+
+OperationResult TarWriter::addSymlink(const std::string& path, const std::string& target) {
+    return writeHeader(path, '2', 0, 0777, target);
+}
+
+OperationResult TarWriter::finish() {
+    static const char zeros[BLOCK_SIZE * 2] = {};
+    if (std::fwrite(zeros, 1, sizeof(zeros), out_) != sizeof(zeros) || std::fflush(out_) != 0) {
+        return OperationResult::Failure("Failed to finish tar archive");
+    }
+    return OperationResult::Success();
+}
+
+} // namespace easytty
@@ -0,0 +1,134 @@
+#include "common/Trace.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <vector>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace easytty {
+namespace trace {
+
+namespace {
+
+struct Event {
+    const char* name;
+    std::string detail;
+    uint64_t startUs;
+    uint64_t endUs;
+};
+
+/**
+ * @brief Spans of one thread
+ *
+ * Buffers are heap allocated and owned by the registry so they outlive
+ * their thread and are still there when the trace is written at exit.
+ * Only the owning thread appends, so its lock is uncontended except
+ * while flush() reads the buffer; worker threads may still be running
+ * at exit.
+ */
+struct ThreadBuffer {
+    long tid;
+    std::mutex mutex;
+    std::vector<Event> events;
+};
+
+std::mutex gRegistryMutex;
+std::vector<ThreadBuffer*> gBuffers;
+std::string gOutputPath;
+
+ThreadBuffer& localBuffer() {
+    thread_local ThreadBuffer* buffer = nullptr;
+    if (!buffer) {
+        buffer = new ThreadBuffer;
+        buffer->tid = static_cast<long>(syscall(SYS_gettid));
+        buffer->events.reserve(1024);
+        std::lock_guard<std::mutex> lock(gRegistryMutex);
+        gBuffers.push_back(buffer);
+    }
+    return *buffer;
+}
+
+void writeEscaped(std::FILE* out, const char* text) {
+    for (const char* p = text; *p; p++) {
+        unsigned char c = static_cast<unsigned char>(*p);
+        if (c == '"' || c == '\\') {
+            std::fputc('\\', out);
+            std::fputc(c, out);
+        } else if (c < 0x20) {
+            std::fprintf(out, "\\u%04x", c);
+        } else {
+            std::fputc(c, out);
+        }
+    }
+}
+
+} // namespace
+
+namespace detail {
+
+uint64_t nowMicros() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+void record(const char* name, const std::string& detail, uint64_t startUs, uint64_t endUs) {
+    ThreadBuffer& buffer = localBuffer();
+    std::lock_guard<std::mutex> lock(buffer.mutex);
+    buffer.events.push_back({name, detail, startUs, endUs});
+}
+
+} // namespace detail
+
+void initFromEnvironment() {
+    const char* path = std::getenv("EASYTTY_TRACE");
+    if (!path || !*path) {
+        return;
+    }
+    gOutputPath = path;
+    detail::gEnabled = true;
+    std::atexit(flush);
+}
+
+void flush() {
+    if (!detail::gEnabled) {
+        return;
+    }
+
+    std::FILE* out = std::fopen(gOutputPath.c_str(), "w");
+    if (!out) {
+        std::fprintf(stderr, "easyTTY: cannot write trace %s\n", gOutputPath.c_str());
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(gRegistryMutex);
+    long pid = static_cast<long>(getpid());
+    bool first = true;
+
+    std::fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n", out);
+    for (ThreadBuffer* buffer : gBuffers) {
+        std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+        for (const Event& event : buffer->events) {
+            std::fputs(first ? "" : ",\n", out);
+            first = false;
+            std::fputs("{\"name\":\"", out);
+            writeEscaped(out, event.name);
+            std::fprintf(out, "\",\"cat\":\"easytty\",\"ph\":\"X\",\"ts\":%llu,\"dur\":%llu,\"pid\":%ld,\"tid\":%ld",
+                         static_cast<unsigned long long>(event.startUs),
+                         static_cast<unsigned long long>(event.endUs - event.startUs),
+                         pid, buffer->tid);
+            if (!event.detail.empty()) {
+                std::fputs(",\"args\":{\"detail\":\"", out);
+                writeEscaped(out, event.detail.c_str());
+                std::fputs("\"}", out);
+            }
+            std::fputc('}', out);
+        }
+    }
+    std::fputs("\n]}\n", out);
+    std::fclose(out);
+}
+
+} // namespace trace
+} // namespace easytty
@@ -1,14 +1,72 @@
 #include "common/Utils.hpp"
+#include "common/Trace.hpp"
 #include <array>
 #include <memory>
 #include <cstdio>
+#include <cstdlib>
+#include <csignal>
 #include <unistd.h>
 #include <pwd.h>
 
 namespace easytty {
 namespace utils {
 
+std::string formatLocalTime(std::time_t time) {
+    struct tm local;
+    if (!localtime_r(&time, &local)) {
+        return "";
+    }
+    
+    char buffer[64];
+    size_t len = strftime(buffer, sizeof(buffer), "%a %b %e %H:%M:%S %Z %Y", &local);
+    return std::string(buffer, len);
+}
+
+std::string formatLocalDate(std::time_t time) {
+    struct tm local;
+    if (!localtime_r(&time, &local)) {
+        return "";
+    }
+    
+    char buffer[16];
+    size_t len = strftime(buffer, sizeof(buffer), "%Y-%m-%d", &local);
+    return std::string(buffer, len);
+}
+
+std::string formatTimestampUsec(uint64_t usec) {
+    std::time_t seconds = static_cast<std::time_t>(usec / 1000000);
+    struct tm local;
+    localtime_r(&seconds, &local);
+    
+    char buffer[48];
+    size_t len = strftime(buffer, sizeof(buffer), "%Y-%m-%dT%H:%M:%S", &local);
+    snprintf(buffer + len, sizeof(buffer) - len, ".%06llu",
+             static_cast<unsigned long long>(usec % 1000000));
+    return buffer;
+}
+
+bool parseDuration(const std::string& text, uint64_t& seconds) {
+    char* end = nullptr;
+    unsigned long long amount = std::strtoull(text.c_str(), &end, 10);
+    if (end == text.c_str() || end[0] == '\0' || end[1] != '\0') {
+        return false;
+    }
+    
+    uint64_t unit = 0;
+    switch (end[0]) {
+        case 's': unit = 1; break;
+        case 'm': unit = 60; break;
+        case 'h': unit = 3600; break;
+        case 'd': unit = 86400; break;
+        case 'w': unit = 7 * 86400; break;
+        default: return false;
+    }
+    seconds = amount * unit;
+    return true;
+}
+
 std::string executeCommand(const std::string& cmd) {
+    EASYTTY_TRACE_SPAN("executeCommand", cmd);
     std::array<char, 128> buffer;
     std::string result;
     
@@ -24,6 +82,27 @@ std::string executeCommand(const std::string& cmd) {
     return trim(result);
 }
 
+namespace {
+volatile sig_atomic_t gStopRequested = 0;
+
+void onStopSignal(int) {
+    gStopRequested = 1;
+}
+} // namespace
+
+void installStopHandler() {
+    struct sigaction action = {};
+    action.sa_handler = onStopSignal;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = 0;
+    sigaction(SIGINT, &action, nullptr);
+    sigaction(SIGTERM, &action, nullptr);
+}
+
+bool stopRequested() {
+    return gStopRequested != 0;
+}
+
 bool isRoot() {
     return geteuid() == 0;
 }
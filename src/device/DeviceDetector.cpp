@@ -1,79 +1,95 @@
 #include "device/DeviceDetector.hpp"
 #include "common/Utils.hpp"
+#include "common/Trace.hpp"
+#include "common/AllocStats.hpp"
 #include <algorithm>
 #include <filesystem>
 #include <fstream>
+#include <chrono>
+#include <cstring>
 
 namespace easytty {
 
-DeviceDetector::DeviceDetector() {
-    udev_ = udev_new();
-    if (!udev_) {
-        throw std::runtime_error("Failed to initialize udev");
-    }
+namespace {
+
+bool sameDevice(const DeviceInfo& a, const DeviceInfo& b) {
+    return a.sysPath == b.sysPath && a.vendorId == b.vendorId && a.productId == b.productId &&
+           a.serial == b.serial && a.kernelPath == b.kernelPath && a.interfaceNum == b.interfaceNum &&
+           a.busNum == b.busNum && a.devNum == b.devNum && a.driver == b.driver;
+}
+
+} // namespace
+
+DeviceDetector::DeviceDetector() : DeviceDetector(DeviceSource::createDefault()) {
+}
+
+DeviceDetector::DeviceDetector(std::unique_ptr<DeviceSource> source, std::unique_ptr<EventSource> events)
+    : source_(std::move(source)), events_(std::move(events)), monitoring_(false),
+      devices_(std::make_shared<const std::vector<DeviceInfo>>()), lastScanDuration_(0),
+      coalesceWindow_(0), burstEvents_(0) {
 }
 
 DeviceDetector::~DeviceDetector() {
-    if (udev_) {
-        udev_unref(udev_);
-    }
+    stopMonitor();
 }
 
 std::vector<DeviceInfo> DeviceDetector::scanDevices() {
-    devices_.clear();
-    
-    struct udev_enumerate* enumerate = udev_enumerate_new(udev_);
-    if (!enumerate) {
-        return devices_;
-    }
-    
-    // Add matching subsystems
-    udev_enumerate_add_match_subsystem(enumerate, "tty");
-    udev_enumerate_scan_devices(enumerate);
-    
-    struct udev_list_entry* devices = udev_enumerate_get_list_entry(enumerate);
-    struct udev_list_entry* entry;
-    
-    udev_list_entry_foreach(entry, devices) {
-        const char* path = udev_list_entry_get_name(entry);
-        struct udev_device* dev = udev_device_new_from_syspath(udev_, path);
-        
-        if (dev) {
-            const char* devNode = udev_device_get_devnode(dev);
-            if (devNode) {
-                std::string devPath(devNode);
-                // Filter for serial devices
-                if (devPath.find("ttyUSB") != std::string::npos ||
-                    devPath.find("ttyACM") != std::string::npos ||
-                    devPath.find("ttyAMA") != std::string::npos ||
-                    devPath.find("ttySC") != std::string::npos) {
-                    
-                    DeviceInfo info = extractDeviceInfo(dev);
-                    if (info.isValid()) {
-                        devices_.push_back(info);
-                    }
-                }
-            }
-            udev_device_unref(dev);
-        }
-    }
-    
-    udev_enumerate_unref(enumerate);
+    EASYTTY_TRACE_SPAN("scanDevices");
+    EASYTTY_ALLOC_PHASE(ScanDevices);
+    auto start = std::chrono::steady_clock::now();
+    std::vector<DeviceInfo> devices = source_->enumerate();
     
     // Sort by device node
-    std::sort(devices_.begin(), devices_.end(), 
+    std::sort(devices.begin(), devices.end(), 
               [](const DeviceInfo& a, const DeviceInfo& b) {
                   return a.devPath < b.devPath;
               });
     
-    return devices_;
+    lastScanDuration_ = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start);
+    publish(std::move(devices));
+    return *devices_;
+}
+
+std::string DeviceDetector::physicalDeviceKey(const DeviceInfo& device) {
+    if (device.vendorId.empty()) {
+        return device.devPath;
+    }
+    if (!device.kernelPath.empty()) {
+        return device.vendorId + ":" + device.productId + "@" + device.kernelPath;
+    }
+    if (!device.busNum.empty() || !device.devNum.empty()) {
+        return device.vendorId + ":" + device.productId + ":bus" + device.busNum + "dev" + device.devNum;
+    }
+    return device.devPath;
+}
+
+std::vector<std::vector<DeviceInfo>> DeviceDetector::groupInterfaces(const std::vector<DeviceInfo>& devices) {
+    std::vector<std::vector<DeviceInfo>> groups;
+    std::map<std::string, size_t> groupByKey;
+    
+    for (const auto& device : devices) {
+        auto [it, inserted] = groupByKey.emplace(physicalDeviceKey(device), groups.size());
+        if (inserted) {
+            groups.emplace_back();
+        }
+        groups[it->second].push_back(device);
+    }
+    
+    for (auto& group : groups) {
+        std::stable_sort(group.begin(), group.end(),
+                         [](const DeviceInfo& a, const DeviceInfo& b) {
+                             return a.interfaceNum < b.interfaceNum;
+                         });
+    }
+    return groups;
 }
 
 std::vector<DeviceInfo> DeviceDetector::scanDevices(const std::string& pattern) {
     scanDevices();
     
     std::vector<DeviceInfo> filtered;
-    std::copy_if(devices_.begin(), devices_.end(), std::back_inserter(filtered),
+    std::copy_if(devices_->begin(), devices_->end(), std::back_inserter(filtered),
                  [&pattern](const DeviceInfo& dev) {
                      return dev.devPath.find(pattern) != std::string::npos;
                  });
@@ -82,106 +98,170 @@ std::vector<DeviceInfo> DeviceDetector::scanDevices(const std::string& pattern)
 }
 
 std::optional<DeviceInfo> DeviceDetector::getDeviceInfo(const std::string& devPath) {
-    struct udev_device* dev = udev_device_new_from_devnum(
-        udev_, 'c', 
-        std::filesystem::status(devPath).type() == std::filesystem::file_type::character 
-            ? 0 : 0);
-    
-    // Try finding by syspath instead
-    std::string sysPath = "/sys/class/tty/" + 
-                          devPath.substr(devPath.rfind('/') + 1);
-    
-    dev = udev_device_new_from_syspath(udev_, sysPath.c_str());
-    
-    if (!dev) {
-        // Scan all and find matching
-        scanDevices();
-        for (const auto& device : devices_) {
-            if (device.devPath == devPath) {
-                return device;
-            }
-        }
-        return std::nullopt;
-    }
-    
-    DeviceInfo info = extractDeviceInfo(dev);
-    udev_device_unref(dev);
-    
-    return info.isValid() ? std::optional<DeviceInfo>(info) : std::nullopt;
+    return source_->lookup(devPath);
 }
 
 void DeviceDetector::refresh() {
     scanDevices();
 }
 
-DeviceInfo DeviceDetector::extractDeviceInfo(struct udev_device* dev) {
-    DeviceInfo info;
-    
-    const char* devNode = udev_device_get_devnode(dev);
-    if (devNode) {
-        info.devPath = devNode;
-        info.devNode = std::string(devNode).substr(std::string(devNode).rfind('/') + 1);
+bool DeviceDetector::startMonitor() {
+    if (monitoring_) {
+        return true;
     }
     
-    const char* sysPath = udev_device_get_syspath(dev);
-    if (sysPath) {
-        info.sysPath = sysPath;
+    // Scans may come from a fixture; events come from the live system
+    // unless a source was injected or named
+    if (!events_) {
+        try {
+            events_ = EventSource::createDefault();
+        } catch (const std::exception&) {
+            return false;
+        }
+    }
+    if (!events_->start()) {
+        events_.reset();
+        return false;
     }
     
-    const char* subsystem = udev_device_get_subsystem(dev);
-    if (subsystem) {
-        info.subsystem = subsystem;
+    monitoring_ = true;
+    return true;
+}
+
+void DeviceDetector::stopMonitor() {
+    events_.reset();
+    monitoring_ = false;
+}
+
+int DeviceDetector::getMonitorFd() const {
+    return monitoring_ ? events_->getFd() : -1;
+}
+
+std::optional<DeviceEvent> DeviceDetector::receiveEvent() {
+    if (!monitoring_) {
+        return std::nullopt;
     }
     
-    // Get USB parent device for attributes
-    struct udev_device* usb_dev = findUsbParent(dev);
-    if (usb_dev) {
-        info.vendorId = utils::formatHexId(getSysAttr(usb_dev, "idVendor"));
-        info.productId = utils::formatHexId(getSysAttr(usb_dev, "idProduct"));
-        info.serial = getSysAttr(usb_dev, "serial");
-        info.manufacturer = getSysAttr(usb_dev, "manufacturer");
-        info.product = getSysAttr(usb_dev, "product");
-        info.busNum = getSysAttr(usb_dev, "busnum");
-        info.devNum = getSysAttr(usb_dev, "devnum");
-        
-        // Get kernel path (USB port path like "1-2.3") for physical location
-        const char* sysName = udev_device_get_sysname(usb_dev);
-        if (sysName) {
-            info.kernelPath = sysName;
-        }
-        
-        const char* driver = udev_device_get_driver(usb_dev);
-        if (driver) {
-            info.driver = driver;
+    auto event = events_->receive();
+    if (event) {
+        if (coalesceWindow_.count() > 0) {
+            noteBurst(*event);
         }
+        applyEvent(*event);
     }
+    return event;
+}
+
+void DeviceDetector::setCoalesceWindow(std::chrono::milliseconds window) {
+    coalesceWindow_ = window;
+    burst_.clear();
+    burstEvents_ = 0;
+}
+
+void DeviceDetector::noteBurst(const DeviceEvent& event) {
+    auto now = std::chrono::steady_clock::now();
+    if (burstEvents_ == 0) {
+        burstStart_ = now;
+    }
+    burstLast_ = now;
+    burstEvents_++;
     
-    // Get interface driver and interface number
-    struct udev_device* intf_dev = udev_device_get_parent_with_subsystem_devtype(
-        dev, "usb", "usb_interface");
-    if (intf_dev) {
-        const char* driver = udev_device_get_driver(intf_dev);
-        if (driver) {
-            info.driver = driver;
+    auto [entry, inserted] = burst_.try_emplace(event.device.devPath);
+    if (inserted) {
+        auto it = std::lower_bound(devices_->begin(), devices_->end(), event.device.devPath,
+                                   [](const DeviceInfo& dev, const std::string& path) {
+                                       return dev.devPath < path;
+                                   });
+        if (it != devices_->end() && it->devPath == event.device.devPath) {
+            entry->second.before = *it;
         }
-        info.interfaceNum = getSysAttr(intf_dev, "bInterfaceNumber");
     }
-    
-    return info;
+    if (event.action == DeviceAction::Remove) {
+        entry->second.detached = true;
+    }
 }
 
-struct udev_device* DeviceDetector::findUsbParent(struct udev_device* dev) {
-    return udev_device_get_parent_with_subsystem_devtype(dev, "usb", "usb_device");
+std::chrono::steady_clock::time_point DeviceDetector::burstDeadline() const {
+    // A steady stream would otherwise never end the burst
+    return std::min(burstLast_ + coalesceWindow_, burstStart_ + 4 * coalesceWindow_);
 }
 
-std::string DeviceDetector::getAttr(struct udev_device* dev, const char* attr) {
-    const char* value = udev_device_get_property_value(dev, attr);
-    return value ? std::string(value) : "";
+int DeviceDetector::burstTimeoutMs() const {
+    if (burstEvents_ == 0) {
+        return -1;
+    }
+    auto remaining = std::chrono::ceil<std::chrono::milliseconds>(burstDeadline() - std::chrono::steady_clock::now());
+    return std::max<int>(0, static_cast<int>(remaining.count()));
+}
+
+std::optional<DeviceDiff> DeviceDetector::takeBurst() {
+    if (burstEvents_ == 0 || std::chrono::steady_clock::now() < burstDeadline()) {
+        return std::nullopt;
+    }
+    
+    DeviceDiff diff;
+    diff.events = burstEvents_;
+    for (auto& [path, entry] : burst_) {
+        auto it = std::lower_bound(devices_->begin(), devices_->end(), path,
+                                   [](const DeviceInfo& dev, const std::string& p) {
+                                       return dev.devPath < p;
+                                   });
+        const DeviceInfo* now = (it != devices_->end() && it->devPath == path) ? &*it : nullptr;
+        
+        if (entry.before && !now) {
+            diff.removed.push_back(std::move(*entry.before));
+        } else if (!entry.before && now) {
+            diff.added.push_back(*now);
+        } else if (now && (entry.detached || !sameDevice(*entry.before, *now))) {
+            diff.changed.push_back(*now);
+        }
+        // Neither before nor after: attached and gone again within the burst
+    }
+    
+    burst_.clear();
+    burstEvents_ = 0;
+    return diff;
+}
+
+void DeviceDetector::applyEvent(DeviceEvent& event) {
+    auto it = std::find_if(devices_->begin(), devices_->end(),
+                          [&event](const DeviceInfo& dev) {
+                              return dev.devPath == event.device.devPath;
+                          });
+    
+    if (event.action == DeviceAction::Remove) {
+        if (it != devices_->end()) {
+            // Report the full record we knew about
+            event.device = *it;
+            std::vector<DeviceInfo> devices;
+            devices.reserve(devices_->size() - 1);
+            devices.insert(devices.end(), devices_->begin(), it);
+            devices.insert(devices.end(), std::next(it), devices_->end());
+            publish(std::move(devices));
+        }
+        return;
+    }
+    
+    if (!event.device.isValid()) {
+        return;
+    }
+    
+    // Copy on write: readers holding the old list keep it unchanged
+    std::vector<DeviceInfo> devices = *devices_;
+    if (it != devices_->end()) {
+        devices[it - devices_->begin()] = event.device;
+    } else {
+        auto pos = std::upper_bound(devices.begin(), devices.end(), event.device,
+                                    [](const DeviceInfo& a, const DeviceInfo& b) {
+                                        return a.devPath < b.devPath;
+                                    });
+        devices.insert(pos, event.device);
+    }
+    publish(std::move(devices));
 }
 
-std::string DeviceDetector::getSysAttr(struct udev_device* dev, const char* attr) {
-    const char* value = udev_device_get_sysattr_value(dev, attr);
-    return value ? utils::trim(std::string(value)) : "";
+void DeviceDetector::publish(std::vector<DeviceInfo> devices) {
+    std::atomic_store(&devices_, DeviceList(std::make_shared<const std::vector<DeviceInfo>>(std::move(devices))));
 }
 
 } // namespace easytty
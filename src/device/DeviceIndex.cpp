@@ -0,0 +1,106 @@
+#include "device/DeviceIndex.hpp"
+#include "common/Utils.hpp"
+#include <climits>
+#include <cstdlib>
+
+namespace easytty {
+
+void DeviceIndex::build(const std::vector<DeviceInfo>& devices, const std::vector<UdevRule>& rules) {
+    devices_ = devices;
+    rules_ = rules;
+    ruleIndex_.build(rules_);
+    
+    byKey_.clear();
+    byKey_.reserve(devices_.size() * 4);
+    deviceRule_.assign(devices_.size(), nullptr);
+    symlinkDevice_.clear();
+    symlinkDevice_.reserve(devices_.size());
+    
+    auto addKey = [this](const std::string& key, size_t pos) {
+        if (key.empty()) return;
+        auto& positions = byKey_[key];
+        if (positions.empty() || positions.back() != pos) {
+            positions.push_back(pos);
+        }
+    };
+    
+    for (size_t i = 0; i < devices_.size(); i++) {
+        const DeviceInfo& dev = devices_[i];
+        addKey(dev.devPath, i);
+        addKey(dev.devNode, i);
+        addKey(dev.serial, i);
+        addKey(dev.kernelPath, i);
+        if (!dev.serial.empty()) {
+            addKey(dev.vendorId + ":" + dev.productId + ":" + dev.serial, i);
+        }
+        
+        const UdevRule* rule = ruleIndex_.findForDevice(dev);
+        deviceRule_[i] = rule;
+        if (rule) {
+            // Interfaces of one adapter share a rule; keep the first node
+            symlinkDevice_.emplace(rule->symlink, i);
+        }
+    }
+}
+
+std::vector<DeviceRecord> DeviceIndex::resolve(const std::string& query) const {
+    std::vector<DeviceRecord> records;
+    
+    std::string name = utils::startsWith(query, "/dev/") ? query.substr(5) : query;
+    
+    // Symlink names take precedence over device attributes
+    if (const UdevRule* rule = ruleIndex_.findBySymlink(name)) {
+        auto it = symlinkDevice_.find(rule->symlink);
+        records.push_back({it != symlinkDevice_.end() ? &devices_[it->second] : nullptr, rule});
+        return records;
+    }
+    
+    auto it = byKey_.find(query);
+    if (it == byKey_.end()) {
+        return records;
+    }
+    
+    records.reserve(it->second.size());
+    for (size_t pos : it->second) {
+        records.push_back({&devices_[pos], deviceRule_[pos]});
+    }
+    return records;
+}
+
+const UdevRule* DeviceIndex::ruleForDevice(const DeviceInfo& device) const {
+    return ruleIndex_.findForDevice(device);
+}
+
+const DeviceInfo* DeviceIndex::deviceForRule(const UdevRule& rule) const {
+    auto it = symlinkDevice_.find(rule.symlink);
+    return it != symlinkDevice_.end() ? &devices_[it->second] : nullptr;
+}
+
+LinkStatus DeviceIndex::linkStatus(const DeviceRecord& record) const {
+    if (!record.rule) {
+        return LinkStatus::Unmanaged;
+    }
+    
+    char resolved[PATH_MAX];
+    std::string link = "/dev/" + record.rule->symlink;
+    if (!realpath(link.c_str(), resolved)) {
+        return LinkStatus::Missing;
+    }
+    
+    if (record.device && record.device->devPath == resolved) {
+        return LinkStatus::Active;
+    }
+    
+    // Multi-interface adapters: udev may have pointed the link at a sibling
+    auto it = byKey_.find(resolved);
+    if (it != byKey_.end()) {
+        for (size_t pos : it->second) {
+            if (devices_[pos].devPath == resolved && record.rule->matchesDevice(devices_[pos])) {
+                return LinkStatus::Active;
+            }
+        }
+    }
+    return LinkStatus::WrongDevice;
+}
+
+} // namespace easytty
@@ -0,0 +1,244 @@
+#include "device/DeviceInventory.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <sys/stat.h>
+
+namespace fs = std::filesystem;
+
+namespace easytty {
+
+namespace {
+
+// Fields are tab-separated; keep stray tabs and newlines out of them
+std::string clean(const std::string& text) {
+    std::string result = text;
+    std::replace_if(result.begin(), result.end(), [](char c) { return c == '\t' || c == '\n'; }, ' ');
+    return result;
+}
+
+std::vector<std::string> splitFields(const std::string& line, char separator) {
+    std::vector<std::string> fields;
+    std::string field;
+    std::istringstream in(line);
+    while (std::getline(in, field, separator)) {
+        fields.push_back(field);
+    }
+    return fields;
+}
+
+} // namespace
+
+std::string DeviceInventory::deviceKey(const DeviceInfo& device) {
+    if (device.vendorId.empty()) {
+        return "";
+    }
+    if (!device.serial.empty()) {
+        return device.vendorId + ":" + device.productId + ":" + device.serial;
+    }
+    if (!device.kernelPath.empty()) {
+        return device.vendorId + ":" + device.productId + "@" + device.kernelPath;
+    }
+    return device.vendorId + ":" + device.productId;
+}
+
+void DeviceInventory::observe(const DeviceInfo& device, uint64_t nowSec) {
+    std::string key = deviceKey(device);
+    if (key.empty()) {
+        return;
+    }
+    if (trackingSince_ == 0) {
+        trackingSince_ = nowSec;
+        changed_ = true;
+    }
+
+    auto [it, inserted] = entries_.try_emplace(key);
+    Entry& entry = it->second;
+    if (inserted) {
+        entry.vendorId = device.vendorId;
+        entry.productId = device.productId;
+        entry.serial = device.serial;
+        entry.firstSeen = nowSec;
+        changed_ = true;
+    }
+    if (nowSec >= entry.lastSeen + LAST_SEEN_RESOLUTION) {
+        entry.lastSeen = nowSec;
+        changed_ = true;
+    }
+    if (!device.kernelPath.empty() &&
+        std::find(entry.ports.begin(), entry.ports.end(), device.kernelPath) == entry.ports.end()) {
+        entry.ports.push_back(device.kernelPath);
+        if (entry.ports.size() > MAX_PORTS) {
+            entry.ports.erase(entry.ports.begin());
+        }
+        changed_ = true;
+    }
+    if (entry.devNode != device.devNode && !device.devNode.empty()) {
+        entry.devNode = device.devNode;
+        changed_ = true;
+    }
+    if (entry.product.empty() && !device.product.empty()) {
+        entry.product = device.product;
+        changed_ = true;
+    }
+}
+
+void DeviceInventory::observe(const std::vector<DeviceInfo>& devices, uint64_t nowSec) {
+    for (const auto& device : devices) {
+        observe(device, nowSec);
+    }
+}
+
+bool DeviceInventory::takeChanged() {
+    bool changed = changed_;
+    changed_ = false;
+    return changed;
+}
+
+const DeviceInventory::Entry* DeviceInventory::find(const DeviceInfo& device) const {
+    auto it = entries_.find(deviceKey(device));
+    return it != entries_.end() ? &it->second : nullptr;
+}
+
+std::optional<uint64_t> DeviceInventory::lastSeenForRule(const UdevRule& rule) const {
+    std::string prefix = rule.vendorId + ":" + rule.productId;
+    if (!rule.serial.empty() || !rule.kernelPath.empty()) {
+        auto it = entries_.find(rule.serial.empty() ? prefix + "@" + rule.kernelPath : prefix + ":" + rule.serial);
+        if (it == entries_.end()) {
+            return std::nullopt;
+        }
+        return it->second.lastSeen;
+    }
+
+    // A shared rule matches every device of that model without a serial
+    std::optional<uint64_t> lastSeen;
+    for (const auto& [key, entry] : entries_) {
+        if (entry.vendorId == rule.vendorId && entry.productId == rule.productId && entry.serial.empty()) {
+            lastSeen = std::max(lastSeen.value_or(0), entry.lastSeen);
+        }
+    }
+    return lastSeen;
+}
+
+std::vector<DeviceInventory::StaleRule> DeviceInventory::findStaleRules(const std::vector<UdevRule>& rules,
+                                                                        uint64_t cutoffSec) const {
+    std::vector<StaleRule> stale;
+    for (const auto& rule : rules) {
+        StaleRule entry;
+        entry.rule = rule;
+        entry.lastSeen = lastSeenForRule(rule);
+        if (entry.lastSeen) {
+            entry.missingSince = *entry.lastSeen;
+        } else {
+            struct stat st;
+            uint64_t written = stat(rule.filePath.c_str(), &st) == 0 ? static_cast<uint64_t>(st.st_mtime) : 0;
+            // Not tracking at all yet: nothing is known to be missing
+            entry.missingSince = trackingSince_ ? std::max(trackingSince_, written) : UINT64_MAX;
+        }
+        if (entry.missingSince < cutoffSec) {
+            stale.push_back(std::move(entry));
+        }
+    }
+    std::sort(stale.begin(), stale.end(), [](const StaleRule& a, const StaleRule& b) {
+        return a.missingSince < b.missingSince;
+    });
+    return stale;
+}
+
+OperationResult DeviceInventory::save(const std::string& path) const {
+    std::error_code ec;
+    fs::create_directories(fs::path(path).parent_path(), ec);
+
+    std::string tmpPath = path + ".tmp";
+    {
+        std::ofstream out(tmpPath, std::ios::trunc);
+        if (!out.is_open()) {
+            return OperationResult::Failure("Cannot write " + tmpPath + ": " + std::strerror(errno));
+        }
+        out << "# easyTTY device inventory: vendor product serial firstSeen lastSeen ports devNode product\n";
+        out << "since\t" << trackingSince_ << '\n';
+        for (const auto& [key, entry] : entries_) {
+            std::string ports;
+            for (const auto& port : entry.ports) {
+                ports += (ports.empty() ? "" : ",") + port;
+            }
+            out << "device\t" << entry.vendorId << '\t' << entry.productId << '\t' << clean(entry.serial) << '\t'
+                << entry.firstSeen << '\t' << entry.lastSeen << '\t' << ports << '\t'
+                << entry.devNode << '\t' << clean(entry.product) << '\n';
+        }
+        if (!out) {
+            return OperationResult::Failure("Cannot write " + tmpPath);
+        }
+    }
+
+    if (rename(tmpPath.c_str(), path.c_str()) != 0) {
+        return OperationResult::Failure("Cannot replace " + path + ": " + std::strerror(errno));
+    }
+    return OperationResult::Success();
+}
+
+bool DeviceInventory::load(const std::string& path) {
+    std::ifstream in(path);
+    if (!in.is_open()) {
+        return false;
+    }
+
+    entries_.clear();
+    trackingSince_ = 0;
+    changed_ = false;
+
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        auto fields = splitFields(line, '\t');
+        if (fields.size() == 2 && fields[0] == "since") {
+            trackingSince_ = std::strtoull(fields[1].c_str(), nullptr, 10);
+            continue;
+        }
+        if (fields.size() < 7 || fields[0] != "device") {
+            continue;
+        }
+
+        Entry entry;
+        entry.vendorId = fields[1];
+        entry.productId = fields[2];
+        entry.serial = fields[3];
+        entry.firstSeen = std::strtoull(fields[4].c_str(), nullptr, 10);
+        entry.lastSeen = std::strtoull(fields[5].c_str(), nullptr, 10);
+        if (!fields[6].empty()) {
+            entry.ports = splitFields(fields[6], ',');
+        }
+        entry.devNode = fields.size() > 7 ? fields[7] : "";
+        entry.product = fields.size() > 8 ? fields[8] : "";
+
+        DeviceInfo identity;
+        identity.vendorId = entry.vendorId;
+        identity.productId = entry.productId;
+        identity.serial = entry.serial;
+        identity.kernelPath = entry.serial.empty() && !entry.ports.empty() ? entry.ports.front() : "";
+        entries_[deviceKey(identity)] = std::move(entry);
+    }
+    return true;
+}
+
+OperationResult DeviceInventory::recordScan(const std::vector<DeviceInfo>& devices) {
+    uint64_t now = std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+
+    DeviceInventory inventory;
+    inventory.load();
+    inventory.observe(devices, now);
+    if (inventory.takeChanged()) {
+        return inventory.save();
+    }
+    return OperationResult::Success();
+}
+
+} // namespace easytty
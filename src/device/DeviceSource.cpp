@@ -0,0 +1,46 @@
+#include "device/DeviceSource.hpp"
+#include "device/FixtureDeviceSource.hpp"
+#include "device/SysfsDeviceSource.hpp"
+#include "device/UdevDeviceSource.hpp"
+#include "common/Utils.hpp"
+#include <cstdlib>
+#include <stdexcept>
+
+namespace easytty {
+
+std::optional<DeviceInfo> DeviceSource::lookup(const std::string& devPath) {
+    for (auto& device : enumerate()) {
+        if (device.devPath == devPath) {
+            return device;
+        }
+    }
+    return std::nullopt;
+}
+
+std::unique_ptr<DeviceSource> DeviceSource::create(const std::string& spec) {
+    if (spec.empty() || spec == "udev") {
+        return std::make_unique<UdevDeviceSource>();
+    }
+    if (utils::startsWith(spec, "fixture:")) {
+        return FixtureDeviceSource::load(spec.substr(8));
+    }
+    if (utils::startsWith(spec, "sysfs:")) {
+        return std::make_unique<SysfsDeviceSource>(spec.substr(6));
+    }
+    throw std::runtime_error("Unknown device source '" + spec +
+                             "' (expected udev, fixture:<file> or sysfs:<dir>)");
+}
+
+std::unique_ptr<DeviceSource> DeviceSource::createDefault() {
+    const char* spec = std::getenv(ENV_VAR);
+    return create(spec ? spec : "");
+}
+
+bool DeviceSource::isSerialDevNode(const std::string& devPath) {
+    return devPath.find("ttyUSB") != std::string::npos ||
+           devPath.find("ttyACM") != std::string::npos ||
+           devPath.find("ttyAMA") != std::string::npos ||
+           devPath.find("ttySC") != std::string::npos;
+}
+
+} // namespace easytty
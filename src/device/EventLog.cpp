@@ -0,0 +1,247 @@
+#include "device/EventLog.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+namespace easytty {
+
+// On-disk layout: a Header followed by capacity Records. Strings are
+// NUL-padded and not necessarily NUL-terminated.
+struct EventLog::Record {
+    uint64_t sequence;          // 0 if the slot was never written
+    uint64_t timestampUsec;
+    uint64_t seqnum;
+    uint32_t checksum;          // FNV-1a over the record with this field zeroed
+    uint8_t action;
+    char interfaceNum[3];
+    char vendorId[4];
+    char productId[4];
+    char devNode[16];
+    char kernelPath[32];
+    char serial[40];
+    char symlink[64];
+};
+
+namespace {
+
+constexpr char MAGIC[8] = {'E', 'T', 'T', 'Y', 'R', 'I', 'N', 'G'};
+constexpr uint32_t VERSION = 1;
+
+struct Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t recordSize;
+    uint64_t capacity;
+    char reserved[40];
+};
+static_assert(sizeof(Header) == 64, "EventLog header layout changed");
+
+uint32_t fnv1a(const void* data, size_t size) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < size; i++) {
+        hash = (hash ^ bytes[i]) * 16777619u;
+    }
+    return hash;
+}
+
+template <size_t N>
+void copyField(char (&field)[N], const std::string& value) {
+    std::memset(field, 0, N);
+    std::memcpy(field, value.data(), std::min(N, value.size()));
+}
+
+template <size_t N>
+std::string readField(const char (&field)[N]) {
+    return std::string(field, strnlen(field, N));
+}
+
+bool headerMatches(const Header& header, size_t recordSize) {
+    return std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) == 0 && header.version == VERSION &&
+           header.recordSize == recordSize && header.capacity > 0;
+}
+
+static_assert(sizeof(EventLog::Record) == 192, "EventLog record layout changed");
+
+bool recordValid(const EventLog::Record& record) {
+    if (record.sequence == 0) {
+        return false;
+    }
+    EventLog::Record copy = record;
+    copy.checksum = 0;
+    return fnv1a(&copy, sizeof(copy)) == record.checksum;
+}
+
+} // namespace
+
+EventLog::EventLog()
+    : fd_(-1), mapping_(nullptr), mappingSize_(0), records_(nullptr), capacity_(0), nextSequence_(1) {
+}
+
+EventLog::~EventLog() {
+    close();
+}
+
+void EventLog::close() {
+    if (mapping_) {
+        munmap(mapping_, mappingSize_);
+        mapping_ = nullptr;
+        records_ = nullptr;
+    }
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+}
+
+OperationResult EventLog::open(const std::string& path, size_t capacity) {
+    close();
+
+    std::error_code ec;
+    fs::create_directories(fs::path(path).parent_path(), ec);
+
+    fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd_ < 0) {
+        return OperationResult::Failure("Cannot open " + path + ": " + std::strerror(errno));
+    }
+    if (flock(fd_, LOCK_EX | LOCK_NB) != 0) {
+        close();
+        return OperationResult::Failure(path + " is in use by another easyTTY watch");
+    }
+
+    // Keep an existing ring's geometry; (re)initialize anything else
+    Header header = {};
+    struct stat st;
+    bool reuse = fstat(fd_, &st) == 0 && static_cast<size_t>(st.st_size) >= sizeof(Header) &&
+                 pread(fd_, &header, sizeof(header), 0) == static_cast<ssize_t>(sizeof(header)) &&
+                 headerMatches(header, sizeof(Record)) &&
+                 static_cast<size_t>(st.st_size) == sizeof(Header) + header.capacity * sizeof(Record);
+    if (!reuse) {
+        std::memset(&header, 0, sizeof(header));
+        std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+        header.version = VERSION;
+        header.recordSize = sizeof(Record);
+        header.capacity = capacity;
+        // Truncating to zero first drops stale records of another layout
+        if (ftruncate(fd_, 0) != 0 ||
+            ftruncate(fd_, static_cast<off_t>(sizeof(Header) + capacity * sizeof(Record))) != 0 ||
+            pwrite(fd_, &header, sizeof(header), 0) != static_cast<ssize_t>(sizeof(header))) {
+            std::string error = std::strerror(errno);
+            close();
+            return OperationResult::Failure("Cannot initialize " + path + ": " + error);
+        }
+    }
+
+    capacity_ = header.capacity;
+    mappingSize_ = sizeof(Header) + capacity_ * sizeof(Record);
+    void* mapping = mmap(nullptr, mappingSize_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    if (mapping == MAP_FAILED) {
+        std::string error = std::strerror(errno);
+        close();
+        return OperationResult::Failure("Cannot map " + path + ": " + error);
+    }
+    mapping_ = mapping;
+    records_ = reinterpret_cast<Record*>(static_cast<char*>(mapping_) + sizeof(Header));
+
+    // Continue after the newest intact record
+    uint64_t newest = 0;
+    for (size_t i = 0; i < capacity_; i++) {
+        if (recordValid(records_[i])) {
+            newest = std::max(newest, records_[i].sequence);
+        }
+    }
+    nextSequence_ = newest + 1;
+    return OperationResult::Success();
+}
+
+void EventLog::append(const DeviceEvent& event, const UdevRule* rule) {
+    if (!records_) {
+        return;
+    }
+
+    Record record;
+    std::memset(&record, 0, sizeof(record));
+    record.sequence = nextSequence_;
+    record.timestampUsec = event.timestampUsec;
+    record.seqnum = event.seqnum;
+    record.action = static_cast<uint8_t>(event.action);
+    copyField(record.interfaceNum, event.device.interfaceNum);
+    copyField(record.vendorId, event.device.vendorId);
+    copyField(record.productId, event.device.productId);
+    copyField(record.devNode, event.device.devNode);
+    copyField(record.kernelPath, event.device.kernelPath);
+    copyField(record.serial, event.device.serial);
+    if (rule) {
+        copyField(record.symlink, rule->symlink);
+    }
+    record.checksum = fnv1a(&record, sizeof(record));
+
+    // One copy into the page cache; no msync, the kernel flushes it
+    std::memcpy(&records_[(nextSequence_ - 1) % capacity_], &record, sizeof(record));
+    nextSequence_++;
+}
+
+OperationResult EventLog::read(const std::string& path, uint64_t sinceUsec, std::vector<Entry>& entries) {
+    entries.clear();
+
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return OperationResult::Failure("Cannot open " + path + ": " + std::strerror(errno));
+    }
+
+    Header header;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || pread(fd, &header, sizeof(header), 0) != static_cast<ssize_t>(sizeof(header)) ||
+        !headerMatches(header, sizeof(Record)) ||
+        static_cast<size_t>(st.st_size) < sizeof(Header) + header.capacity * sizeof(Record)) {
+        ::close(fd);
+        return OperationResult::Failure(path + " is not an easyTTY event log");
+    }
+
+    size_t size = sizeof(Header) + header.capacity * sizeof(Record);
+    void* mapping = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        return OperationResult::Failure("Cannot map " + path + ": " + std::strerror(errno));
+    }
+    madvise(mapping, size, MADV_SEQUENTIAL);
+
+    // Filter on the raw records; only matches are decoded
+    const Record* records = reinterpret_cast<const Record*>(static_cast<const char*>(mapping) + sizeof(Header));
+    for (size_t i = 0; i < header.capacity; i++) {
+        Record record = records[i];
+        if (record.timestampUsec < sinceUsec || !recordValid(record)) continue;
+
+        Entry entry;
+        entry.sequence = record.sequence;
+        entry.timestampUsec = record.timestampUsec;
+        entry.seqnum = record.seqnum;
+        entry.action = record.action <= static_cast<uint8_t>(DeviceAction::Change)
+                           ? static_cast<DeviceAction>(record.action) : DeviceAction::Change;
+        entry.device.devNode = readField(record.devNode);
+        entry.device.devPath = entry.device.devNode.empty() ? "" : "/dev/" + entry.device.devNode;
+        entry.device.subsystem = "tty";
+        entry.device.vendorId = readField(record.vendorId);
+        entry.device.productId = readField(record.productId);
+        entry.device.serial = readField(record.serial);
+        entry.device.kernelPath = readField(record.kernelPath);
+        entry.device.interfaceNum = readField(record.interfaceNum);
+        entry.symlink = readField(record.symlink);
+        entries.push_back(std::move(entry));
+    }
+    munmap(mapping, size);
+
+    std::sort(entries.begin(), entries.end(),
+              [](const Entry& a, const Entry& b) { return a.sequence < b.sequence; });
+    return OperationResult::Success();
+}
+
+} // namespace easytty
@@ -0,0 +1,55 @@
+#include "device/EventSource.hpp"
+#include "device/KernelEventSource.hpp"
+#include "device/ReplayEventSource.hpp"
+#include "device/UdevEventSource.hpp"
+#include "common/Utils.hpp"
+#include <cstdlib>
+#include <stdexcept>
+#include <unistd.h>
+
+namespace easytty {
+
+std::unique_ptr<EventSource> EventSource::create(const std::string& spec) {
+    if (spec.empty() || spec == "auto") {
+        // Without udevd the "udev" netlink group stays silent
+        if (udevdRunning()) {
+            return std::make_unique<UdevEventSource>();
+        }
+        return std::make_unique<KernelEventSource>();
+    }
+    if (spec == "udev") {
+        return std::make_unique<UdevEventSource>();
+    }
+    if (spec == "kernel") {
+        return std::make_unique<KernelEventSource>();
+    }
+    if (utils::startsWith(spec, "replay:")) {
+        // replay:<file>[@<speed>]
+        std::string path = spec.substr(7);
+        double speed = 1;
+        size_t at = path.rfind('@');
+        if (at != std::string::npos) {
+            auto parsed = ReplayEventSource::parseSpeed(path.substr(at + 1));
+            if (!parsed) {
+                throw std::runtime_error("Invalid replay speed '" + path.substr(at + 1) + "' (expected e.g. 1, 10 or max)");
+            }
+            speed = *parsed;
+            path = path.substr(0, at);
+        }
+        return ReplayEventSource::load(path, speed);
+    }
+    throw std::runtime_error("Unknown event source '" + spec +
+                             "' (expected auto, udev, kernel or replay:<file>[@speed])");
+}
+
+std::unique_ptr<EventSource> EventSource::createDefault() {
+    const char* spec = std::getenv(ENV_VAR);
+    return create(spec ? spec : "");
+}
+
+bool EventSource::udevdRunning() {
+    // udevd creates its control socket on start
+    return access("/run/udev/control", F_OK) == 0;
+}
+
+} // namespace easytty
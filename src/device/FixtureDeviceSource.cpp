@@ -0,0 +1,84 @@
+#include "device/FixtureDeviceSource.hpp"
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+namespace easytty {
+
+namespace {
+
+struct FieldBinding {
+    const char* name;
+    std::string DeviceInfo::*member;
+};
+
+const FieldBinding FIELDS[] = {
+    {"devPath", &DeviceInfo::devPath},
+    {"sysPath", &DeviceInfo::sysPath},
+    {"subsystem", &DeviceInfo::subsystem},
+    {"vendor", &DeviceInfo::vendor},
+    {"vendorId", &DeviceInfo::vendorId},
+    {"productId", &DeviceInfo::productId},
+    {"serial", &DeviceInfo::serial},
+    {"manufacturer", &DeviceInfo::manufacturer},
+    {"product", &DeviceInfo::product},
+    {"driver", &DeviceInfo::driver},
+    {"devNode", &DeviceInfo::devNode},
+    {"busNum", &DeviceInfo::busNum},
+    {"devNum", &DeviceInfo::devNum},
+    {"interfaceNum", &DeviceInfo::interfaceNum},
+    {"kernelPath", &DeviceInfo::kernelPath},
+};
+
+} // namespace
+
+DeviceInfo FixtureDeviceSource::deviceFromJson(const JsonValue& record) {
+    DeviceInfo device;
+    for (const auto& binding : FIELDS) {
+        if (const JsonValue* value = record.find(binding.name)) {
+            device.*binding.member = value->asString();
+        }
+    }
+    if (device.devNode.empty() && !device.devPath.empty()) {
+        device.devNode = device.devPath.substr(device.devPath.rfind('/') + 1);
+    }
+    if (device.subsystem.empty()) {
+        device.subsystem = "tty";
+    }
+    return device;
+}
+
+FixtureDeviceSource::FixtureDeviceSource(std::vector<DeviceInfo> devices)
+    : devices_(std::move(devices)) {}
+
+std::unique_ptr<FixtureDeviceSource> FixtureDeviceSource::load(const std::string& path) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        throw std::runtime_error("Cannot open device fixture: " + path);
+    }
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+
+    std::string error;
+    auto json = JsonValue::parse(buffer.str(), error);
+    if (!json) {
+        throw std::runtime_error("Invalid device fixture " + path + ": " + error);
+    }
+    if (!json->isArray()) {
+        throw std::runtime_error("Invalid device fixture " + path + ": expected an array of devices");
+    }
+
+    std::vector<DeviceInfo> devices;
+    for (const auto& record : json->array) {
+        if (!record.isObject()) continue;
+
+        DeviceInfo device = deviceFromJson(record);
+        if (device.isValid()) {
+            devices.push_back(device);
+        }
+    }
+
+    return std::make_unique<FixtureDeviceSource>(std::move(devices));
+}
+
+} // namespace easytty
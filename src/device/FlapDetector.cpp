@@ -0,0 +1,153 @@
+#include "device/FlapDetector.hpp"
+#include "device/EventLog.hpp"
+#include <algorithm>
+
+namespace easytty {
+
+namespace {
+
+// Hold times stop doubling here; 30 s << 7 is already over an hour
+constexpr unsigned MAX_BACKOFF = 16;
+
+} // namespace
+
+std::string FlapDetector::deviceKey(const DeviceInfo& device) {
+    if (device.vendorId.empty()) {
+        return device.devPath;
+    }
+    // Each tty of a multi-port adapter keeps its own state, so one replug
+    // of a quad adapter is not four attach/detach cycles of one device
+    if (!device.serial.empty()) {
+        return device.vendorId + ":" + device.productId + ":" + device.serial + "/" + device.interfaceNum;
+    }
+    if (!device.kernelPath.empty()) {
+        return device.vendorId + ":" + device.productId + "@" + device.kernelPath + "/" + device.interfaceNum;
+    }
+    return device.devPath;
+}
+
+uint64_t FlapDetector::holdFor(const State& state) const {
+    uint64_t hold = options_.holdUsec << state.backoff;
+    return std::min(hold, options_.maxHoldUsec);
+}
+
+FlapDetector::Transition FlapDetector::record(const DeviceEvent& event) {
+    if (event.action == DeviceAction::Change) {
+        return Transition::None;
+    }
+
+    State& state = states_[deviceKey(event.device)];
+    uint64_t now = event.timestampUsec;
+    if (event.device.isValid() || state.device.devPath.empty()) {
+        state.device = event.device;
+    }
+    state.transitions++;
+
+    Transition result = Transition::None;
+    if (state.flapping && now >= state.holdUntilUsec) {
+        // Nobody called expire() in between; catch up first
+        state.flapping = false;
+        state.stableSinceUsec = state.holdUntilUsec;
+        state.recent.clear();
+        result = Transition::Stopped;
+    }
+
+    if (state.flapping) {
+        state.suppressed++;
+        state.holdUntilUsec = now + holdFor(state);
+        return Transition::None;
+    }
+
+    state.recent.erase(std::remove_if(state.recent.begin(), state.recent.end(),
+                                      [&](uint64_t t) { return t + options_.windowUsec <= now; }),
+                       state.recent.end());
+    state.recent.push_back(now);
+    if (state.recent.size() < options_.threshold) {
+        return result;
+    }
+
+    // Relapsing soon after the last episode backs off further; a device
+    // that stayed stable for the longest hold starts over
+    if (state.flappingSinceUsec != 0 && now - state.stableSinceUsec < options_.maxHoldUsec) {
+        state.backoff = std::min(state.backoff + 1, MAX_BACKOFF);
+    } else {
+        state.backoff = 0;
+    }
+    state.flapping = true;
+    state.flappingSinceUsec = now;
+    state.suppressed = 0;
+    state.holdUntilUsec = now + holdFor(state);
+    return Transition::Started;
+}
+
+std::vector<DeviceInfo> FlapDetector::expire(uint64_t nowUsec) {
+    std::vector<DeviceInfo> stopped;
+    for (auto it = states_.begin(); it != states_.end();) {
+        State& state = it->second;
+        if (state.flapping && nowUsec >= state.holdUntilUsec) {
+            state.flapping = false;
+            state.stableSinceUsec = nowUsec;
+            state.recent.clear();
+            stopped.push_back(state.device);
+        }
+
+        // Forget devices with nothing left to remember, so a long-running
+        // watch does not accumulate every device it ever saw
+        bool windowEmpty = state.recent.empty() || state.recent.back() + options_.windowUsec <= nowUsec;
+        bool backoffOver = state.flappingSinceUsec == 0 ||
+                           nowUsec - state.stableSinceUsec >= options_.maxHoldUsec;
+        if (!state.flapping && windowEmpty && backoffOver) {
+            it = states_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    return stopped;
+}
+
+int FlapDetector::nextTimeoutMs(uint64_t nowUsec) const {
+    int timeout = -1;
+    for (const auto& [key, state] : states_) {
+        if (!state.flapping) continue;
+        uint64_t remaining = state.holdUntilUsec > nowUsec ? state.holdUntilUsec - nowUsec : 0;
+        int ms = static_cast<int>((remaining + 999) / 1000);
+        if (timeout < 0 || ms < timeout) {
+            timeout = ms;
+        }
+    }
+    return timeout;
+}
+
+bool FlapDetector::isFlapping(const DeviceInfo& device) const {
+    const State* state = find(device);
+    return state && state->flapping;
+}
+
+const FlapDetector::State* FlapDetector::find(const DeviceInfo& device) const {
+    auto it = states_.find(deviceKey(device));
+    return it != states_.end() ? &it->second : nullptr;
+}
+
+OperationResult FlapDetector::loadHistory(const std::string& path, uint64_t nowUsec) {
+    // Enough history to reconstruct the longest hold and its backoff
+    uint64_t span = std::max(options_.windowUsec, options_.maxHoldUsec);
+    std::vector<EventLog::Entry> entries;
+    auto result = EventLog::read(path, nowUsec > span ? nowUsec - span : 0, entries);
+    if (!result.success) {
+        return result;
+    }
+
+    for (const auto& entry : entries) {
+        DeviceEvent event;
+        event.action = entry.action;
+        event.device = entry.device;
+        event.seqnum = entry.seqnum;
+        event.timestampUsec = entry.timestampUsec;
+        event.initializedUsec = 0;
+        record(event);
+    }
+    expire(nowUsec);
+    return OperationResult::Success();
+}
+
+} // namespace easytty
@@ -0,0 +1,578 @@
+#include "device/HookDispatcher.hpp"
+#include "common/Utils.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <signal.h>
+#include <spawn.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char** environ;
+
+namespace easytty {
+
+namespace {
+
+// Hooks of one device share a key across renumbering (ttyUSB0 -> ttyUSB1)
+std::string deviceKey(const DeviceInfo& device) {
+    std::string key = device.vendorId + ":" + device.productId + ":";
+    if (!device.serial.empty()) {
+        key += device.serial;
+    } else if (!device.kernelPath.empty()) {
+        key += "@" + device.kernelPath;
+    } else {
+        key += device.devPath;
+    }
+    return key + "/" + device.interfaceNum;
+}
+
+bool triggers(HookDispatcher::Trigger trigger, DeviceAction action) {
+    switch (trigger) {
+        case HookDispatcher::Trigger::Attach: return action == DeviceAction::Add;
+        case HookDispatcher::Trigger::Detach: return action == DeviceAction::Remove;
+        case HookDispatcher::Trigger::Change: return action == DeviceAction::Change;
+        case HookDispatcher::Trigger::Any:    return true;
+    }
+    return false;
+}
+
+// 500ms, 10s, 2m
+bool parseMillis(const std::string& text, std::chrono::milliseconds& value) {
+    if (utils::endsWith(text, "ms")) {
+        char* end = nullptr;
+        unsigned long long amount = std::strtoull(text.c_str(), &end, 10);
+        if (end == text.c_str() || std::strcmp(end, "ms") != 0) {
+            return false;
+        }
+        value = std::chrono::milliseconds(amount);
+        return true;
+    }
+    uint64_t seconds = 0;
+    if (!utils::parseDuration(text, seconds)) {
+        return false;
+    }
+    value = std::chrono::seconds(seconds);
+    return true;
+}
+
+// Split on whitespace; "double quotes" group, \" and \\ escape inside them
+bool splitArgs(const std::string& text, std::vector<std::string>& args) {
+    std::string current;
+    bool inArg = false;
+    bool quoted = false;
+    for (size_t i = 0; i < text.size(); i++) {
+        char c = text[i];
+        if (quoted) {
+            if (c == '\\' && i + 1 < text.size() && (text[i + 1] == '"' || text[i + 1] == '\\')) {
+                current += text[++i];
+            } else if (c == '"') {
+                quoted = false;
+            } else {
+                current += c;
+            }
+        } else if (c == '"') {
+            quoted = inArg = true;
+        } else if (std::isspace(static_cast<unsigned char>(c))) {
+            if (inArg) {
+                args.push_back(current);
+                current.clear();
+                inArg = false;
+            }
+        } else {
+            current += c;
+            inArg = true;
+        }
+    }
+    if (quoted) {
+        return false;
+    }
+    if (inArg) {
+        args.push_back(current);
+    }
+    return true;
+}
+
+// Position of the first "=>" outside double quotes
+size_t findArrow(const std::string& line) {
+    bool quoted = false;
+    for (size_t i = 0; i + 1 < line.size(); i++) {
+        if (line[i] == '"') {
+            quoted = !quoted;
+        } else if (!quoted && line[i] == '=' && line[i + 1] == '>') {
+            return i;
+        }
+    }
+    return std::string::npos;
+}
+
+// Check the {placeholders} of an argument template
+bool checkArg(const std::string& arg, std::string& error) {
+    for (size_t open = arg.find('{'); open != std::string::npos; open = arg.find('{', open + 1)) {
+        size_t close = arg.find('}', open);
+        if (close == std::string::npos) {
+            error = "unterminated '{' in '" + arg + "'";
+            return false;
+        }
+        std::string name = arg.substr(open + 1, close - open - 1);
+        if (name == "action") continue;
+        auto field = Filter::findField(name);
+        if (!field) {
+            error = "unknown field '{" + name + "}'";
+            return false;
+        }
+        if (*field == Filter::Field::Name || *field == Filter::Field::FilePath) {
+            error = "'{" + name + "}' is not passed to hooks, use {symlink}";
+            return false;
+        }
+    }
+    return true;
+}
+
+std::string expandArg(const std::string& arg, const DeviceEvent& event, const std::string& symlink) {
+    std::string result;
+    size_t pos = 0;
+    for (size_t open = arg.find('{'); open != std::string::npos; open = arg.find('{', pos)) {
+        size_t close = arg.find('}', open);
+        std::string name = arg.substr(open + 1, close - open - 1);
+        result.append(arg, pos, open - pos);
+        if (name == "action") {
+            result += toString(event.action);
+        } else {
+            Filter::Field field = *Filter::findField(name);
+            result += field == Filter::Field::Symlink ? symlink : Filter::fieldValue(event.device, field);
+        }
+        pos = close + 1;
+    }
+    result.append(arg, pos, std::string::npos);
+    return result;
+}
+
+void appendJsonString(std::string& out, const char* name, const std::string& value) {
+    out += '"';
+    out += name;
+    out += "\":\"";
+    for (char c : value) {
+        switch (c) {
+            case '"':  out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char escaped[8];
+                    std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                    out += escaped;
+                } else {
+                    out += c;
+                }
+        }
+    }
+    out += "\",";
+}
+
+} // namespace
+
+std::optional<std::vector<HookDispatcher::Hook>> HookDispatcher::load(const std::string& path, std::string& error) {
+    std::ifstream in(path);
+    if (!in.is_open()) {
+        error = "Cannot read hooks file " + path;
+        return std::nullopt;
+    }
+    auto hooks = parse(in, error);
+    if (!hooks) {
+        error = path + ": " + error;
+    }
+    return hooks;
+}
+
+std::optional<std::vector<HookDispatcher::Hook>> HookDispatcher::parse(std::istream& in, std::string& error) {
+    std::vector<Hook> hooks;
+    std::string line;
+    int lineNum = 0;
+    while (std::getline(in, line)) {
+        lineNum++;
+        line = utils::trim(line);
+        if (line.empty() || line[0] == '#') continue;
+
+        auto fail = [&](const std::string& problem) {
+            error = "line " + std::to_string(lineNum) + ": " + problem;
+            return std::nullopt;
+        };
+
+        size_t arrow = findArrow(line);
+        if (arrow == std::string::npos) {
+            return fail("expected '<event> [<filter>] => exec <program> ...' or '... => socket <path>'");
+        }
+
+        Hook hook;
+        hook.line = lineNum;
+
+        // Event, then options, then the filter
+        std::string head = utils::trim(line.substr(0, arrow));
+        size_t pos = 0;
+        auto nextWord = [&]() {
+            while (pos < head.size() && std::isspace(static_cast<unsigned char>(head[pos]))) pos++;
+            size_t start = pos;
+            while (pos < head.size() && !std::isspace(static_cast<unsigned char>(head[pos]))) pos++;
+            return head.substr(start, pos - start);
+        };
+
+        std::string trigger = nextWord();
+        if (trigger == "attach") {
+            hook.trigger = Trigger::Attach;
+        } else if (trigger == "detach") {
+            hook.trigger = Trigger::Detach;
+        } else if (trigger == "change") {
+            hook.trigger = Trigger::Change;
+        } else if (trigger == "any") {
+            hook.trigger = Trigger::Any;
+        } else {
+            return fail("unknown event '" + trigger + "' (attach, detach, change or any)");
+        }
+
+        while (true) {
+            size_t save = pos;
+            std::string word = nextWord();
+            bool isTimeout = utils::startsWith(word, "timeout=");
+            bool isDebounce = utils::startsWith(word, "debounce=");
+            if (!isTimeout && !isDebounce) {
+                pos = save;
+                break;
+            }
+            std::string value = word.substr(word.find('=') + 1);
+            if (!parseMillis(value, isTimeout ? hook.timeout : hook.debounce)) {
+                return fail("invalid time '" + value + "' (e.g. 500ms, 10s or 2m)");
+            }
+        }
+        if (hook.timeout.count() == 0) {
+            return fail("timeout must be more than zero");
+        }
+
+        std::string filterText = utils::trim(head.substr(pos));
+        if (!filterText.empty()) {
+            std::string problem;
+            auto filter = Filter::compile(filterText, problem);
+            if (!filter) {
+                return fail(problem);
+            }
+            hook.filter = std::move(*filter);
+        }
+
+        std::vector<std::string> action;
+        if (!splitArgs(line.substr(arrow + 2), action)) {
+            return fail("unterminated quote");
+        }
+        if (action.size() < 2) {
+            return fail("expected 'exec <program> [args...]' or 'socket <path>'");
+        }
+        if (action[0] == "exec") {
+            hook.type = ActionType::Exec;
+            hook.argv.assign(action.begin() + 1, action.end());
+            for (const auto& arg : hook.argv) {
+                std::string problem;
+                if (!checkArg(arg, problem)) {
+                    return fail(problem);
+                }
+            }
+        } else if (action[0] == "socket" && action.size() == 2) {
+            hook.type = ActionType::Socket;
+            hook.socketPath = action[1];
+            if (hook.socketPath.size() >= sizeof(sockaddr_un::sun_path)) {
+                return fail("socket path too long");
+            }
+        } else {
+            return fail("expected 'exec <program> [args...]' or 'socket <path>'");
+        }
+        hooks.push_back(std::move(hook));
+    }
+    return hooks;
+}
+
+HookDispatcher::HookDispatcher(std::vector<Hook> hooks, const Options& options,
+                               std::function<void(const Result&)> onResult)
+    : hooks_(std::move(hooks)), options_(options), onResult_(std::move(onResult)) {
+    for (size_t i = 0; i < std::max<size_t>(1, options_.workers); i++) {
+        workers_.emplace_back(&HookDispatcher::work, this);
+    }
+}
+
+HookDispatcher::~HookDispatcher() {
+    shutdown();
+}
+
+size_t HookDispatcher::submit(const DeviceEvent& event, const UdevRule* rule) {
+    size_t triggered = 0;
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (stopping_) {
+        return 0;
+    }
+
+    auto now = Clock::now();
+    std::string device = deviceKey(event.device);
+    for (size_t i = 0; i < hooks_.size(); i++) {
+        const Hook& hook = hooks_[i];
+        if (!triggers(hook.trigger, event.action) || !hook.filter.matches(event.device, rule)) continue;
+        triggered++;
+
+        std::string key = std::to_string(i) + "|" + device;
+        auto it = pending_.find(key);
+        if (it != pending_.end()) {
+            // Still waiting out the debounce: the newer event replaces it
+            it->second.event = event;
+            it->second.symlink = rule ? rule->symlink : "";
+            it->second.due = now + hook.debounce;
+            it->second.superseded++;
+            stats_.superseded++;
+            continue;
+        }
+        if (pending_.size() >= options_.maxPending) {
+            stats_.dropped++;
+            continue;
+        }
+        pending_.emplace(key, Job{i, event, rule ? rule->symlink : "", now + hook.debounce, 0});
+        stats_.queued++;
+    }
+    if (triggered > 0) {
+        wake_.notify_all();
+    }
+    return triggered;
+}
+
+void HookDispatcher::shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stopping_ && workers_.empty()) {
+            return;
+        }
+        stopping_ = true;
+        stats_.dropped += pending_.size();
+        pending_.clear();
+    }
+    wake_.notify_all();
+    for (auto& worker : workers_) {
+        worker.join();
+    }
+    workers_.clear();
+}
+
+HookDispatcher::Stats HookDispatcher::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+void HookDispatcher::work() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stopping_) {
+        // Earliest job whose hook/device is not already running
+        auto next = pending_.end();
+        for (auto it = pending_.begin(); it != pending_.end(); ++it) {
+            if (running_.count(it->first)) continue;
+            if (next == pending_.end() || it->second.due < next->second.due) {
+                next = it;
+            }
+        }
+        if (next == pending_.end()) {
+            wake_.wait(lock);
+            continue;
+        }
+        if (next->second.due > Clock::now()) {
+            wake_.wait_until(lock, next->second.due);
+            continue;
+        }
+
+        std::string key = next->first;
+        Job job = std::move(next->second);
+        pending_.erase(next);
+        running_.insert(key);
+        lock.unlock();
+
+        Result result = run(job);
+        {
+            std::lock_guard<std::mutex> resultLock(resultMutex_);
+            if (onResult_) {
+                onResult_(result);
+            }
+        }
+
+        lock.lock();
+        running_.erase(key);
+        (result.success ? stats_.succeeded : stats_.failed)++;
+        if (result.timedOut) {
+            stats_.timedOut++;
+        }
+        // A job for this key may have been held back while this one ran
+        wake_.notify_all();
+    }
+}
+
+HookDispatcher::Result HookDispatcher::run(const Job& job) const {
+    const Hook& hook = hooks_[job.hook];
+    auto start = Clock::now();
+    Result result = hook.type == ActionType::Exec ? runExec(hook, job) : runSocket(hook, job);
+    result.hook = &hook;
+    result.event = job.event;
+    result.symlink = job.symlink;
+    result.superseded = job.superseded;
+    result.duration = std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - start);
+    return result;
+}
+
+HookDispatcher::Result HookDispatcher::runExec(const Hook& hook, const Job& job) const {
+    Result result;
+    const DeviceInfo& device = job.event.device;
+
+    std::vector<std::string> args;
+    for (const auto& arg : hook.argv) {
+        args.push_back(expandArg(arg, job.event, job.symlink));
+    }
+    std::vector<std::string> env;
+    for (char** var = environ; *var; var++) {
+        if (!utils::startsWith(*var, "EASYTTY_")) {
+            env.push_back(*var);
+        }
+    }
+    env.push_back(std::string("EASYTTY_ACTION=") + toString(job.event.action));
+    env.push_back("EASYTTY_DEVPATH=" + device.devPath);
+    env.push_back("EASYTTY_SYMLINK=" + job.symlink);
+    env.push_back("EASYTTY_VENDOR_ID=" + device.vendorId);
+    env.push_back("EASYTTY_PRODUCT_ID=" + device.productId);
+    env.push_back("EASYTTY_SERIAL=" + device.serial);
+    env.push_back("EASYTTY_PORT=" + device.kernelPath);
+    env.push_back("EASYTTY_INTERFACE=" + device.interfaceNum);
+    env.push_back("EASYTTY_SEQNUM=" + std::to_string(job.event.seqnum));
+    env.push_back("EASYTTY_SUPERSEDED=" + std::to_string(job.superseded));
+
+    std::vector<char*> argvPtrs;
+    for (auto& arg : args) argvPtrs.push_back(arg.data());
+    argvPtrs.push_back(nullptr);
+    std::vector<char*> envPtrs;
+    for (auto& var : env) envPtrs.push_back(var.data());
+    envPtrs.push_back(nullptr);
+
+    // No shell; stdout would mix into --watch output, so it goes nowhere.
+    // A process group of its own lets a timeout kill whatever it started.
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_addopen(&actions, STDIN_FILENO, "/dev/null", O_RDONLY, 0);
+    posix_spawn_file_actions_addopen(&actions, STDOUT_FILENO, "/dev/null", O_WRONLY, 0);
+    posix_spawnattr_t attr;
+    posix_spawnattr_init(&attr);
+    posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETPGROUP);
+    posix_spawnattr_setpgroup(&attr, 0);
+
+    pid_t pid = -1;
+    int rc = posix_spawnp(&pid, argvPtrs[0], &actions, &attr, argvPtrs.data(), envPtrs.data());
+    posix_spawn_file_actions_destroy(&actions);
+    posix_spawnattr_destroy(&attr);
+    if (rc != 0) {
+        result.message = "cannot run " + hook.argv[0] + ": " + std::strerror(rc);
+        return result;
+    }
+
+    auto deadline = Clock::now() + hook.timeout;
+    auto pollInterval = std::chrono::milliseconds(1);
+    int status = 0;
+    while (true) {
+        pid_t done = waitpid(pid, &status, WNOHANG);
+        if (done == pid || (done < 0 && errno != EINTR)) {
+            break;
+        }
+        auto now = Clock::now();
+        if (now >= deadline) {
+            result.timedOut = true;
+            kill(-pid, SIGTERM);
+            // A second to clean up, then it goes
+            for (int i = 0; i < 100 && waitpid(pid, &status, WNOHANG) == 0; i++) {
+                usleep(10000);
+            }
+            kill(-pid, SIGKILL);
+            waitpid(pid, &status, 0);
+            break;
+        }
+        std::this_thread::sleep_for(std::min<Clock::duration>(pollInterval, deadline - now));
+        pollInterval = std::min(pollInterval * 2, std::chrono::milliseconds(50));
+    }
+
+    if (WIFEXITED(status)) {
+        result.exitStatus = WEXITSTATUS(status);
+    } else if (WIFSIGNALED(status)) {
+        result.exitStatus = -WTERMSIG(status);
+    }
+    result.success = !result.timedOut && WIFEXITED(status) && result.exitStatus == 0;
+    if (result.timedOut) {
+        result.message = "timed out after " + std::to_string(hook.timeout.count()) + " ms";
+    } else if (!result.success) {
+        result.message = result.exitStatus < 0 ? "killed by signal " + std::to_string(-result.exitStatus)
+                                               : "exit status " + std::to_string(result.exitStatus);
+    }
+    return result;
+}
+
+HookDispatcher::Result HookDispatcher::runSocket(const Hook& hook, const Job& job) const {
+    Result result;
+    const DeviceInfo& device = job.event.device;
+
+    std::string line = "{";
+    appendJsonString(line, "action", toString(job.event.action));
+    line += "\"seqnum\":" + std::to_string(job.event.seqnum) + ",";
+    line += "\"timestamp\":" + std::to_string(job.event.timestampUsec) + ",";
+    appendJsonString(line, "symlink", job.symlink);
+    appendJsonString(line, "devPath", device.devPath);
+    appendJsonString(line, "vendorId", device.vendorId);
+    appendJsonString(line, "productId", device.productId);
+    appendJsonString(line, "serial", device.serial);
+    appendJsonString(line, "kernelPath", device.kernelPath);
+    appendJsonString(line, "interfaceNum", device.interfaceNum);
+    line += "\"superseded\":" + std::to_string(job.superseded) + "}\n";
+
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    std::strncpy(addr.sun_path, hook.socketPath.c_str(), sizeof(addr.sun_path) - 1);
+
+    // Stream sockets first; a datagram listener refuses with EPROTOTYPE
+    int fd = -1;
+    for (int type : {SOCK_STREAM, SOCK_DGRAM}) {
+        fd = socket(AF_UNIX, type | SOCK_CLOEXEC, 0);
+        if (fd < 0) break;
+        timeval tv{static_cast<time_t>(hook.timeout.count() / 1000),
+                   static_cast<suseconds_t>((hook.timeout.count() % 1000) * 1000)};
+        setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+        if (connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0) break;
+        int err = errno;
+        close(fd);
+        fd = -1;
+        errno = err;
+        if (err != EPROTOTYPE) break;
+    }
+    if (fd < 0) {
+        result.message = "cannot connect to " + hook.socketPath + ": " + std::strerror(errno);
+        return result;
+    }
+
+    size_t written = 0;
+    while (written < line.size()) {
+        ssize_t n = send(fd, line.data() + written, line.size() - written, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            result.timedOut = errno == EAGAIN || errno == EWOULDBLOCK;
+            result.message = result.timedOut ? "timed out writing to " + hook.socketPath
+                                             : "cannot write to " + hook.socketPath + ": " + std::strerror(errno);
+            close(fd);
+            return result;
+        }
+        written += static_cast<size_t>(n);
+    }
+    close(fd);
+    result.success = true;
+    return result;
+}
+
+} // namespace easytty
@@ -0,0 +1,174 @@
+#include "device/KernelEventSource.hpp"
+#include "device/SysfsDeviceSource.hpp"
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <linux/netlink.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace easytty {
+
+namespace {
+
+// Multicast group the kernel sends uevents to (udevd re-broadcasts on 2)
+constexpr unsigned KERNEL_GROUP = 1;
+
+uint64_t parseNumber(std::string_view text) {
+    uint64_t value = 0;
+    for (char c : text) {
+        if (c < '0' || c > '9') break;
+        value = value * 10 + static_cast<uint64_t>(c - '0');
+    }
+    return value;
+}
+
+} // namespace
+
+KernelEventSource::KernelEventSource() : fd_(-1) {
+}
+
+KernelEventSource::~KernelEventSource() {
+    if (fd_ >= 0) {
+        close(fd_);
+    }
+}
+
+bool KernelEventSource::start() {
+    if (fd_ >= 0) {
+        return true;
+    }
+
+    fd_ = socket(AF_NETLINK, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, NETLINK_KOBJECT_UEVENT);
+    if (fd_ < 0) {
+        return false;
+    }
+
+    // Hub power cycles deliver bursts; FORCE needs CAP_NET_ADMIN, the
+    // plain option is capped by net.core.rmem_max
+    int size = 4 * 1024 * 1024;
+    if (setsockopt(fd_, SOL_SOCKET, SO_RCVBUFFORCE, &size, sizeof(size)) < 0) {
+        setsockopt(fd_, SOL_SOCKET, SO_RCVBUF, &size, sizeof(size));
+    }
+
+    struct sockaddr_nl addr = {};
+    addr.nl_family = AF_NETLINK;
+    addr.nl_groups = KERNEL_GROUP;
+    if (bind(fd_, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) < 0) {
+        close(fd_);
+        fd_ = -1;
+        return false;
+    }
+
+    return true;
+}
+
+std::optional<KernelEventSource::Uevent> KernelEventSource::parse(std::string_view message) {
+    // Header "action@devpath"; libudev messages start with "libudev\0"
+    size_t headerEnd = message.find('\0');
+    std::string_view header = message.substr(0, headerEnd);
+    if (headerEnd == std::string_view::npos || header.find('@') == std::string_view::npos) {
+        return std::nullopt;
+    }
+
+    Uevent event;
+    size_t pos = headerEnd + 1;
+    while (pos < message.size()) {
+        size_t end = message.find('\0', pos);
+        if (end == std::string_view::npos) {
+            end = message.size();
+        }
+        std::string_view entry = message.substr(pos, end - pos);
+        pos = end + 1;
+
+        size_t eq = entry.find('=');
+        if (eq == std::string_view::npos) continue;
+        std::string_view key = entry.substr(0, eq);
+        std::string_view value = entry.substr(eq + 1);
+        if (key == "ACTION") {
+            event.action = value;
+        } else if (key == "DEVPATH") {
+            event.devPath = value;
+        } else if (key == "SUBSYSTEM") {
+            event.subsystem = value;
+        } else if (key == "DEVNAME") {
+            event.devName = value;
+        } else if (key == "SEQNUM") {
+            event.seqnum = parseNumber(value);
+        }
+    }
+
+    if (event.action.empty() || event.devPath.empty()) {
+        return std::nullopt;
+    }
+    return event;
+}
+
+std::optional<DeviceEvent> KernelEventSource::receive() {
+    if (fd_ < 0) {
+        return std::nullopt;
+    }
+
+    struct sockaddr_nl sender = {};
+    struct iovec iov = {buffer_, sizeof(buffer_)};
+    struct msghdr msg = {};
+    msg.msg_name = &sender;
+    msg.msg_namelen = sizeof(sender);
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+
+    ssize_t length = recvmsg(fd_, &msg, MSG_DONTWAIT);
+    // Only the kernel (port 0) may speak on this group
+    if (length <= 0 || sender.nl_pid != 0 || (msg.msg_flags & MSG_TRUNC)) {
+        return std::nullopt;
+    }
+
+    auto uevent = parse(std::string_view(buffer_, static_cast<size_t>(length)));
+    if (!uevent || uevent->subsystem != "tty" || uevent->devName.empty()) {
+        return std::nullopt;
+    }
+
+    // First copy: only serial devices get this far
+    std::string devPath = "/dev/" + std::string(uevent->devName);
+    if (!DeviceSource::isSerialDevNode(devPath)) {
+        return std::nullopt;
+    }
+
+    DeviceEvent event;
+    if (uevent->action == "add") {
+        event.action = DeviceAction::Add;
+    } else if (uevent->action == "remove") {
+        event.action = DeviceAction::Remove;
+    } else {
+        event.action = DeviceAction::Change;
+    }
+    event.seqnum = uevent->seqnum;
+    event.timestampUsec = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    // No udevd, so nothing to measure attach latency from
+    event.initializedUsec = 0;
+
+    if (event.action != DeviceAction::Remove) {
+        // The USB parents are registered before their tty child, so the
+        // attributes are already in sysfs
+        try {
+            if (!sysfs_) {
+                sysfs_ = std::make_unique<SysfsDeviceSource>("/");
+            }
+            if (auto device = sysfs_->lookup(devPath)) {
+                event.device = *device;
+                return event;
+            }
+        } catch (const std::exception&) {
+            // No /sys mounted: report what the uevent carries
+        }
+    }
+
+    event.device.devPath = devPath;
+    event.device.devNode = std::string(uevent->devName);
+    event.device.sysPath = "/sys" + std::string(uevent->devPath);
+    event.device.subsystem = "tty";
+    return event;
+}
+
+} // namespace easytty
@@ -0,0 +1,213 @@
+#include "device/LatencyTracker.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <ctime>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+namespace easytty {
+
+namespace {
+
+uint64_t clockUsec(clockid_t clock) {
+    struct timespec ts;
+    clock_gettime(clock, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000 + static_cast<uint64_t>(ts.tv_nsec) / 1000;
+}
+
+// Symlink ctimes are wall clock; translate them onto CLOCK_MONOTONIC
+uint64_t realtimeToMonotonic(const struct timespec& ts) {
+    uint64_t real = static_cast<uint64_t>(ts.tv_sec) * 1000000 + static_cast<uint64_t>(ts.tv_nsec) / 1000;
+    uint64_t nowReal = clockUsec(CLOCK_REALTIME);
+    uint64_t nowMono = clockUsec(CLOCK_MONOTONIC);
+    uint64_t age = nowReal > real ? nowReal - real : 0;
+    return nowMono > age ? nowMono - age : 0;
+}
+
+const LatencyTracker::Stage STAGES[] = {
+    LatencyTracker::Stage::Udev, LatencyTracker::Stage::Symlink, LatencyTracker::Stage::Ready
+};
+
+} // namespace
+
+const char* LatencyTracker::stageName(Stage stage) {
+    switch (stage) {
+        case Stage::Udev:    return "udev";
+        case Stage::Symlink: return "symlink";
+        case Stage::Ready:   return "ready";
+    }
+    return "unknown";
+}
+
+void LatencyTracker::onEvent(const DeviceEvent& event, const UdevRule* rule) {
+    if (event.action == DeviceAction::Change) {
+        return;
+    }
+
+    // A detach or a fresh attach ends any measurement still running
+    const std::string& devPath = event.device.devPath;
+    pending_.erase(std::remove_if(pending_.begin(), pending_.end(),
+                                  [&devPath](const Pending& p) { return p.devPath == devPath; }),
+                   pending_.end());
+
+    if (event.action != DeviceAction::Add) {
+        return;
+    }
+
+    uint64_t now = clockUsec(CLOCK_MONOTONIC);
+    Pending pending;
+    pending.devPath = devPath;
+    pending.symlink = rule ? rule->symlink : "";
+    pending.driver = event.device.driver;
+    pending.baseUsec = event.initializedUsec && event.initializedUsec <= now ? event.initializedUsec : now;
+    pending.receivedUsec = now;
+    pending.symlinkSeen = false;
+
+    if (event.initializedUsec) {
+        recordStage(pending, Stage::Udev, now);
+    }
+    pending_.push_back(pending);
+    update();
+}
+
+void LatencyTracker::update() {
+    uint64_t now = clockUsec(CLOCK_MONOTONIC);
+
+    for (auto it = pending_.begin(); it != pending_.end();) {
+        Pending& p = *it;
+
+        if (!p.symlink.empty() && !p.symlinkSeen) {
+            std::string link = "/dev/" + p.symlink;
+            struct stat st;
+            char resolved[PATH_MAX];
+            if (lstat(link.c_str(), &st) == 0 && realpath(link.c_str(), resolved) &&
+                p.devPath == resolved) {
+                p.symlinkSeen = true;
+                // Inode times come from the coarse clock (one timer tick)
+                recordStage(p, Stage::Symlink, std::max(p.baseUsec, realtimeToMonotonic(st.st_ctim)));
+            }
+        }
+
+        bool done = false;
+        if (p.symlink.empty() || p.symlinkSeen) {
+            // Never open the port: opening raises DTR/RTS, which resets
+            // Arduino-class boards. A node we may read and write is ready.
+            const std::string path = p.symlink.empty() ? p.devPath : "/dev/" + p.symlink;
+            struct stat st;
+            if (stat(path.c_str(), &st) == 0 && S_ISCHR(st.st_mode) &&
+                access(path.c_str(), R_OK | W_OK) == 0) {
+                recordStage(p, Stage::Ready, clockUsec(CLOCK_MONOTONIC));
+                done = true;
+            }
+        }
+
+        if (done || now - p.receivedUsec > GIVE_UP_USEC) {
+            it = pending_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+int LatencyTracker::nextTimeoutMs() const {
+    return pending_.empty() ? -1 : RETRY_INTERVAL_MS;
+}
+
+bool LatencyTracker::takeChanged() {
+    bool changed = changed_;
+    changed_ = false;
+    return changed;
+}
+
+void LatencyTracker::recordStage(const Pending& pending, Stage stage, uint64_t atUsec) {
+    uint64_t latency = atUsec > pending.baseUsec ? atUsec - pending.baseUsec : 0;
+    size_t index = static_cast<size_t>(stage);
+    if (!pending.symlink.empty()) {
+        byRule_[pending.symlink][index].record(latency);
+    }
+    byDriver_[pending.driver.empty() ? "unknown" : pending.driver][index].record(latency);
+    changed_ = true;
+}
+
+OperationResult LatencyTracker::save(const std::string& path) const {
+    std::error_code ec;
+    fs::create_directories(fs::path(path).parent_path(), ec);
+
+    std::string tmpPath = path + ".tmp";
+    {
+        std::ofstream out(tmpPath, std::ios::trunc);
+        if (!out.is_open()) {
+            return OperationResult::Failure("Cannot write " + tmpPath + ": " + std::strerror(errno));
+        }
+        out << "# easyTTY attach latency histograms (usec since udev initialized the device)\n";
+        auto writeGroup = [&out](const char* group, const std::map<std::string, StageHistograms>& map) {
+            for (const auto& entry : map) {
+                for (Stage stage : STAGES) {
+                    const Histogram& h = entry.second[static_cast<size_t>(stage)];
+                    if (h.count()) {
+                        out << group << ' ' << entry.first << ' ' << stageName(stage) << ' '
+                            << h.serialize() << '\n';
+                    }
+                }
+            }
+        };
+        writeGroup("rule", byRule_);
+        writeGroup("driver", byDriver_);
+        if (!out) {
+            return OperationResult::Failure("Cannot write " + tmpPath);
+        }
+    }
+
+    if (rename(tmpPath.c_str(), path.c_str()) != 0) {
+        return OperationResult::Failure("Cannot replace " + path + ": " + std::strerror(errno));
+    }
+    return OperationResult::Success();
+}
+
+bool LatencyTracker::load(const std::string& path) {
+    std::ifstream in(path);
+    if (!in.is_open()) {
+        return false;
+    }
+
+    byRule_.clear();
+    byDriver_.clear();
+
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        std::istringstream fields(line);
+        std::string group, name, stage, rest;
+        if (!(fields >> group >> name >> stage)) {
+            continue;
+        }
+        std::getline(fields, rest);
+
+        auto* map = group == "rule" ? &byRule_ : group == "driver" ? &byDriver_ : nullptr;
+        // State files written before the ready stage called it "open"
+        if (stage == "open") {
+            stage = stageName(Stage::Ready);
+        }
+        for (Stage s : STAGES) {
+            if (map && stage == stageName(s)) {
+                Histogram h;
+                if (h.deserialize(rest)) {
+                    (*map)[name][static_cast<size_t>(s)] = h;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+} // namespace easytty
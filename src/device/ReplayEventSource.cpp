@@ -0,0 +1,182 @@
+#include "device/ReplayEventSource.hpp"
+#include "device/FixtureDeviceSource.hpp"
+#include "common/Json.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <stdexcept>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+namespace easytty {
+
+namespace {
+
+uint64_t nowUsec() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+std::optional<DeviceAction> parseAction(const std::string& text) {
+    if (text == "add") return DeviceAction::Add;
+    if (text == "remove") return DeviceAction::Remove;
+    if (text == "change") return DeviceAction::Change;
+    return std::nullopt;
+}
+
+} // namespace
+
+ReplayEventSource::ReplayEventSource(std::vector<DeviceEvent> trace, double speed, size_t queueCapacity)
+    : trace_(std::move(trace)), speed_(speed), queueCapacity_(queueCapacity), fd_(-1),
+      producerDone_(false), stopping_(false) {
+    stats_.events = trace_.size();
+}
+
+ReplayEventSource::~ReplayEventSource() {
+    stopping_ = true;
+    if (producer_.joinable()) {
+        producer_.join();
+    }
+    if (fd_ >= 0) {
+        close(fd_);
+    }
+}
+
+std::unique_ptr<ReplayEventSource> ReplayEventSource::load(const std::string& path, double speed) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        throw std::runtime_error("Cannot open event trace: " + path);
+    }
+
+    std::vector<DeviceEvent> trace;
+    std::string line;
+    size_t lineNumber = 0;
+    while (std::getline(file, line)) {
+        lineNumber++;
+        if (line.find_first_not_of(" \t\r") == std::string::npos) continue;
+
+        std::string error;
+        auto record = JsonValue::parse(line, error);
+        if (!record || !record->isObject()) {
+            throw std::runtime_error("Invalid event trace " + path + " line " + std::to_string(lineNumber) +
+                                     (error.empty() ? ": expected an object" : ": " + error));
+        }
+
+        DeviceEvent event;
+        const JsonValue* action = record->find("action");
+        const JsonValue* device = record->find("device");
+        if (!action || !device || !device->isObject()) {
+            throw std::runtime_error("Invalid event trace " + path + " line " + std::to_string(lineNumber) +
+                                     ": expected the records of --watch --format ndjson");
+        }
+        // --watch also reports flapping/stable states; those are not events
+        auto parsed = parseAction(action->asString());
+        if (!parsed) continue;
+        event.action = *parsed;
+        event.device = FixtureDeviceSource::deviceFromJson(*device);
+        const JsonValue* seqnum = record->find("seqnum");
+        const JsonValue* timestamp = record->find("timestamp");
+        event.seqnum = seqnum ? static_cast<uint64_t>(seqnum->number) : 0;
+        event.timestampUsec = timestamp ? static_cast<uint64_t>(timestamp->number) : 0;
+        event.initializedUsec = 0;
+        trace.push_back(std::move(event));
+    }
+
+    // Traces concatenated from several runs must still replay in order
+    std::stable_sort(trace.begin(), trace.end(), [](const DeviceEvent& a, const DeviceEvent& b) {
+        return a.timestampUsec < b.timestampUsec;
+    });
+    return std::make_unique<ReplayEventSource>(std::move(trace), speed);
+}
+
+std::optional<double> ReplayEventSource::parseSpeed(const std::string& text) {
+    if (text == "max") {
+        return MAX_SPEED;
+    }
+    char* end = nullptr;
+    double speed = std::strtod(text.c_str(), &end);
+    if (end == text.c_str() || speed <= 0 || !(end[0] == '\0' || (end[0] == 'x' && end[1] == '\0'))) {
+        return std::nullopt;
+    }
+    return speed;
+}
+
+bool ReplayEventSource::start() {
+    if (fd_ >= 0) {
+        return true;
+    }
+    fd_ = eventfd(0, EFD_SEMAPHORE | EFD_NONBLOCK | EFD_CLOEXEC);
+    if (fd_ < 0) {
+        return false;
+    }
+    producer_ = std::thread(&ReplayEventSource::produce, this);
+    return true;
+}
+
+void ReplayEventSource::produce() {
+    auto start = std::chrono::steady_clock::now();
+    uint64_t firstUsec = trace_.empty() ? 0 : trace_.front().timestampUsec;
+
+    for (const auto& recorded : trace_) {
+        if (stopping_) break;
+
+        if (speed_ != MAX_SPEED) {
+            auto offset = std::chrono::microseconds(
+                static_cast<int64_t>((recorded.timestampUsec - firstUsec) / speed_));
+            // Sleep in slices so destruction is not held up by long gaps
+            while (!stopping_ && std::chrono::steady_clock::now() < start + offset) {
+                std::this_thread::sleep_until(
+                    std::min(start + offset, std::chrono::steady_clock::now() + std::chrono::milliseconds(100)));
+            }
+        }
+
+        DeviceEvent event = recorded;
+        event.timestampUsec = nowUsec();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stats_.queued++;
+            if (queue_.size() >= queueCapacity_) {
+                stats_.dropped++;
+                continue;
+            }
+            queue_.push_back(std::move(event));
+            stats_.maxQueueDepth = std::max(stats_.maxQueueDepth, queue_.size());
+        }
+        // Cannot fail: the counter never exceeds the queue capacity
+        uint64_t one = 1;
+        (void)!write(fd_, &one, sizeof(one));
+    }
+    producerDone_ = true;
+}
+
+std::optional<DeviceEvent> ReplayEventSource::receive() {
+    uint64_t value;
+    if (fd_ < 0 || read(fd_, &value, sizeof(value)) != static_cast<ssize_t>(sizeof(value))) {
+        return std::nullopt;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (queue_.empty()) {
+        return std::nullopt;
+    }
+    DeviceEvent event = std::move(queue_.front());
+    queue_.pop_front();
+    stats_.delivered++;
+    return event;
+}
+
+bool ReplayEventSource::finished() const {
+    if (!producerDone_) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    return queue_.empty();
+}
+
+ReplayEventSource::Stats ReplayEventSource::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+} // namespace easytty
@@ -0,0 +1,222 @@
+#include "device/SysfsDeviceSource.hpp"
+#include "common/TarWriter.hpp"
+#include "common/Utils.hpp"
+#include "common/Trace.hpp"
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+namespace easytty {
+
+namespace {
+
+// Attributes the detector reads, captured into snapshots
+const char* const SNAPSHOT_ATTRS[] = {
+    "dev", "uevent", "idVendor", "idProduct", "serial", "manufacturer", "product",
+    "busnum", "devnum", "bInterfaceNumber", "bInterfaceClass", "interface", "devpath",
+};
+const char* const SNAPSHOT_LINKS[] = {"driver", "subsystem"};
+
+// Attributes are tiny; a plain read avoids the stream setup per file
+bool readAttr(const fs::path& path, std::string& value) {
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    // Read to EOF: USB string descriptors can run to 126 UTF-8 encoded
+    // characters, and snapshot files may hold anything
+    std::string content;
+    char buffer[256];
+    ssize_t n;
+    while ((n = read(fd, buffer, sizeof(buffer))) > 0 || (n < 0 && errno == EINTR)) {
+        if (n > 0) {
+            content.append(buffer, static_cast<size_t>(n));
+        }
+    }
+    close(fd);
+    value = utils::trim(content);
+    return true;
+}
+
+std::string readAttr(const fs::path& path) {
+    std::string value;
+    readAttr(path, value);
+    return value;
+}
+
+std::string linkName(const fs::path& path) {
+    std::error_code ec;
+    fs::path target = fs::read_symlink(path, ec);
+    return ec ? "" : target.filename().string();
+}
+
+// Strip the root so sysPath looks like the live /sys path
+std::string relativeTo(const fs::path& path, const fs::path& root) {
+    std::string text = path.string();
+    std::string prefix = root.string();
+    if (prefix != "/" && utils::startsWith(text, prefix)) {
+        text = text.substr(prefix.size());
+    }
+    return text;
+}
+
+} // namespace
+
+SysfsDeviceSource::SysfsDeviceSource(const std::string& root)
+    : root_(root.empty() ? "/" : root) {
+    if (!fs::is_directory(fs::path(root_) / "sys/class/tty")) {
+        throw std::runtime_error("No sys/class/tty below " + root_);
+    }
+    root_ = fs::canonical(root_).string();
+}
+
+std::vector<DeviceInfo> SysfsDeviceSource::enumerate() {
+    std::vector<DeviceInfo> devices;
+    std::error_code ec;
+    for (const auto& entry : fs::directory_iterator(fs::path(root_) / "sys/class/tty", ec)) {
+        std::string name = entry.path().filename().string();
+        if (!isSerialDevNode(name)) continue;
+
+        auto device = readDevice(name);
+        if (device) {
+            devices.push_back(*device);
+        }
+    }
+    return devices;
+}
+
+std::optional<DeviceInfo> SysfsDeviceSource::lookup(const std::string& devPath) {
+    return readDevice(devPath.substr(devPath.rfind('/') + 1));
+}
+
+std::optional<DeviceInfo> SysfsDeviceSource::readDevice(const std::string& name) const {
+    EASYTTY_TRACE_SPAN("extractDeviceInfo");
+    fs::path root = root_;
+    std::error_code ec;
+    fs::path devDir = fs::canonical(root / "sys/class/tty" / name, ec);
+    if (ec) {
+        return std::nullopt;
+    }
+
+    DeviceInfo info;
+    info.devNode = name;
+    info.devPath = "/dev/" + name;
+    info.sysPath = relativeTo(devDir, root);
+    info.subsystem = "tty";
+
+    // Walk up like udev_device_get_parent_with_subsystem_devtype: the
+    // nearest directory with bInterfaceNumber is the USB interface, the
+    // nearest with idVendor the USB device
+    fs::path devicesRoot = root / "sys/devices";
+    bool haveInterface = false;
+    std::string interfaceDriver;
+    for (fs::path dir = devDir.parent_path();
+         dir.string().size() > devicesRoot.string().size() && utils::startsWith(dir.string(), devicesRoot.string());
+         dir = dir.parent_path()) {
+        if (!haveInterface && readAttr(dir / "bInterfaceNumber", info.interfaceNum)) {
+            haveInterface = true;
+            interfaceDriver = linkName(dir / "driver");
+        }
+        std::string vendorId;
+        if (readAttr(dir / "idVendor", vendorId)) {
+            info.vendorId = utils::formatHexId(vendorId);
+            info.productId = utils::formatHexId(readAttr(dir / "idProduct"));
+            info.serial = readAttr(dir / "serial");
+            info.manufacturer = readAttr(dir / "manufacturer");
+            info.product = readAttr(dir / "product");
+            info.busNum = readAttr(dir / "busnum");
+            info.devNum = readAttr(dir / "devnum");
+            info.kernelPath = dir.filename().string();
+            info.driver = linkName(dir / "driver");
+            break;
+        }
+    }
+    if (!interfaceDriver.empty()) {
+        info.driver = interfaceDriver;
+    }
+
+    return info.isValid() ? std::optional<DeviceInfo>(info) : std::nullopt;
+}
+
+OperationResult SysfsDeviceSource::captureSnapshot(std::FILE* out, const std::string& rootPath) {
+    fs::path root = fs::canonical(rootPath);
+    fs::path classDir = root / "sys/class/tty";
+    fs::path devicesRoot = root / "sys/devices";
+
+    // Archive path (relative, no leading slash) -> content or link target
+    std::set<std::string> dirs = {"sys", "sys/class", "sys/class/tty", "sys/devices"};
+    std::map<std::string, std::string> files;
+    std::map<std::string, std::string> links;
+
+    auto archivePath = [&root](const fs::path& path) {
+        std::string text = relativeTo(path, root);
+        return text.substr(text.find_first_not_of('/'));
+    };
+
+    std::error_code ec;
+    for (const auto& entry : fs::directory_iterator(classDir, ec)) {
+        std::string name = entry.path().filename().string();
+        if (!isSerialDevNode(name)) continue;
+
+        std::error_code linkEc;
+        fs::path target = fs::read_symlink(entry.path(), linkEc);
+        fs::path devDir = fs::canonical(entry.path(), linkEc);
+        if (linkEc) continue;
+        links[archivePath(entry.path())] = target.string();
+
+        for (fs::path dir = devDir;
+             dir.string().size() > devicesRoot.string().size() && utils::startsWith(dir.string(), devicesRoot.string());
+             dir = dir.parent_path()) {
+            dirs.insert(archivePath(dir));
+            for (const char* attr : SNAPSHOT_ATTRS) {
+                fs::path file = dir / attr;
+                if (fs::is_regular_file(file, linkEc)) {
+                    std::ifstream in(file);
+                    std::stringstream content;
+                    content << in.rdbuf();
+                    files[archivePath(file)] = content.str();
+                }
+            }
+            for (const char* link : SNAPSHOT_LINKS) {
+                fs::path path = dir / link;
+                fs::path linkTarget = fs::read_symlink(path, linkEc);
+                if (!linkEc) {
+                    links[archivePath(path)] = linkTarget.string();
+                }
+            }
+        }
+    }
+    if (ec) {
+        return OperationResult::Failure("Cannot read " + classDir.string() + ": " + ec.message());
+    }
+
+    // std::set orders parents before their children
+    TarWriter tar(out);
+    for (const auto& dir : dirs) {
+        auto result = tar.addDirectory(dir);
+        if (!result.success) return result;
+    }
+    for (const auto& file : files) {
+        auto result = tar.addFile(file.first, file.second);
+        if (!result.success) return result;
+    }
+    for (const auto& link : links) {
+        auto result = tar.addSymlink(link.first, link.second);
+        if (!result.success) return result;
+    }
+    auto result = tar.finish();
+    if (!result.success) {
+        return result;
+    }
+
+    return OperationResult::Success("Captured " + std::to_string(links.size()) + " entries");
+}
+
+} // namespace easytty
@@ -0,0 +1,135 @@
+#include "device/UdevDeviceSource.hpp"
+#include "common/Utils.hpp"
+#include "common/Trace.hpp"
+#include <stdexcept>
+
+namespace easytty {
+
+UdevDeviceSource::UdevDeviceSource() {
+    udev_ = udev_new();
+    if (!udev_) {
+        throw std::runtime_error("Failed to initialize udev");
+    }
+}
+
+UdevDeviceSource::~UdevDeviceSource() {
+    if (udev_) {
+        udev_unref(udev_);
+    }
+}
+
+std::vector<DeviceInfo> UdevDeviceSource::enumerate() {
+    std::vector<DeviceInfo> result;
+    
+    struct udev_enumerate* enumerate = udev_enumerate_new(udev_);
+    if (!enumerate) {
+        return result;
+    }
+    
+    // Add matching subsystems
+    udev_enumerate_add_match_subsystem(enumerate, "tty");
+    udev_enumerate_scan_devices(enumerate);
+    
+    struct udev_list_entry* devices = udev_enumerate_get_list_entry(enumerate);
+    struct udev_list_entry* entry;
+    
+    udev_list_entry_foreach(entry, devices) {
+        const char* path = udev_list_entry_get_name(entry);
+        struct udev_device* dev = udev_device_new_from_syspath(udev_, path);
+        
+        if (dev) {
+            const char* devNode = udev_device_get_devnode(dev);
+            // Filter for serial devices
+            if (devNode && isSerialDevNode(devNode)) {
+                DeviceInfo info = extractDeviceInfo(dev);
+                if (info.isValid()) {
+                    result.push_back(info);
+                }
+            }
+            udev_device_unref(dev);
+        }
+    }
+    
+    udev_enumerate_unref(enumerate);
+    return result;
+}
+
+std::optional<DeviceInfo> UdevDeviceSource::lookup(const std::string& devPath) {
+    // Look the device up through its sysfs class entry
+    std::string sysPath = "/sys/class/tty/" + 
+                          devPath.substr(devPath.rfind('/') + 1);
+    
+    struct udev_device* dev = udev_device_new_from_syspath(udev_, sysPath.c_str());
+    if (!dev) {
+        return DeviceSource::lookup(devPath);
+    }
+    
+    DeviceInfo info = extractDeviceInfo(dev);
+    udev_device_unref(dev);
+    
+    return info.isValid() ? std::optional<DeviceInfo>(info) : std::nullopt;
+}
+
+DeviceInfo UdevDeviceSource::extractDeviceInfo(struct udev_device* dev) {
+    EASYTTY_TRACE_SPAN("extractDeviceInfo");
+    DeviceInfo info;
+    
+    const char* devNode = udev_device_get_devnode(dev);
+    if (devNode) {
+        info.devPath = devNode;
+        info.devNode = std::string(devNode).substr(std::string(devNode).rfind('/') + 1);
+    }
+    
+    const char* sysPath = udev_device_get_syspath(dev);
+    if (sysPath) {
+        info.sysPath = sysPath;
+    }
+    
+    const char* subsystem = udev_device_get_subsystem(dev);
+    if (subsystem) {
+        info.subsystem = subsystem;
+    }
+    
+    // Get USB parent device for attributes
+    struct udev_device* usb_dev = udev_device_get_parent_with_subsystem_devtype(dev, "usb", "usb_device");
+    if (usb_dev) {
+        info.vendorId = utils::formatHexId(getSysAttr(usb_dev, "idVendor"));
+        info.productId = utils::formatHexId(getSysAttr(usb_dev, "idProduct"));
+        info.serial = getSysAttr(usb_dev, "serial");
+        info.manufacturer = getSysAttr(usb_dev, "manufacturer");
+        info.product = getSysAttr(usb_dev, "product");
+        info.busNum = getSysAttr(usb_dev, "busnum");
+        info.devNum = getSysAttr(usb_dev, "devnum");
+        
+        // Get kernel path (USB port path like "1-2.3") for physical location
+        const char* sysName = udev_device_get_sysname(usb_dev);
+        if (sysName) {
+            info.kernelPath = sysName;
+        }
+        
+        const char* driver = udev_device_get_driver(usb_dev);
+        if (driver) {
+            info.driver = driver;
+        }
+    }
+    
+    // Get interface driver and interface number
+    struct udev_device* intf_dev = udev_device_get_parent_with_subsystem_devtype(
+        dev, "usb", "usb_interface");
+    if (intf_dev) {
+        const char* driver = udev_device_get_driver(intf_dev);
+        if (driver) {
+            info.driver = driver;
+        }
+        info.interfaceNum = getSysAttr(intf_dev, "bInterfaceNumber");
+    }
+    
+    return info;
+}
+
+std::string UdevDeviceSource::getSysAttr(struct udev_device* dev, const char* attr) {
+    const char* value = udev_device_get_sysattr_value(dev, attr);
+    return value ? utils::trim(std::string(value)) : "";
+}
+
+} // namespace easytty
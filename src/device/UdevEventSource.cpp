@@ -0,0 +1,118 @@
+#include "device/UdevEventSource.hpp"
+#include "device/UdevDeviceSource.hpp"
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+
+namespace easytty {
+
+UdevEventSource::UdevEventSource() : udev_(nullptr), monitor_(nullptr) {
+}
+
+UdevEventSource::~UdevEventSource() {
+    stop();
+    if (udev_) {
+        udev_unref(udev_);
+    }
+}
+
+bool UdevEventSource::start() {
+    if (monitor_) {
+        return true;
+    }
+
+    if (!udev_) {
+        udev_ = udev_new();
+        if (!udev_) {
+            return false;
+        }
+    }
+
+    monitor_ = udev_monitor_new_from_netlink(udev_, "udev");
+    if (!monitor_) {
+        return false;
+    }
+
+    udev_monitor_filter_add_match_subsystem_devtype(monitor_, "tty", nullptr);
+    // Hub power cycles deliver bursts; give the kernel room to queue them
+    udev_monitor_set_receive_buffer_size(monitor_, 4 * 1024 * 1024);
+
+    if (udev_monitor_enable_receiving(monitor_) < 0) {
+        stop();
+        return false;
+    }
+
+    return true;
+}
+
+void UdevEventSource::stop() {
+    if (monitor_) {
+        udev_monitor_unref(monitor_);
+        monitor_ = nullptr;
+    }
+}
+
+int UdevEventSource::getFd() const {
+    return monitor_ ? udev_monitor_get_fd(monitor_) : -1;
+}
+
+std::optional<DeviceEvent> UdevEventSource::receive() {
+    if (!monitor_) {
+        return std::nullopt;
+    }
+
+    struct udev_device* dev = udev_monitor_receive_device(monitor_);
+    if (!dev) {
+        return std::nullopt;
+    }
+
+    const char* action = udev_device_get_action(dev);
+    const char* devNode = udev_device_get_devnode(dev);
+    if (!action || !devNode || !DeviceSource::isSerialDevNode(devNode)) {
+        udev_device_unref(dev);
+        return std::nullopt;
+    }
+
+    DeviceEvent event;
+    if (strcmp(action, "add") == 0) {
+        event.action = DeviceAction::Add;
+    } else if (strcmp(action, "remove") == 0) {
+        event.action = DeviceAction::Remove;
+    } else {
+        event.action = DeviceAction::Change;
+    }
+    event.seqnum = udev_device_get_seqnum(dev);
+    event.timestampUsec = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+
+    std::string initialized = getProperty(dev, "USEC_INITIALIZED");
+    event.initializedUsec = initialized.empty() ? 0 : std::strtoull(initialized.c_str(), nullptr, 10);
+
+    if (event.action == DeviceAction::Remove) {
+        // sysfs is already gone; take the attributes udevd recorded
+        event.device.devPath = devNode;
+        event.device.devNode = event.device.devPath.substr(event.device.devPath.rfind('/') + 1);
+        const char* sysPath = udev_device_get_syspath(dev);
+        if (sysPath) {
+            event.device.sysPath = sysPath;
+        }
+        event.device.subsystem = "tty";
+        event.device.vendorId = getProperty(dev, "ID_VENDOR_ID");
+        event.device.productId = getProperty(dev, "ID_MODEL_ID");
+        event.device.serial = getProperty(dev, "ID_SERIAL_SHORT");
+        event.device.driver = getProperty(dev, "ID_USB_DRIVER");
+        event.device.interfaceNum = getProperty(dev, "ID_USB_INTERFACE_NUM");
+    } else {
+        event.device = UdevDeviceSource::extractDeviceInfo(dev);
+    }
+
+    udev_device_unref(dev);
+    return event;
+}
+
+std::string UdevEventSource::getProperty(struct udev_device* dev, const char* key) {
+    const char* value = udev_device_get_property_value(dev, key);
+    return value ? std::string(value) : "";
+}
+
+} // namespace easytty
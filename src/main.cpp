@@ -1,7 +1,29 @@
+#ifndef EASYTTY_HEADLESS
 #include "app/Application.hpp"
+#endif
+#include "device/DeviceDetector.hpp"
+#include "udev/UdevManager.hpp"
 #include "common/Utils.hpp"
+#include "cli/RecordWriter.hpp"
+#include "cli/Commands.hpp"
+#include "common/Filter.hpp"
+#include "common/Trace.hpp"
+#include "device/DeviceInventory.hpp"
+#include "device/DeviceSource.hpp"
+#include "device/EventLog.hpp"
+#include "device/EventSource.hpp"
+#include "device/FlapDetector.hpp"
+#include "device/ReplayEventSource.hpp"
 #include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
 #include <cstring>
+#include <map>
+
+using easytty::cli::OutputFormat;
+using easytty::cli::RecordWriter;
 
 void printUsage(const char* programName) {
     std::cout << "EasyTTY - USB Device Naming Utility\n\n";
@@ -10,9 +32,98 @@ void printUsage(const char* programName) {
     std::cout << "  -h, --help     Show this help message\n";
     std::cout << "  -v, --version  Show version information\n";
     std::cout << "  -l, --list     List connected USB serial devices (non-interactive)\n";
+    std::cout << "  --record       With --list, also record the devices in the inventory\n";
+    std::cout << "                 used by --gc (needs root)\n";
+    std::cout << "  --flapping     With --list and a record format, add a 'flapping' field\n";
+    std::cout << "                 from the --watch history (text output always shows it)\n";
     std::cout << "  -r, --rules    List existing EasyTTY udev rules (non-interactive)\n";
+    std::cout << "  -c, --create <device> <name>\n";
+    std::cout << "                 Create a rule for a device given as /dev/ttyUSB0,\n";
+    std::cout << "                 vid:pid:serial or USB port path (e.g. 1-6.3)\n";
+    std::cout << "  --create-interfaces <device> <base|name,name,...>\n";
+    std::cout << "                 Name every interface of a multi-port adapter at once\n";
+    std::cout << "                 (base_A, base_B, ...) in one rule file, one reload\n";
+    std::cout << "  -d, --delete <name>\n";
+    std::cout << "                 Delete the rule for /dev/<name>\n";
+    std::cout << "  -b, --batch    Read 'create <device> <name>' and 'delete <name>'\n";
+    std::cout << "                 lines from stdin, validate all, apply once\n";
+    std::cout << "  -w, --watch    Print hotplug events with resolved names until interrupted\n";
+    std::cout << "  --coalesce <ms>\n";
+    std::cout << "                 With --watch, report each burst of events (a hub power\n";
+    std::cout << "                 cycle) as its net change once it is quiet for <ms>\n";
+    std::cout << "  --hooks <file> With --watch, run the hooks in <file> (exec or Unix\n";
+    std::cout << "                 socket, see README) on attach/detach, on worker threads\n";
+    std::cout << "  -m, --metrics <file>\n";
+    std::cout << "                 Write node_exporter textfile metrics to <file> and exit;\n";
+    std::cout << "                 with --watch, rewrite it after every hotplug event\n";
+    std::cout << "  --port-counters\n";
+    std::cout << "                 Add TIOCGICOUNT error counters to the metrics (opens\n";
+    std::cout << "                 each port, which may toggle DTR on some adapters)\n";
+    std::cout << "  --latency      Show attach latency histograms (per rule and driver);\n";
+    std::cout << "                 with --watch, measure how long attached devices take\n";
+    std::cout << "                 until udev is done, /dev/<name> exists and the port is usable\n";
+    std::cout << "  --history      Show attach/detach/change events recorded by --watch\n";
+    std::cout << "  --since <when> Only history since a duration ago (30m, 12h, 7d)\n";
+    std::cout << "                 or a local date/time (2026-10-01T08:00)\n";
+    std::cout << "  --name <name>  Only history of /dev/<name>\n";
+    std::cout << "  --no-history   Do not record --watch events in the history\n";
+    std::cout << "  --gc           Remove rules whose devices have not been seen for\n";
+    std::cout << "                 --older-than (default: 90d); udev is reloaded once\n";
+    std::cout << "  --older-than <duration>\n";
+    std::cout << "                 Window for --gc, e.g. 30d or 12w\n";
+    std::cout << "  --archive      With --gc, move rules to " << easytty::UdevManager::ARCHIVE_DIR << "\n";
+    std::cout << "                 instead of deleting them\n";
+    std::cout << "  --dry-run      With --gc or --auto-name, only list the rules it would\n";
+    std::cout << "                 remove or create\n";
+    std::cout << "  --auto-name <policy>\n";
+    std::cout << "                 Name every device without a rule by a policy file of\n";
+    std::cout << "                 '<filter> => <template>' lines (see README); with\n";
+    std::cout << "                 --watch, name devices as they attach (with --coalesce,\n";
+    std::cout << "                 _2/_3 suffixes follow port order, not attach order)\n";
+    std::cout << "  --replay <trace>\n";
+    std::cout << "                 Replay events recorded with --watch -f ndjson through\n";
+    std::cout << "                 the monitor path; report latency, drops and queue depth\n";
+    std::cout << "  --speed <1|10|...|max>\n";
+    std::cout << "                 Replay speed factor (default: 1, the recorded pace)\n";
+    std::cout << "  --stats        Heap allocations of a cold and a warm device scan and\n";
+    std::cout << "                 rule load (builds with -DEASYTTY_ALLOC_STATS=ON)\n";
+    std::cout << "  --check        Health check for monitoring (Nagios exit codes:\n";
+    std::cout << "                 0 OK, 1 WARNING, 2 CRITICAL, 3 UNKNOWN)\n";
+    std::cout << "  --resolve <query>...\n";
+    std::cout << "                 Show device, rule file and status for a symlink,\n";
+    std::cout << "                 device node, serial, vid:pid:serial or USB port.\n";
+    std::cout << "                 Use '-' to read queries from stdin\n";
+    std::cout << "  --wait <name>...\n";
+    std::cout << "                 Wait until /dev/<name> exists and points at a device\n";
+    std::cout << "                 matching its rule. Exit codes: 0 ready, 1 error,\n";
+    std::cout << "                 2 timeout, 3 symlink points at the wrong device\n";
+    std::cout << "  -t, --timeout <seconds>\n";
+    std::cout << "                 Timeout for --wait, at most 30 days (default or inf:\n";
+    std::cout << "                 wait forever)\n";
+    std::cout << "  --where <expr> Only show devices/rules matching a filter, e.g.\n";
+    std::cout << "                 'vid==0403 && serial~\"A5*\" && port^=\"1-6.\"'\n";
+    std::cout << "                 (applies to --list, --rules and --watch)\n";
+    std::cout << "  -f, --format <text|json|ndjson|tsv>\n";
+    std::cout << "                 Output format for --list, --rules, --check, --resolve,\n";
+    std::cout << "                 --latency and --watch (default: text)\n";
+    std::cout << "  --device-source <udev|fixture:<file>|sysfs:<dir>>\n";
+    std::cout << "                 Read devices from libudev (default), a JSON fixture\n";
+    std::cout << "                 as printed by --list -f json, or a sysfs tree such\n";
+    std::cout << "                 as an extracted --capture-snapshot archive\n";
+    std::cout << "  --event-source <auto|udev|kernel|replay:<trace>[@speed]>\n";
+    std::cout << "                 Hotplug events from udevd or straight from the kernel\n";
+    std::cout << "                 uevent socket (auto: kernel when udevd is not running)\n";
+    std::cout << "  --capture-snapshot <file.tar>\n";
+    std::cout << "                 Archive the sysfs entries of all serial devices\n";
     std::cout << "\n";
+#ifdef EASYTTY_HEADLESS
+    std::cout << "This is the headless build; the interactive TUI is in easyTTY.\n";
+#else
     std::cout << "Running without options starts the interactive TUI.\n";
+#endif
+    std::cout << "\n";
+    std::cout << "Set EASYTTY_TRACE=<file> to write a Chrome/Perfetto trace of device\n";
+    std::cout << "scans, rule loading, spawned commands and TUI frames on exit.\n";
     std::cout << "\n";
     std::cout << "Note: Some operations require root privileges.\n";
     std::cout << "      Run with sudo if you encounter permission errors.\n";
@@ -23,10 +134,66 @@ void printVersion() {
     std::cout << "USB Device Naming Utility using udev\n";
 }
 
-void listDevices() {
+void listDevices(OutputFormat format, const easytty::Filter& filter, bool record, bool flapping) {
     try {
         easytty::DeviceDetector detector;
         auto devices = detector.scanDevices();
+        if (record) {
+            if (!detector.getSource().isLive()) {
+                std::cerr << "Warning: --record needs live devices (not " << detector.getSource().name()
+                          << "), the inventory was not updated\n";
+            } else {
+                auto result = easytty::DeviceInventory::recordScan(devices);
+                if (!result.success) {
+                    std::cerr << "Warning: " << result.message << "\n";
+                }
+            }
+        }
+        
+        // Interfaces per physical device, before the filter hides some
+        std::map<std::string, size_t> interfaceCounts;
+        for (const auto& dev : devices) {
+            interfaceCounts[easytty::DeviceDetector::physicalDeviceKey(dev)]++;
+        }
+        
+        if (!filter.empty()) {
+            devices.erase(std::remove_if(devices.begin(), devices.end(),
+                                         [&filter](const easytty::DeviceInfo& dev) {
+                                             return !filter.matches(dev);
+                                         }),
+                          devices.end());
+        }
+        
+        // Flapping state comes from what --watch recorded in the history.
+        // Reading the whole ring is the slow part of a listing, so records
+        // only carry it on request
+        uint64_t now = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+        easytty::FlapDetector flaps;
+        if (format == OutputFormat::Text || flapping) {
+            flaps.loadHistory(easytty::EventLog::DEFAULT_PATH, now);
+        }
+        
+        if (format != OutputFormat::Text) {
+            RecordWriter writer(format);
+            auto writeDevice = [&](const easytty::DeviceInfo& dev) {
+                easytty::cli::writeDeviceFields(writer, dev);
+                if (flapping) {
+                    writer.field("flapping", flaps.isFlapping(dev));
+                }
+            };
+            // TSV gets its header even when no device matched
+            writer.beginHeader();
+            writeDevice(easytty::DeviceInfo());
+            writer.endHeader();
+            for (const auto& dev : devices) {
+                writer.beginRecord();
+                writeDevice(dev);
+                writer.endRecord();
+            }
+            writer.finish();
+            return;
+        }
         
         if (devices.empty()) {
             std::cout << "No USB serial devices found.\n";
@@ -63,6 +230,14 @@ void listDevices() {
                 }
                 std::cout << "\n";
             }
+            if (size_t count = interfaceCounts[easytty::DeviceDetector::physicalDeviceKey(dev)]; count > 1) {
+                std::cout << "  Interface:    " << dev.interfaceNum << " (one of " << count
+                          << " on this USB device)\n";
+            }
+            if (const auto* state = flaps.find(dev); state && state->flapping) {
+                std::cout << "  State:        FLAPPING (" << state->transitions << " attach/detach in the last hour, "
+                          << (state->holdUntilUsec - now + 999999) / 1000000 << " s until stable)\n";
+            }
             std::cout << "\n";
         }
     } catch (const std::exception& e) {
@@ -70,10 +245,29 @@ void listDevices() {
     }
 }
 
-void listRules() {
+void listRules(OutputFormat format, const easytty::Filter& filter) {
     try {
         easytty::UdevManager manager;
-        auto rules = manager.getRules();
+        std::vector<easytty::UdevRule> rules;
+        for (const auto& rule : manager.getExistingRules()) {
+            if (filter.matches(rule)) {
+                rules.push_back(rule);
+            }
+        }
+        
+        if (format != OutputFormat::Text) {
+            RecordWriter writer(format);
+            writer.beginHeader();
+            easytty::cli::writeRuleFields(writer, easytty::UdevRule(), false);
+            writer.endHeader();
+            for (const auto& rule : rules) {
+                writer.beginRecord();
+                easytty::cli::writeRuleFields(writer, rule, manager.verifySymlink(rule.symlink));
+                writer.endRecord();
+            }
+            writer.finish();
+            return;
+        }
         
         if (rules.empty()) {
             std::cout << "No EasyTTY udev rules found.\n";
@@ -89,6 +283,9 @@ void listRules() {
             if (!rule.serial.empty()) {
                 std::cout << "  Serial:     " << rule.serial << "\n";
             }
+            if (!rule.interfaceNum.empty()) {
+                std::cout << "  Interface:  " << rule.interfaceNum << "\n";
+            }
             std::cout << "  File:       " << rule.filePath << "\n";
             std::cout << "  Active:     " << (manager.verifySymlink(rule.symlink) ? "Yes" : "No") << "\n";
             std::cout << "\n";
@@ -99,6 +296,186 @@ void listRules() {
 }
 
 int main(int argc, char* argv[]) {
+    easytty::trace::initFromEnvironment();
+    
+    OutputFormat format = OutputFormat::Text;
+    double timeoutSeconds = -1;
+    easytty::Filter filter;
+    easytty::cli::WatchOptions watchOptions;
+    bool watch = false;
+    std::string historySince;
+    std::string historyName;
+    double replaySpeed = 1;
+    std::string gcOlderThan = "90d";
+    bool gcArchive = false;
+    bool gcDryRun = false;
+    bool listRecord = false;
+    bool listFlapping = false;
+    
+    // Parse options first so they may appear anywhere on the command line
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-f") == 0 || strcmp(argv[i], "--format") == 0) {
+            if (i + 1 >= argc) {
+                std::cerr << "Error: " << argv[i] << " requires an argument\n";
+                return 1;
+            }
+            auto parsed = easytty::cli::parseOutputFormat(argv[++i]);
+            if (!parsed) {
+                std::cerr << "Error: Unknown format '" << argv[i] << "' (expected text, json, ndjson or tsv)\n";
+                return 1;
+            }
+            format = *parsed;
+        }
+        if (strcmp(argv[i], "--where") == 0) {
+            if (i + 1 >= argc) {
+                std::cerr << "Error: " << argv[i] << " requires an expression\n";
+                return 1;
+            }
+            std::string error;
+            auto compiled = easytty::Filter::compile(argv[++i], error);
+            if (!compiled) {
+                std::cerr << "Error: Invalid filter: " << error << "\n";
+                return 1;
+            }
+            filter = *compiled;
+        }
+        if (strcmp(argv[i], "-t") == 0 || strcmp(argv[i], "--timeout") == 0) {
+            if (i + 1 >= argc) {
+                std::cerr << "Error: " << argv[i] << " requires an argument\n";
+                return 1;
+            }
+            char* end = nullptr;
+            timeoutSeconds = strtod(argv[++i], &end);
+            if (*end != '\0' || end == argv[i] || std::isnan(timeoutSeconds) || timeoutSeconds < 0 ||
+                (timeoutSeconds > easytty::cli::WAIT_MAX_SECONDS && !std::isinf(timeoutSeconds))) {
+                std::cerr << "Error: Invalid timeout '" << argv[i] << "' (0 to "
+                          << static_cast<long>(easytty::cli::WAIT_MAX_SECONDS) << " seconds, or inf)\n";
+                return 1;
+            }
+            if (std::isinf(timeoutSeconds)) {
+                timeoutSeconds = -1;    // Same as no --timeout
+            }
+        }
+        if (strcmp(argv[i], "-m") == 0 || strcmp(argv[i], "--metrics") == 0) {
+            if (i + 1 >= argc) {
+                std::cerr << "Error: " << argv[i] << " requires a file\n";
+                return 1;
+            }
+            watchOptions.metricsPath = argv[++i];
+        }
+        if (strcmp(argv[i], "--port-counters") == 0) {
+            watchOptions.portCounters = true;
+        }
+        if (strcmp(argv[i], "--latency") == 0) {
+            watchOptions.latency = true;
+        }
+        if (strcmp(argv[i], "-w") == 0 || strcmp(argv[i], "--watch") == 0) {
+            watch = true;
+        }
+        if (strcmp(argv[i], "--speed") == 0) {
+            if (i + 1 >= argc) {
+                std::cerr << "Error: " << argv[i] << " requires a factor\n";
+                return 1;
+            }
+            auto parsed = easytty::ReplayEventSource::parseSpeed(argv[++i]);
+            if (!parsed) {
+                std::cerr << "Error: Invalid speed '" << argv[i] << "' (expected e.g. 1, 10 or max)\n";
+                return 1;
+            }
+            replaySpeed = *parsed;
+        }
+        if (strcmp(argv[i], "--no-history") == 0) {
+            watchOptions.history = false;
+        }
+        if (strcmp(argv[i], "--coalesce") == 0) {
+            if (i + 1 >= argc) {
+                std::cerr << "Error: " << argv[i] << " requires a window in milliseconds\n";
+                return 1;
+            }
+            char* end = nullptr;
+            unsigned long window = strtoul(argv[++i], &end, 10);
+            if (*end != '\0' || end == argv[i] || window > 60000) {
+                std::cerr << "Error: Invalid coalesce window '" << argv[i] << "' (0 to 60000 ms)\n";
+                return 1;
+            }
+            watchOptions.coalesceMs = static_cast<unsigned>(window);
+        }
+        if (strcmp(argv[i], "--since") == 0) {
+            if (i + 1 >= argc) {
+                std::cerr << "Error: " << argv[i] << " requires a time\n";
+                return 1;
+            }
+            historySince = argv[++i];
+        }
+        if (strcmp(argv[i], "--older-than") == 0) {
+            if (i + 1 >= argc) {
+                std::cerr << "Error: " << argv[i] << " requires a duration\n";
+                return 1;
+            }
+            gcOlderThan = argv[++i];
+        }
+        if (strcmp(argv[i], "--archive") == 0) {
+            gcArchive = true;
+        }
+        if (strcmp(argv[i], "--dry-run") == 0) {
+            gcDryRun = true;
+        }
+        if (strcmp(argv[i], "--record") == 0) {
+            listRecord = true;
+        }
+        if (strcmp(argv[i], "--flapping") == 0) {
+            listFlapping = true;
+        }
+        if (strcmp(argv[i], "--auto-name") == 0) {
+            if (i + 1 >= argc) {
+                std::cerr << "Error: " << argv[i] << " requires a policy file\n";
+                return 1;
+            }
+            watchOptions.policyPath = argv[++i];
+        }
+        if (strcmp(argv[i], "--hooks") == 0) {
+            if (i + 1 >= argc) {
+                std::cerr << "Error: " << argv[i] << " requires a hooks file\n";
+                return 1;
+            }
+            watchOptions.hooksPath = argv[++i];
+        }
+        if (strcmp(argv[i], "--name") == 0) {
+            if (i + 1 >= argc) {
+                std::cerr << "Error: " << argv[i] << " requires a name\n";
+                return 1;
+            }
+            historyName = argv[++i];
+        }
+        if (strcmp(argv[i], "--device-source") == 0) {
+            if (i + 1 >= argc) {
+                std::cerr << "Error: " << argv[i] << " requires a source\n";
+                return 1;
+            }
+            // Check it once here; every detector picks it up from the environment
+            try {
+                easytty::DeviceSource::create(argv[++i]);
+            } catch (const std::exception& e) {
+                std::cerr << "Error: " << e.what() << "\n";
+                return 1;
+            }
+            setenv(easytty::DeviceSource::ENV_VAR, argv[i], 1);
+        }
+        if (strcmp(argv[i], "--event-source") == 0) {
+            if (i + 1 >= argc) {
+                std::cerr << "Error: " << argv[i] << " requires a source\n";
+                return 1;
+            }
+            try {
+                easytty::EventSource::create(argv[++i]);
+            } catch (const std::exception& e) {
+                std::cerr << "Error: " << e.what() << "\n";
+                return 1;
+            }
+            setenv(easytty::EventSource::ENV_VAR, argv[i], 1);
+        }
+    }
+    
     // Parse command line arguments
     for (int i = 1; i < argc; i++) {
         if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
@@ -110,15 +487,103 @@ int main(int argc, char* argv[]) {
             return 0;
         }
         if (strcmp(argv[i], "-l") == 0 || strcmp(argv[i], "--list") == 0) {
-            listDevices();
+            listDevices(format, filter, listRecord, listFlapping);
             return 0;
         }
         if (strcmp(argv[i], "-r") == 0 || strcmp(argv[i], "--rules") == 0) {
-            listRules();
+            listRules(format, filter);
             return 0;
         }
+        if (strcmp(argv[i], "-c") == 0 || strcmp(argv[i], "--create") == 0) {
+            if (i + 2 >= argc) {
+                std::cerr << "Error: " << argv[i] << " requires <device> <name>\n";
+                return 1;
+            }
+            return easytty::cli::createCommand(argv[i + 1], argv[i + 2]);
+        }
+        if (strcmp(argv[i], "--create-interfaces") == 0) {
+            if (i + 2 >= argc) {
+                std::cerr << "Error: " << argv[i] << " requires <device> <base name>\n";
+                return 1;
+            }
+            return easytty::cli::createInterfacesCommand(argv[i + 1], argv[i + 2]);
+        }
+        if (strcmp(argv[i], "-d") == 0 || strcmp(argv[i], "--delete") == 0) {
+            if (i + 1 >= argc) {
+                std::cerr << "Error: " << argv[i] << " requires <name>\n";
+                return 1;
+            }
+            return easytty::cli::deleteCommand(argv[i + 1]);
+        }
+        if (strcmp(argv[i], "-b") == 0 || strcmp(argv[i], "--batch") == 0) {
+            return easytty::cli::batchCommand(std::cin);
+        }
+        if (strcmp(argv[i], "-w") == 0 || strcmp(argv[i], "--watch") == 0) {
+            return easytty::cli::watchCommand(format, filter, watchOptions);
+        }
+        if ((strcmp(argv[i], "-m") == 0 || strcmp(argv[i], "--metrics") == 0) && !watch) {
+            return easytty::cli::metricsCommand(watchOptions.metricsPath, watchOptions.portCounters);
+        }
+        if (strcmp(argv[i], "--latency") == 0 && !watch) {
+            return easytty::cli::latencyCommand(format);
+        }
+        if (strcmp(argv[i], "--capture-snapshot") == 0) {
+            if (i + 1 >= argc) {
+                std::cerr << "Error: " << argv[i] << " requires a file\n";
+                return 1;
+            }
+            return easytty::cli::snapshotCommand(argv[i + 1]);
+        }
+        if (strcmp(argv[i], "--auto-name") == 0 && !watch) {
+            return easytty::cli::autoNameCommand(watchOptions.policyPath, gcDryRun, format);
+        }
+        if (strcmp(argv[i], "--gc") == 0) {
+            return easytty::cli::gcCommand(gcOlderThan, gcArchive, gcDryRun, format);
+        }
+        if (strcmp(argv[i], "--history") == 0) {
+            return easytty::cli::historyCommand(format, filter, historySince, historyName);
+        }
+        if (strcmp(argv[i], "--replay") == 0) {
+            if (i + 1 >= argc) {
+                std::cerr << "Error: " << argv[i] << " requires a trace file\n";
+                return 1;
+            }
+            return easytty::cli::replayCommand(argv[i + 1], replaySpeed, format);
+        }
+        if (strcmp(argv[i], "--stats") == 0) {
+            return easytty::cli::statsCommand(format);
+        }
+        if (strcmp(argv[i], "--check") == 0) {
+            return easytty::cli::checkCommand(format);
+        }
+        if (strcmp(argv[i], "--resolve") == 0) {
+            std::vector<std::string> queries;
+            for (int j = i + 1; j < argc && (argv[j][0] != '-' || strcmp(argv[j], "-") == 0); j++) {
+                queries.push_back(argv[j]);
+            }
+            if (queries.empty()) {
+                std::cerr << "Error: --resolve requires at least one query\n";
+                return 1;
+            }
+            return easytty::cli::resolveCommand(queries, format);
+        }
+        if (strcmp(argv[i], "--wait") == 0) {
+            std::vector<std::string> names;
+            for (int j = i + 1; j < argc && argv[j][0] != '-'; j++) {
+                names.push_back(argv[j]);
+            }
+            if (names.empty()) {
+                std::cerr << "Error: --wait requires at least one name\n";
+                return 1;
+            }
+            return easytty::cli::waitCommand(names, timeoutSeconds);
+        }
     }
     
+#ifdef EASYTTY_HEADLESS
+    printUsage(argv[0]);
+    return 1;
+#else
     // Run interactive TUI
     try {
         easytty::Application app;
@@ -127,4 +592,5 @@ int main(int argc, char* argv[]) {
         std::cerr << "Fatal error: " << e.what() << "\n";
         return 1;
     }
+#endif
 }
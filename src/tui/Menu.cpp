@@ -1,10 +1,43 @@
 #include "tui/Menu.hpp"
 #include "tui/Screen.hpp"
+#include "common/Trace.hpp"
+#include "common/AllocStats.hpp"
 #include <algorithm>
+#include <cstdio>
 
 namespace easytty {
 namespace tui {
 
+namespace {
+
+/**
+ * @brief Allocation counters shown by the F12 debug overlay
+ */
+std::vector<std::string> allocationOverlayLines() {
+    if (!alloc::ENABLED) {
+        return {"Allocation accounting not compiled in",
+                "(configure with -DEASYTTY_ALLOC_STATS=ON)"};
+    }
+    
+    std::vector<std::string> lines;
+    char line[96];
+    std::snprintf(line, sizeof(line), "%-18s %8s %10s %6s", "PHASE", "LAST", "LAST B", "CALLS");
+    lines.push_back(line);
+    for (int i = 0; i < static_cast<int>(alloc::Phase::Count); i++) {
+        auto phase = static_cast<alloc::Phase>(i);
+        if (phase == alloc::Phase::Other) continue;
+        alloc::PhaseStats stats = alloc::getStats(phase);
+        std::snprintf(line, sizeof(line), "%-18s %8llu %10llu %6llu", alloc::phaseName(phase),
+                      static_cast<unsigned long long>(stats.lastAllocations),
+                      static_cast<unsigned long long>(stats.lastBytes),
+                      static_cast<unsigned long long>(stats.calls));
+        lines.push_back(line);
+    }
+    return lines;
+}
+
+} // namespace
+
 Menu::Menu(const std::string& title, const std::string& subtitle)
     : title_(title)
     , subtitle_(subtitle)
@@ -60,6 +93,8 @@ int Menu::run() {
 
 void Menu::display() {
     if (!gScreen) return;
+    EASYTTY_TRACE_SPAN("frame", title_);
+    EASYTTY_ALLOC_PHASE(Render);
     
     gScreen->clear();
     gScreen->updateDimensions();
@@ -83,6 +118,10 @@ void Menu::display() {
     // Draw help bar
     gScreen->drawHelpBar(helpText_);
     
+    if (gScreen->isDebugOverlayVisible()) {
+        gScreen->drawDebugOverlay(allocationOverlayLines());
+    }
+    
     gScreen->refresh();
 }
 
@@ -111,6 +150,16 @@ bool Menu::handleInput() {
             running_ = false;
             return false;
             
+        case KEY_F(12):
+            gScreen->toggleDebugOverlay();
+            break;
+            
+        case '/':
+            if (searchHandler_ && searchHandler_()) {
+                close();
+            }
+            break;
+            
         case 27: // ESC
             // Check for ESC sequence (arrow keys)
             nodelay(stdscr, TRUE);
@@ -145,6 +194,10 @@ void Menu::setHelp(const std::string& help) {
     helpText_ = help;
 }
 
+void Menu::setSearchHandler(std::function<bool()> handler) {
+    searchHandler_ = handler;
+}
+
 int Menu::getVisibleHeight() const {
     if (!gScreen) return 10;
     int height = gScreen->getHeight();
@@ -7,7 +7,7 @@ namespace tui {
 
 std::unique_ptr<Screen> gScreen = nullptr;
 
-Screen::Screen() : width_(0), height_(0), initialized_(false) {}
+Screen::Screen() : width_(0), height_(0), initialized_(false), debugOverlay_(false) {}
 
 Screen::~Screen() {
     if (initialized_) {
@@ -102,6 +102,31 @@ void Screen::drawBox(int y, int x, int height, int width, int colorPair) {
     attroff(COLOR_PAIR(colorPair));
 }
 
+void Screen::drawDebugOverlay(const std::vector<std::string>& lines) {
+    int boxWidth = 0;
+    for (const auto& line : lines) {
+        boxWidth = std::max(boxWidth, static_cast<int>(line.length()));
+    }
+    boxWidth += 4;
+    int boxHeight = static_cast<int>(lines.size()) + 2;
+    
+    // Keep clear of the status and help bars
+    int startY = height_ - 2 - boxHeight;
+    int startX = width_ - boxWidth - 1;
+    if (startY < 1 || startX < 0) {
+        return;
+    }
+    
+    std::string padding(boxWidth - 2, ' ');
+    for (int i = 1; i < boxHeight - 1; i++) {
+        drawText(startY + i, startX + 1, padding, ColorScheme::NORMAL);
+    }
+    drawBox(startY, startX, boxHeight, boxWidth, ColorScheme::BORDER);
+    for (size_t i = 0; i < lines.size(); i++) {
+        drawText(startY + 1 + static_cast<int>(i), startX + 2, lines[i], ColorScheme::NORMAL);
+    }
+}
+
 void Screen::drawText(int y, int x, const std::string& text, int colorPair) {
     attron(COLOR_PAIR(colorPair));
     mvprintw(y, x, "%s", text.c_str());
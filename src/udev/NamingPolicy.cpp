@@ -0,0 +1,180 @@
+#include "udev/NamingPolicy.hpp"
+#include "common/Utils.hpp"
+#include <cctype>
+#include <cstdlib>
+#include <fstream>
+
+namespace easytty {
+
+namespace {
+
+bool isNameChar(char c) {
+    return std::isalnum(static_cast<unsigned char>(c)) || c == '_' || c == '-';
+}
+
+// One {field} or {fieldN} placeholder
+struct Placeholder {
+    Filter::Field field;
+    size_t keep = 0;        // Characters kept from the end, 0 keeps all
+};
+
+// Parse the placeholder starting after '{' at pos; pos ends after '}'
+std::optional<Placeholder> parsePlaceholder(const std::string& text, size_t& pos, std::string& error) {
+    size_t close = text.find('}', pos);
+    if (close == std::string::npos) {
+        error = "unterminated '{' in template";
+        return std::nullopt;
+    }
+    std::string inner = text.substr(pos, close - pos);
+    size_t digits = inner.find_first_of("0123456789");
+    std::string name = inner.substr(0, digits);
+
+    auto field = Filter::findField(name);
+    if (!field) {
+        error = "unknown field '{" + inner + "}' in template";
+        return std::nullopt;
+    }
+    Placeholder placeholder{*field};
+    if (digits != std::string::npos) {
+        std::string count = inner.substr(digits);
+        if (count.find_first_not_of("0123456789") != std::string::npos) {
+            error = "unknown field '{" + inner + "}' in template";
+            return std::nullopt;
+        }
+        placeholder.keep = std::strtoul(count.c_str(), nullptr, 10);
+    }
+    pos = close + 1;
+    return placeholder;
+}
+
+// Check literal characters and placeholders without a device at hand
+bool checkTemplate(const std::string& nameTemplate, std::string& error) {
+    if (nameTemplate.empty()) {
+        error = "empty name template";
+        return false;
+    }
+    for (size_t pos = 0; pos < nameTemplate.size();) {
+        char c = nameTemplate[pos];
+        if (c == '{') {
+            pos++;
+            if (!parsePlaceholder(nameTemplate, pos, error)) {
+                return false;
+            }
+        } else if (isNameChar(c)) {
+            pos++;
+        } else {
+            error = std::string("character '") + c + "' is not allowed in a symlink name";
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+std::optional<NamingPolicy> NamingPolicy::load(const std::string& path, std::string& error) {
+    std::ifstream in(path);
+    if (!in.is_open()) {
+        error = "Cannot read naming policy " + path;
+        return std::nullopt;
+    }
+    auto policy = parse(in, error);
+    if (!policy) {
+        error = path + ": " + error;
+    }
+    return policy;
+}
+
+std::optional<NamingPolicy> NamingPolicy::parse(std::istream& in, std::string& error) {
+    NamingPolicy policy;
+    std::string line;
+    int lineNum = 0;
+    while (std::getline(in, line)) {
+        lineNum++;
+        line = utils::trim(line);
+        if (line.empty() || line[0] == '#') continue;
+
+        // Templates never contain "=>", filter values might
+        size_t arrow = line.rfind("=>");
+        if (arrow == std::string::npos) {
+            error = "line " + std::to_string(lineNum) + ": expected '<filter> => <name template>'";
+            return std::nullopt;
+        }
+
+        Entry entry;
+        entry.line = lineNum;
+        entry.nameTemplate = utils::trim(line.substr(arrow + 2));
+
+        std::string problem;
+        auto filter = Filter::compile(utils::trim(line.substr(0, arrow)), problem);
+        if (!filter) {
+            error = "line " + std::to_string(lineNum) + ": " + problem;
+            return std::nullopt;
+        }
+        if (filter->empty()) {
+            error = "line " + std::to_string(lineNum) + ": empty filter (use 'vid~\"*\"' to match every device)";
+            return std::nullopt;
+        }
+        if (!checkTemplate(entry.nameTemplate, problem)) {
+            error = "line " + std::to_string(lineNum) + ": " + problem;
+            return std::nullopt;
+        }
+        entry.filter = std::move(*filter);
+        policy.entries_.push_back(std::move(entry));
+    }
+    return policy;
+}
+
+std::optional<std::string> NamingPolicy::nameFor(const DeviceInfo& device, const Entry** matched) const {
+    for (const auto& entry : entries_) {
+        if (!entry.filter.matches(device)) continue;
+        auto name = expand(entry.nameTemplate, device);
+        if (!name) continue;
+        if (matched) {
+            *matched = &entry;
+        }
+        return name;
+    }
+    return std::nullopt;
+}
+
+std::optional<std::string> NamingPolicy::expand(const std::string& nameTemplate, const DeviceInfo& device) {
+    std::string name;
+    std::string error;
+    for (size_t pos = 0; pos < nameTemplate.size();) {
+        if (nameTemplate[pos] != '{') {
+            name += nameTemplate[pos++];
+            continue;
+        }
+        pos++;
+        auto placeholder = parsePlaceholder(nameTemplate, pos, error);
+        if (!placeholder) {
+            return std::nullopt;
+        }
+
+        const std::string& value = Filter::fieldValue(device, placeholder->field);
+        if (value.empty()) {
+            return std::nullopt;
+        }
+        size_t start = placeholder->keep && placeholder->keep < value.size() ? value.size() - placeholder->keep : 0;
+        for (size_t i = start; i < value.size(); i++) {
+            name += isNameChar(value[i]) ? value[i] : '_';
+        }
+    }
+    return name;
+}
+
+std::string NamingPolicy::uniqueName(const std::string& name,
+                                     const std::function<bool(const std::string&)>& taken) {
+    if (!taken(name)) {
+        return name;
+    }
+    for (unsigned suffix = 2;; suffix++) {
+        std::string candidate = name + "_" + std::to_string(suffix);
+        if (!taken(candidate)) {
+            return candidate;
+        }
+    }
+}
+
+} // namespace easytty
@@ -0,0 +1,122 @@
+#include "udev/RuleIndex.hpp"
+
+namespace easytty {
+
+namespace {
+
+std::string serialKey(const std::string& vendorId, const std::string& productId, const std::string& serial) {
+    return vendorId + ":" + productId + ":S:" + serial;
+}
+
+std::string portKey(const std::string& vendorId, const std::string& productId, const std::string& kernelPath) {
+    return vendorId + ":" + productId + ":P:" + kernelPath;
+}
+
+std::string anyKey(const std::string& vendorId, const std::string& productId) {
+    return vendorId + ":" + productId + ":*";
+}
+
+// Interface rules are keyed per interface on top of their serial/port/any key
+std::string interfaceKey(const std::string& key, const std::string& interfaceNum) {
+    return key + ":I:" + interfaceNum;
+}
+
+} // namespace
+
+void RuleIndex::build(const std::vector<UdevRule>& rules) {
+    bySymlink_.clear();
+    byMatchKey_.clear();
+    byFile_.clear();
+    bySymlink_.reserve(rules.size());
+    byMatchKey_.reserve(rules.size());
+
+    for (const auto& rule : rules) {
+        add(rule);
+    }
+}
+
+void RuleIndex::add(const UdevRule& rule) {
+    if (!bySymlink_.emplace(rule.symlink, rule).second) {
+        return;
+    }
+    byMatchKey_.emplace(matchKey(rule), rule.symlink);
+    byFile_[rule.filePath]++;
+}
+
+bool RuleIndex::remove(const std::string& symlink) {
+    auto it = bySymlink_.find(symlink);
+    if (it == bySymlink_.end()) {
+        return false;
+    }
+
+    auto range = byMatchKey_.equal_range(matchKey(it->second));
+    for (auto keyIt = range.first; keyIt != range.second; ++keyIt) {
+        if (keyIt->second == symlink) {
+            byMatchKey_.erase(keyIt);
+            break;
+        }
+    }
+    auto file = byFile_.find(it->second.filePath);
+    if (file != byFile_.end() && --file->second == 0) {
+        byFile_.erase(file);
+    }
+    bySymlink_.erase(it);
+    return true;
+}
+
+const UdevRule* RuleIndex::findBySymlink(const std::string& symlink) const {
+    auto it = bySymlink_.find(symlink);
+    return it != bySymlink_.end() ? &it->second : nullptr;
+}
+
+const UdevRule* RuleIndex::findBySymlinkOrName(const std::string& symlinkOrName) const {
+    const UdevRule* found = nullptr;
+    for (const auto& entry : bySymlink_) {
+        const UdevRule& rule = entry.second;
+        if ((rule.symlink == symlinkOrName || rule.name == symlinkOrName) &&
+            (!found || rule.symlink < found->symlink)) {
+            found = &rule;
+        }
+    }
+    return found;
+}
+
+const UdevRule* RuleIndex::findForDevice(const DeviceInfo& device) const {
+    auto lookup = [this, &device](const std::string& key) -> const UdevRule* {
+        // A rule for this interface wins over one for the whole device
+        if (!device.interfaceNum.empty()) {
+            auto it = byMatchKey_.find(interfaceKey(key, device.interfaceNum));
+            if (it != byMatchKey_.end()) {
+                return findBySymlink(it->second);
+            }
+        }
+        auto it = byMatchKey_.find(key);
+        return it != byMatchKey_.end() ? findBySymlink(it->second) : nullptr;
+    };
+
+    const UdevRule* rule = nullptr;
+    if (!device.serial.empty()) {
+        rule = lookup(serialKey(device.vendorId, device.productId, device.serial));
+    }
+    if (!rule && !device.kernelPath.empty()) {
+        rule = lookup(portKey(device.vendorId, device.productId, device.kernelPath));
+    }
+    if (!rule && device.serial.empty()) {
+        rule = lookup(anyKey(device.vendorId, device.productId));
+    }
+    return rule;
+}
+
+std::string RuleIndex::matchKey(const UdevRule& rule) {
+    std::string key;
+    if (!rule.serial.empty()) {
+        key = serialKey(rule.vendorId, rule.productId, rule.serial);
+    } else if (!rule.kernelPath.empty()) {
+        key = portKey(rule.vendorId, rule.productId, rule.kernelPath);
+    } else {
+        key = anyKey(rule.vendorId, rule.productId);
+    }
+    return rule.interfaceNum.empty() ? key : interfaceKey(key, rule.interfaceNum);
+}
+
+} // namespace easytty
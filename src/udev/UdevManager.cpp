@@ -1,45 +1,105 @@
 #include "udev/UdevManager.hpp"
 #include "common/Utils.hpp"
+#include "common/Trace.hpp"
+#include "common/AllocStats.hpp"
 #include <filesystem>
 #include <fstream>
 #include <sstream>
-#include <regex>
 #include <algorithm>
+#include <set>
+#include <ctime>
 #include <unistd.h>
 
 namespace fs = std::filesystem;
 
 namespace easytty {
 
+namespace {
+
+// Extract the value of key="value" from a rule line; the key includes the opening quote
+bool findQuotedValue(const std::string& line, const char* key, std::string& value) {
+    size_t start = line.find(key);
+    if (start == std::string::npos) {
+        return false;
+    }
+    start += std::char_traits<char>::length(key);
+    
+    size_t end = line.find('"', start);
+    if (end == std::string::npos || end == start) {
+        return false;
+    }
+    
+    value.assign(line, start, end - start);
+    return true;
+}
+
+bool isHexString(const std::string& str) {
+    return std::all_of(str.begin(), str.end(),
+                       [](char c) { return std::isxdigit(static_cast<unsigned char>(c)); });
+}
+
+// The udev match line for a rule, without a trailing newline
+//
+// Interfaces are matched on ENV{ID_USB_INTERFACE_NUM} (set by the usb_id
+// builtin in 60-persistent-serial.rules) rather than ATTRS{bInterfaceNumber}:
+// all ATTRS keys of one rule must match on the same parent device, and
+// bInterfaceNumber lives on the usb_interface while idVendor and serial
+// live on its usb_device.
+std::string ruleLine(const UdevRule& rule) {
+    std::stringstream ss;
+    ss << "SUBSYSTEM==\"tty\", ";
+    if (rule.serial.empty() && !rule.kernelPath.empty()) {
+        ss << "KERNELS==\"" << rule.kernelPath << "\", ";
+    }
+    ss << "ATTRS{idVendor}==\"" << rule.vendorId << "\", ";
+    ss << "ATTRS{idProduct}==\"" << rule.productId << "\", ";
+    if (!rule.serial.empty()) {
+        ss << "ATTRS{serial}==\"" << rule.serial << "\", ";
+    }
+    if (!rule.interfaceNum.empty()) {
+        ss << "ENV{ID_USB_INTERFACE_NUM}==\"" << rule.interfaceNum << "\", ";
+    }
+    ss << "SYMLINK+=\"" << rule.symlink << "\", MODE=\"0666\"";
+    return ss.str();
+}
+
+// Drop the rules read from one file
+void dropRules(UdevManager::RuleSet& set, const std::string& filePath) {
+    std::vector<std::string> symlinks;
+    auto it = std::remove_if(set.rules.begin(), set.rules.end(),
+                             [&](const UdevRule& rule) {
+                                 if (rule.filePath != filePath) return false;
+                                 symlinks.push_back(rule.symlink);
+                                 return true;
+                             });
+    set.rules.erase(it, set.rules.end());
+    
+    // Another file may define the same symlink; let it take over the index entry
+    for (const auto& symlink : symlinks) {
+        set.index.remove(symlink);
+        for (const auto& rule : set.rules) {
+            if (rule.symlink == symlink) {
+                set.index.add(rule);
+                break;
+            }
+        }
+    }
+}
+
+} // namespace
+
 // Implement UdevRule::generateRule
 std::string UdevRule::generateRule() const {
     std::stringstream ss;
     ss << "# EasyTTY auto-generated rule for " << name << "\n";
     ss << "# Created by easyTTY - USB device persistent naming\n";
     
-    if (!serial.empty()) {
-        // Use serial number to identify device (works regardless of USB port)
-        ss << "SUBSYSTEM==\"tty\", ";
-        ss << "ATTRS{idVendor}==\"" << vendorId << "\", ";
-        ss << "ATTRS{idProduct}==\"" << productId << "\", ";
-        ss << "ATTRS{serial}==\"" << serial << "\", ";
-        ss << "SYMLINK+=\"" << symlink << "\", MODE=\"0666\"";
-    } else if (!kernelPath.empty()) {
+    if (serial.empty() && !kernelPath.empty()) {
         // Use USB port path to identify device (must stay in same port)
         ss << "# NOTE: This device has no serial. Rule is based on USB port " << kernelPath << "\n";
         ss << "# Device must remain plugged into the same USB port!\n";
-        ss << "SUBSYSTEM==\"tty\", ";
-        ss << "KERNELS==\"" << kernelPath << "\", ";
-        ss << "ATTRS{idVendor}==\"" << vendorId << "\", ";
-        ss << "ATTRS{idProduct}==\"" << productId << "\", ";
-        ss << "SYMLINK+=\"" << symlink << "\", MODE=\"0666\"";
-    } else {
-        // Fallback - no unique identifier
-        ss << "SUBSYSTEM==\"tty\", ";
-        ss << "ATTRS{idVendor}==\"" << vendorId << "\", ";
-        ss << "ATTRS{idProduct}==\"" << productId << "\", ";
-        ss << "SYMLINK+=\"" << symlink << "\", MODE=\"0666\"";
     }
+    ss << ruleLine(*this);
     
     return ss.str();
 }
@@ -49,11 +109,100 @@ std::string UdevRule::getFileName() const {
 }
 
 // UdevManager implementation
-UdevManager::UdevManager() {
+UdevManager::UdevManager(const std::string& rulesDir)
+    : rulesDir_(rulesDir), rules_(std::make_shared<const RuleSet>()), lastLoadDuration_(0) {
     loadExistingRules();
 }
 
-OperationResult UdevManager::createRule(const DeviceInfo& device, const std::string& symlinkName) {
+OperationResult UdevManager::createRule(const DeviceInfo& device, const std::string& symlinkName,
+                                        bool matchInterface) {
+    auto validation = validateRule(device, symlinkName, matchInterface);
+    if (!validation.success) {
+        return validation;
+    }
+    
+    // Generate rule content
+    UdevRule rule = makeRule(device, symlinkName, matchInterface);
+    std::string content = generateRuleContent({device}, {rule});
+    
+    // Write rule file
+    auto result = writeRuleFile(rule.filePath, content);
+    if (!result.success) {
+        return result;
+    }
+    
+    // Track the new rule without rescanning the rules directory
+    addLoadedRules({rule});
+    
+    return OperationResult::Success("Rule created successfully: /dev/" + symlinkName);
+}
+
+OperationResult UdevManager::createInterfaceRules(const std::vector<DeviceInfo>& interfaces,
+                                                  const std::vector<std::string>& symlinkNames) {
+    if (interfaces.empty() || interfaces.size() != symlinkNames.size()) {
+        return OperationResult::Failure("Need one symlink name per interface");
+    }
+    
+    std::vector<UdevRule> rules;
+    for (size_t i = 0; i < interfaces.size(); i++) {
+        const DeviceInfo& device = interfaces[i];
+        const DeviceInfo& first = interfaces.front();
+        if (device.vendorId != first.vendorId || device.productId != first.productId ||
+            device.serial != first.serial || device.kernelPath != first.kernelPath) {
+            return OperationResult::Failure(device.devNode + " is not on the same USB device as " + first.devNode);
+        }
+        
+        auto validation = validateRule(device, symlinkNames[i], true);
+        if (!validation.success) {
+            return OperationResult::Failure(device.devNode + ": " + validation.message);
+        }
+        
+        for (size_t j = 0; j < i; j++) {
+            if (interfaces[j].interfaceNum == device.interfaceNum) {
+                return OperationResult::Failure(device.devNode + " and " + interfaces[j].devNode +
+                                                " have the same interface number " + device.interfaceNum);
+            }
+            if (symlinkNames[j] == symlinkNames[i]) {
+                return OperationResult::Failure("Symlink name '" + symlinkNames[i] + "' is given twice");
+            }
+        }
+        
+        rules.push_back(makeRule(device, symlinkNames[i], true));
+    }
+    
+    // One file per physical device, named after its first symlink
+    for (auto& rule : rules) {
+        rule.filePath = rules.front().filePath;
+    }
+    
+    auto result = writeRuleFile(rules.front().filePath, generateRuleContent(interfaces, rules));
+    if (!result.success) {
+        return result;
+    }
+    
+    addLoadedRules(rules);
+    
+    return OperationResult::Success("Rules created successfully: /dev/" + symlinkNames.front() + " .. /dev/" +
+                                    symlinkNames.back() + " in " + rules.front().filePath);
+}
+
+std::vector<std::string> UdevManager::interfaceNames(const std::string& baseName, size_t count) {
+    std::vector<std::string> names;
+    for (size_t i = 0; i < count; i++) {
+        // plc_A, plc_B, ...; adapters with more ports than letters get numbers
+        names.push_back(baseName + "_" + (count <= 26 ? std::string(1, static_cast<char>('A' + i))
+                                                      : std::to_string(i)));
+    }
+    return names;
+}
+
+OperationResult UdevManager::validateRule(const DeviceInfo& device, const std::string& symlinkName,
+                                          bool matchInterface) const {
+    return validateRule(device, symlinkName, matchInterface, rules_->index);
+}
+
+OperationResult UdevManager::validateRule(const DeviceInfo& device, const std::string& symlinkName,
+                                          bool matchInterface, const RuleIndex& pending) const {
     // Validate symlink name
     if (!utils::isValidSymlinkName(symlinkName)) {
         return OperationResult::Failure("Invalid symlink name. Use only letters, numbers, underscores, and hyphens. Must start with a letter.");
@@ -64,83 +213,158 @@ OperationResult UdevManager::createRule(const DeviceInfo& device, const std::str
         return OperationResult::Failure("Invalid device information");
     }
     
+    if (matchInterface && device.interfaceNum.empty()) {
+        return OperationResult::Failure("Device " + device.devNode + " has no USB interface number");
+    }
+    
     // Check if symlink already exists
-    if (symlinkExists(symlinkName)) {
+    if (pending.findBySymlink(symlinkName)) {
         return OperationResult::Failure("Symlink name '" + symlinkName + "' is already in use");
     }
     
-    // Check if rule for this exact device already exists
-    for (const auto& rule : rules_) {
-        if (rule.matchesDevice(device)) {
-            return OperationResult::Failure("A rule for this device already exists as '" + rule.symlink + "'");
-        }
+    // The file name may survive in a multi-interface file after its own rule was deleted
+    std::string filePath = rulesDir_ + "/" + generateRuleFileName(symlinkName);
+    if (pending.holdsFile(filePath)) {
+        return OperationResult::Failure("Rule file " + filePath + " already holds other rules");
     }
     
-    // Generate rule content
-    std::string content = generateRuleContent(device, symlinkName);
-    std::string fileName = generateRuleFileName(symlinkName);
-    std::string filePath = std::string(RULES_DIR) + "/" + fileName;
-    
-    // Write rule file
-    auto result = writeRuleFile(filePath, content);
-    if (!result.success) {
-        return result;
+    // Check if rule for this exact device already exists
+    if (const UdevRule* rule = pending.findForDevice(device)) {
+        return OperationResult::Failure("A rule for this device already exists as '" + rule->symlink + "'");
     }
     
-    // Reload rules
-    loadExistingRules();
-    
-    return OperationResult::Success("Rule created successfully: /dev/" + symlinkName);
+    return OperationResult::Success();
+}
+
+UdevRule UdevManager::makeRule(const DeviceInfo& device, const std::string& symlinkName,
+                               bool matchInterface) const {
+    // Mirrors what parseRuleFile() reads back from generateRuleContent()
+    UdevRule rule;
+    rule.name = device.getDisplayName();
+    rule.vendorId = device.vendorId;
+    rule.productId = device.productId;
+    rule.serial = device.serial;
+    rule.symlink = symlinkName;
+    rule.filePath = rulesDir_ + "/" + generateRuleFileName(symlinkName);
+    rule.kernelPath = device.serial.empty() ? device.kernelPath : "";
+    rule.interfaceNum = matchInterface ? device.interfaceNum : "";
+    rule.priority = DEFAULT_PRIORITY;
+    rule.isActive = true;
+    return rule;
 }
 
 OperationResult UdevManager::deleteRule(const std::string& ruleName) {
-    // Find rule with matching symlink or name
-    auto it = std::find_if(rules_.begin(), rules_.end(),
+    // Find rule with matching symlink or name; the snapshot keeps it alive
+    // while the rule set changes below
+    RuleSnapshot current = rules_;
+    const auto& rules = current->rules;
+    auto it = std::find_if(rules.begin(), rules.end(),
                           [&ruleName](const UdevRule& rule) {
                               return rule.symlink == ruleName || rule.name == ruleName;
                           });
     
-    if (it == rules_.end()) {
+    if (it == rules.end()) {
         return OperationResult::Failure("Rule not found: " + ruleName);
     }
     
-    return deleteRuleFile(it->filePath);
+    std::string filePath = it->filePath;
+    if (std::count_if(rules.begin(), rules.end(),
+                      [&filePath](const UdevRule& rule) { return rule.filePath == filePath; }) == 1) {
+        return deleteRuleFile(filePath);
+    }
+    
+    // The file names other interfaces too: drop only this rule's line and
+    // the interface comment above it
+    std::ifstream file(filePath);
+    if (!file.is_open()) {
+        return OperationResult::Failure("Cannot read rule file: " + filePath);
+    }
+    std::string marker = "SYMLINK+=\"" + it->symlink + "\"";
+    std::vector<std::string> lines;
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.find(marker) != std::string::npos && line[0] != '#') {
+            if (!lines.empty() && utils::startsWith(lines.back(), "# Interface ")) {
+                lines.pop_back();
+            }
+            continue;
+        }
+        lines.push_back(line);
+    }
+    file.close();
+    
+    std::string content;
+    for (const auto& kept : lines) {
+        content += kept + "\n";
+    }
+    auto result = writeRuleFile(filePath, content);
+    if (!result.success) {
+        return result;
+    }
+    
+    addLoadedRules(parseRuleFile(filePath));
+    return OperationResult::Success("Rule deleted successfully");
 }
 
 OperationResult UdevManager::deleteRuleFile(const std::string& filePath) {
     auto result = removeRuleFile(filePath);
     if (result.success) {
-        loadExistingRules();
+        removeLoadedRule(filePath);
     }
     return result;
 }
 
+OperationResult UdevManager::removeRuleFiles(const std::vector<std::string>& filePaths,
+                                             const std::string& archiveDir) {
+    size_t removed = 0;
+    std::set<std::string> seen;
+    OperationResult failure = OperationResult::Success();
+    for (const auto& filePath : filePaths) {
+        // Interface rules of one device share a file
+        if (!seen.insert(filePath).second) continue;
+        if (!archiveDir.empty()) {
+            failure = archiveRuleFile(filePath, archiveDir);
+            if (!failure.success) break;
+        }
+        failure = deleteRuleFile(filePath);
+        if (!failure.success) break;
+        removed++;
+    }
+    
+    // One reload for the whole batch; udevd rereads every rule file on it
+    if (removed > 0) {
+        auto reloadResult = reloadRules();
+        if (!reloadResult.success && failure.success) {
+            failure = reloadResult;
+        }
+    }
+    
+    std::string summary = std::to_string(removed) + " rule(s) " +
+                          (archiveDir.empty() ? "deleted" : "archived to " + archiveDir);
+    if (!failure.success) {
+        return OperationResult::Failure(failure.message + " (" + summary + ")");
+    }
+    return OperationResult::Success(summary);
+}
+
 bool UdevManager::ruleExists(const DeviceInfo& device) const {
-    return std::any_of(rules_.begin(), rules_.end(),
-                      [&device](const UdevRule& rule) {
-                          return rule.matchesDevice(device);
-                      });
+    return rules_->index.findForDevice(device) != nullptr;
 }
 
 int UdevManager::getRuleMatchType(const DeviceInfo& device) const {
-    for (const auto& rule : rules_) {
-        if (rule.matchesDevice(device)) {
-            // 2 = unique match (has serial), 1 = shared match (no serial)
-            return rule.isUniqueMatch() ? 2 : 1;
-        }
+    if (const UdevRule* rule = rules_->index.findForDevice(device)) {
+        // 2 = unique match (has serial), 1 = shared match (no serial)
+        return rule->isUniqueMatch() ? 2 : 1;
     }
     return 0; // no match
 }
 
 bool UdevManager::symlinkExists(const std::string& symlinkName) const {
-    return std::any_of(rules_.begin(), rules_.end(),
-                      [&symlinkName](const UdevRule& rule) {
-                          return rule.symlink == symlinkName;
-                      });
+    return rules_->index.findBySymlink(symlinkName) != nullptr;
 }
 
 std::vector<UdevRule> UdevManager::getRules() const {
-    return rules_;
+    return rules_->rules;
 }
 
 OperationResult UdevManager::reloadRules() {
@@ -166,6 +390,26 @@ OperationResult UdevManager::triggerRules() {
     return OperationResult::Success("Rules triggered successfully");
 }
 
+OperationResult UdevManager::triggerDevices(const std::vector<std::string>& sysPaths) {
+    if (sysPaths.empty()) {
+        return OperationResult::Success("No devices to trigger");
+    }
+    
+    std::string cmd = "sudo udevadm trigger --action=change";
+    for (const auto& sysPath : sysPaths) {
+        if (sysPath.find('\'') != std::string::npos) continue;
+        cmd += " '" + sysPath + "'";
+    }
+    std::string output = utils::executeCommand(cmd + " 2>&1");
+    
+    if (output.find("error") != std::string::npos || 
+        output.find("failed") != std::string::npos) {
+        return OperationResult::Failure("Failed to trigger devices: " + output);
+    }
+    
+    return OperationResult::Success("Devices triggered successfully");
+}
+
 OperationResult UdevManager::applyRules() {
     auto reloadResult = reloadRules();
     if (!reloadResult.success) {
@@ -188,8 +432,10 @@ bool UdevManager::verifySymlink(const std::string& symlinkName) const {
     return fs::exists("/dev/" + symlinkName);
 }
 
-std::string UdevManager::generateRuleContent(const DeviceInfo& device, const std::string& symlinkName) const {
+std::string UdevManager::generateRuleContent(const std::vector<DeviceInfo>& devices,
+                                             const std::vector<UdevRule>& rules) const {
     std::stringstream ss;
+    const DeviceInfo& device = devices.front();
     
     ss << "# EasyTTY auto-generated rule\n";
     ss << "# Device: " << device.getDisplayName() << "\n";
@@ -200,32 +446,24 @@ std::string UdevManager::generateRuleContent(const DeviceInfo& device, const std
     } else {
         ss << "# USB Port: " << device.kernelPath << " (device has no serial)\n";
     }
-    ss << "# Original: " << device.devPath << "\n";
-    ss << "# Created: " << utils::executeCommand("date") << "\n";
+    if (devices.size() == 1) {
+        ss << "# Original: " << device.devPath << "\n";
+    }
+    ss << "# Created: " << utils::formatLocalTime(std::time(nullptr)) << "\n";
     ss << "\n";
     
-    if (!device.serial.empty()) {
-        // Use serial number - works regardless of USB port
-        ss << "SUBSYSTEM==\"tty\", ";
-        ss << "ATTRS{idVendor}==\"" << device.vendorId << "\", ";
-        ss << "ATTRS{idProduct}==\"" << device.productId << "\", ";
-        ss << "ATTRS{serial}==\"" << device.serial << "\", ";
-        ss << "SYMLINK+=\"" << symlinkName << "\", MODE=\"0666\"\n";
-    } else if (!device.kernelPath.empty()) {
+    if (device.serial.empty() && !device.kernelPath.empty()) {
         // Use USB port path - device must stay in same port
         ss << "# NOTE: This rule uses USB port path because device has no serial\n";
         ss << "# Keep this device plugged into the same USB port!\n";
-        ss << "SUBSYSTEM==\"tty\", ";
-        ss << "KERNELS==\"" << device.kernelPath << "\", ";
-        ss << "ATTRS{idVendor}==\"" << device.vendorId << "\", ";
-        ss << "ATTRS{idProduct}==\"" << device.productId << "\", ";
-        ss << "SYMLINK+=\"" << symlinkName << "\", MODE=\"0666\"\n";
-    } else {
-        // Fallback - no unique identifier
-        ss << "SUBSYSTEM==\"tty\", ";
-        ss << "ATTRS{idVendor}==\"" << device.vendorId << "\", ";
-        ss << "ATTRS{idProduct}==\"" << device.productId << "\", ";
-        ss << "SYMLINK+=\"" << symlinkName << "\", MODE=\"0666\"\n";
+    }
+    
+    for (size_t i = 0; i < rules.size(); i++) {
+        if (!rules[i].interfaceNum.empty()) {
+            // parseRuleFile() names the rule after this comment
+            ss << "# Interface " << rules[i].interfaceNum << ": " << devices[i].getDisplayName() << "\n";
+        }
+        ss << ruleLine(rules[i]) << "\n";
     }
     
     return ss.str();
@@ -235,82 +473,100 @@ std::string UdevManager::generateRuleFileName(const std::string& symlinkName) co
     return std::to_string(DEFAULT_PRIORITY) + "-easytty-" + symlinkName + ".rules";
 }
 
-std::optional<UdevRule> UdevManager::parseRuleFile(const std::string& filePath) const {
+std::vector<UdevRule> UdevManager::parseRuleFile(const std::string& filePath) const {
+    EASYTTY_TRACE_SPAN("parseRuleFile", filePath);
+    std::vector<UdevRule> rules;
     std::ifstream file(filePath);
     if (!file.is_open()) {
-        return std::nullopt;
+        return rules;
     }
     
-    UdevRule rule;
-    rule.filePath = filePath;
-    rule.isActive = true;
+    UdevRule base;
+    base.filePath = filePath;
+    base.isActive = true;
     
     // Extract priority from filename
     std::string filename = fs::path(filePath).filename().string();
     try {
-        rule.priority = std::stoi(filename.substr(0, 2));
+        base.priority = std::stoi(filename.substr(0, 2));
     } catch (...) {
-        rule.priority = DEFAULT_PRIORITY;
+        base.priority = DEFAULT_PRIORITY;
     }
     
+    // Fields accumulate until a line sets SYMLINK, so a rule continued
+    // over several lines still parses; every SYMLINK line is one rule
+    UdevRule rule = base;
+    std::string interfaceName;
     std::string line;
-    std::regex vendorRegex("ATTRS\\{idVendor\\}==\"([0-9a-fA-F]+)\"");
-    std::regex productRegex("ATTRS\\{idProduct\\}==\"([0-9a-fA-F]+)\"");
-    std::regex serialRegex("ATTRS\\{serial\\}==\"([^\"]+)\"");
-    std::regex symlinkRegex("SYMLINK\\+=\"([^\"]+)\"");
-    std::regex kernelRegex("KERNELS==\"([^\"]+)\"");
-    
     while (std::getline(file, line)) {
         // Skip comments for rule parsing, but extract device name from comments
         if (line.find("# Device:") != std::string::npos) {
-            rule.name = utils::trim(line.substr(line.find(":") + 1));
+            base.name = utils::trim(line.substr(line.find(":") + 1));
+            rule.name = base.name;
+        }
+        if (utils::startsWith(line, "# Interface ") && line.find(':') != std::string::npos) {
+            interfaceName = utils::trim(line.substr(line.find(":") + 1));
         }
         
         if (line.empty() || line[0] == '#') continue;
         
-        std::smatch match;
+        std::string value;
         
-        if (std::regex_search(line, match, vendorRegex)) {
-            rule.vendorId = match[1].str();
+        if (findQuotedValue(line, "ATTRS{idVendor}==\"", value) && isHexString(value)) {
+            rule.vendorId = value;
         }
         
-        if (std::regex_search(line, match, productRegex)) {
-            rule.productId = match[1].str();
+        if (findQuotedValue(line, "ATTRS{idProduct}==\"", value) && isHexString(value)) {
+            rule.productId = value;
         }
         
-        if (std::regex_search(line, match, serialRegex)) {
-            rule.serial = match[1].str();
+        if (findQuotedValue(line, "ATTRS{serial}==\"", value)) {
+            rule.serial = value;
         }
         
-        if (std::regex_search(line, match, symlinkRegex)) {
-            rule.symlink = match[1].str();
+        if (findQuotedValue(line, "KERNELS==\"", value)) {
+            rule.kernelPath = value;
         }
         
-        if (std::regex_search(line, match, kernelRegex)) {
-            rule.kernelPath = match[1].str();
+        // Hand-written rules may match the interface attribute instead
+        if (findQuotedValue(line, "ENV{ID_USB_INTERFACE_NUM}==\"", value) ||
+            findQuotedValue(line, "ATTRS{bInterfaceNumber}==\"", value)) {
+            rule.interfaceNum = value;
         }
+        
+        if (!findQuotedValue(line, "SYMLINK+=\"", value)) continue;
+        rule.symlink = value;
+        
+        // Validate parsed rule
+        if (!rule.vendorId.empty()) {
+            if (!interfaceName.empty()) {
+                rule.name = interfaceName;
+            }
+            if (rule.name.empty()) {
+                rule.name = rule.symlink;
+            }
+            rules.push_back(rule);
+        }
+        rule = base;
+        interfaceName.clear();
     }
     
-    // Validate parsed rule
-    if (rule.vendorId.empty() || rule.symlink.empty()) {
-        return std::nullopt;
-    }
-    
-    if (rule.name.empty()) {
-        rule.name = rule.symlink;
-    }
-    
-    return rule;
+    return rules;
 }
 
 void UdevManager::loadExistingRules() {
-    rules_.clear();
-    
-    if (!fs::exists(RULES_DIR)) {
+    EASYTTY_TRACE_SPAN("loadExistingRules");
+    EASYTTY_ALLOC_PHASE(LoadRules);
+    auto start = std::chrono::steady_clock::now();
+    RuleSet loaded;
+    
+    if (!fs::exists(rulesDir_)) {
+        publish(std::move(loaded));
+        lastLoadDuration_ = std::chrono::microseconds(0);
         return;
     }
     
-    for (const auto& entry : fs::directory_iterator(RULES_DIR)) {
+    for (const auto& entry : fs::directory_iterator(rulesDir_)) {
         if (!entry.is_regular_file()) continue;
         
         std::string filename = entry.path().filename().string();
@@ -319,27 +575,72 @@ void UdevManager::loadExistingRules() {
         if (filename.find("easytty") == std::string::npos) continue;
         if (!utils::endsWith(filename, ".rules")) continue;
         
-        auto rule = parseRuleFile(entry.path().string());
-        if (rule) {
-            rules_.push_back(*rule);
+        auto parsed = parseRuleFile(entry.path().string());
+        if (!parsed.empty()) {
+            loaded.rules.insert(loaded.rules.end(), parsed.begin(), parsed.end());
+        } else {
+            loaded.invalidRuleFiles.push_back(entry.path().string());
         }
     }
     
     // Sort by symlink name
-    std::sort(rules_.begin(), rules_.end(),
+    std::sort(loaded.rules.begin(), loaded.rules.end(),
               [](const UdevRule& a, const UdevRule& b) {
                   return a.symlink < b.symlink;
               });
+    
+    std::sort(loaded.invalidRuleFiles.begin(), loaded.invalidRuleFiles.end());
+    loaded.index.build(loaded.rules);
+    publish(std::move(loaded));
+    
+    lastLoadDuration_ = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start);
+}
+
+void UdevManager::addLoadedRules(const std::vector<UdevRule>& rules) {
+    if (rules.empty()) {
+        return;
+    }
+    
+    // Replace the rules previously read from the same file
+    RuleSet next = *rules_;
+    dropRules(next, rules.front().filePath);
+    
+    for (const auto& rule : rules) {
+        auto pos = std::upper_bound(next.rules.begin(), next.rules.end(), rule,
+                                    [](const UdevRule& a, const UdevRule& b) {
+                                        return a.symlink < b.symlink;
+                                    });
+        next.rules.insert(pos, rule);
+        next.index.add(rule);
+    }
+    publish(std::move(next));
+}
+
+void UdevManager::removeLoadedRule(const std::string& filePath) {
+    RuleSet next = *rules_;
+    dropRules(next, filePath);
+    publish(std::move(next));
+}
+
+void UdevManager::publish(RuleSet rules) {
+    std::atomic_store(&rules_, RuleSnapshot(std::make_shared<const RuleSet>(std::move(rules))));
 }
 
 bool UdevManager::hasWriteAccess() const {
-    return fs::exists(RULES_DIR) && 
-           (utils::isRoot() || access(RULES_DIR, W_OK) == 0);
+    return fs::exists(rulesDir_) && 
+           (utils::isRoot() || access(rulesDir_.c_str(), W_OK) == 0);
+}
+
+bool UdevManager::canWriteDirectly() const {
+    // The system rules directory goes through sudo unless we are root; a
+    // scratch directory (benchmarks, fixtures) needs no privileges
+    return utils::isRoot() || (rulesDir_ != RULES_DIR && hasWriteAccess());
 }
 
 OperationResult UdevManager::writeRuleFile(const std::string& filePath, const std::string& content) {
-    if (utils::isRoot()) {
-        // Direct write if root
+    if (canWriteDirectly()) {
+        // Direct write if root or a writable scratch directory
         std::ofstream file(filePath);
         if (!file.is_open()) {
             return OperationResult::Failure("Failed to create rule file: " + filePath);
@@ -351,7 +652,11 @@ OperationResult UdevManager::writeRuleFile(const std::string& filePath, const st
     
     // Use sudo tee for non-root
     std::string cmd = "echo '" + content + "' | sudo tee " + filePath + " > /dev/null 2>&1";
-    int ret = system(cmd.c_str());
+    int ret;
+    {
+        EASYTTY_TRACE_SPAN("system", "sudo tee", filePath);
+        ret = system(cmd.c_str());
+    }
     
     if (ret != 0) {
         return OperationResult::Failure("Failed to create rule file (sudo required)");
@@ -365,7 +670,7 @@ OperationResult UdevManager::removeRuleFile(const std::string& filePath) {
         return OperationResult::Failure("Rule file does not exist: " + filePath);
     }
     
-    if (utils::isRoot()) {
+    if (canWriteDirectly()) {
         try {
             fs::remove(filePath);
             return OperationResult::Success("Rule deleted successfully");
@@ -385,4 +690,23 @@ OperationResult UdevManager::removeRuleFile(const std::string& filePath) {
     return OperationResult::Success("Rule deleted successfully");
 }
 
+OperationResult UdevManager::archiveRuleFile(const std::string& filePath, const std::string& archiveDir) {
+    fs::path target = fs::path(archiveDir) / fs::path(filePath).filename();
+    
+    std::error_code ec;
+    fs::create_directories(archiveDir, ec);
+    if (fs::copy_file(filePath, target, fs::copy_options::overwrite_existing, ec)) {
+        return OperationResult::Success();
+    }
+    
+    // Use sudo for non-root
+    std::string cmd = "sudo mkdir -p " + archiveDir + " && sudo cp " + filePath + " " + target.string() + " 2>&1";
+    utils::executeCommand(cmd);
+    
+    if (!fs::exists(target)) {
+        return OperationResult::Failure("Failed to archive " + filePath + " to " + archiveDir);
+    }
+    return OperationResult::Success();
+}
+
 } // namespace easytty